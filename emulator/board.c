@@ -0,0 +1,544 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "board.h"
+#include "gpio.h"
+#include "analog.h"
+#include "counter.h"
+#include "servo.h"
+#include "i2c.h"
+#include "id.h"
+#include "temperature.h"
+#include "uart.h"
+#include "reset.h"
+#include <string.h>
+
+#define NUM_GPIO		(14) // indexed by the pin number, 0 and 1 are the uart
+#define NUM_ANALOG		(6)
+#define NUM_SERVO		(8)
+#define NUM_I2C_ADR		(128)
+#define NUM_I2C_REG		(256)
+
+// state of the firmware and the microcontroller, lost by a reset
+typedef struct {
+	uint8_t isConfigured;
+	uint8_t isOutput;
+	uint8_t isPullUp;
+	uint8_t out;	// value written by the firmware
+	s_pin s;		// value and edge flags as seen by the firmware
+	uint16_t rises;	// edges since the last readGpioCounts
+	uint16_t falls;
+	uint8_t debounce_ms;	// 0 = the pin change interrupt latches the edges at once
+	uint8_t level;			// last level of a debounced pin
+	uint32_t level_us;		// time the level of a debounced pin has changed
+} host_gpio;
+
+static host_gpio gpio[NUM_GPIO];
+static uint16_t ev_subscribed = 0; // events of the subscribed pins, bit per pin number
+static uint16_t ev_pending = 0;
+static uint16_t ev_value = 0;
+static uint16_t ev_rise = 0;
+static uint16_t ev_fall = 0;
+
+#define EDGE_QUEUE_SIZE	(32)
+static uint16_t edge_recorded = 0; // timestamped edges of the recorded pins, bit per pin number
+static uint8_t edge_queue[EDGE_QUEUE_SIZE][GPIO_EDGE_RECORD_SIZE];
+static uint8_t edge_rd_ptr = 0;
+static uint8_t edge_cnt = 0;
+static uint16_t edge_lost = 0;
+static uint32_t time_us = 0;
+static uint16_t temperature = 0;
+static uint16_t board_id = 0x0002;
+
+static uint8_t cnt_enabled[2];
+static cnt_options cnt_opt[2];
+static uint8_t cnt[2];
+
+static uint16_t servo_pwm[NUM_SERVO];
+
+static i2c_speed i2c_bus_speed = S100K;
+
+static uint8_t baud_rate = UART_BAUD_230400;
+static uint8_t baud_rate_previous = UART_BAUD_230400;
+
+// state of the world outside of the board, kept over a reset
+static uint8_t in_driven[NUM_GPIO];	// 1 if the pin is driven from outside
+static uint8_t in_level[NUM_GPIO];
+static uint16_t adc[NUM_ANALOG];
+static uint8_t i2c_present[NUM_I2C_ADR];
+static uint8_t i2c_reg[NUM_I2C_ADR][NUM_I2C_REG];
+
+static void (*send_handler)(uint8_t const data) = 0;
+static void (*reset_handler)() = 0;
+static void (*baud_rate_handler)(uint8_t const rate, uint8_t const isConfirmed) = 0;
+
+// servo_pin in the order of the enumeration
+static uint8_t const servo_pin_number[NUM_SERVO] = {9, 10, 2, 3, 4, 5, 6, 7};
+
+/**
+ * @brief returns the level of a pin as it would be read from the PINx register
+ */
+static uint8_t readLevel(uint8_t const pinNumber) {
+	host_gpio const *g = &gpio[pinNumber];
+	if(g->isOutput) return g->out;
+	if(in_driven[pinNumber]) return in_level[pinNumber];
+	return g->isPullUp;
+}
+
+/**
+ * @brief latches an edge of an input pin like the pin change interrupts and the sampling of the
+ * debounced pins do
+ * @param t time of the edge in us
+ */
+static void latchEdge(uint8_t const pinNumber, uint8_t const val, uint32_t const t) {
+	host_gpio *g = &gpio[pinNumber];
+	if(val == 0) { g->s.pin.fall = 1; g->falls++; }
+	else         { g->s.pin.rise = 1; g->rises++; }
+	g->s.pin.value = val;
+
+	uint16_t const mask = ((uint16_t)1) << pinNumber;
+	if(ev_subscribed & mask) {
+		if(val == 0) { ev_value &= ~mask; ev_fall |= mask; }
+		else         { ev_value |= mask;  ev_rise |= mask; }
+		ev_pending |= mask;
+	}
+
+	if(edge_recorded & mask) {
+		if(edge_cnt == EDGE_QUEUE_SIZE) {
+			edge_lost++;
+		}
+		else {
+			uint8_t *record = edge_queue[(edge_rd_ptr + edge_cnt) % EDGE_QUEUE_SIZE];
+			record[0] = pinNumber | (val ? 0x80 : 0);
+			record[1] = (uint8_t)(t & 0xFF);
+			record[2] = (uint8_t)((t >> 8) & 0xFF);
+			record[3] = (uint8_t)((t >> 16) & 0xFF);
+			record[4] = (uint8_t)((t >> 24) & 0xFF);
+			edge_cnt++;
+		}
+	}
+
+	if(pinNumber == 2 || pinNumber == 3) {
+		uint8_t const c = pinNumber - 2;
+		if(cnt_enabled[c] && (cnt_opt[c] == BOTH || (cnt_opt[c] == RISE && val == 1) || (cnt_opt[c] == FALL && val == 0))) {
+			cnt[c]++;
+		}
+	}
+}
+
+/**
+ * @brief emulates the pin change and external interrupts after the level of a pin may have changed
+ */
+static void updateInput(uint8_t const pinNumber) {
+	host_gpio *g = &gpio[pinNumber];
+	uint8_t const val = readLevel(pinNumber);
+	if(g->isOutput) return;
+
+	if(g->debounce_ms > 0) {
+		// the sampling accepts the level once it has been stable, see sampleInputs
+		if(val != g->level) {
+			g->level = val;
+			g->level_us = time_us;
+		}
+		return;
+	}
+
+	if(val != g->s.pin.value) latchEdge(pinNumber, val, time_us);
+}
+
+/**
+ * @brief emulates the sampling of the debounced pins by the timer 0 interrupt up to the current time
+ */
+static void sampleInputs() {
+	for(uint8_t pinNumber = 2; pinNumber < NUM_GPIO; pinNumber++) {
+		host_gpio const *g = &gpio[pinNumber];
+		if(g->isOutput || g->debounce_ms == 0 || g->level == g->s.pin.value) continue;
+		uint32_t const stable_us = ((uint32_t)g->debounce_ms) * 1000;
+		if(time_us - g->level_us >= stable_us) {
+			latchEdge(pinNumber, g->level, g->level_us + stable_us);
+		}
+	}
+}
+
+void boardInit() {
+	memset(gpio, 0, sizeof(gpio));
+	ev_subscribed = ev_pending = ev_value = ev_rise = ev_fall = 0;
+	edge_recorded = edge_lost = 0;
+	edge_rd_ptr = edge_cnt = 0;
+	memset(cnt_enabled, 0, sizeof(cnt_enabled));
+	memset(cnt, 0, sizeof(cnt));
+	memset(servo_pwm, 0, sizeof(servo_pwm));
+	i2c_bus_speed = S100K;
+	baud_rate = baud_rate_previous = UART_BAUD_230400;
+}
+
+void boardSetSendHandler(void (*handler)(uint8_t const data)) {
+	send_handler = handler;
+}
+
+void boardSetResetHandler(void (*handler)()) {
+	reset_handler = handler;
+}
+
+void boardSetBaudRateHandler(void (*handler)(uint8_t const rate, uint8_t const isConfirmed)) {
+	baud_rate_handler = handler;
+}
+
+void boardRevertUartBaudRate() {
+	baud_rate = baud_rate_previous;
+	if(baud_rate_handler != 0) baud_rate_handler(baud_rate, 1);
+}
+
+void boardSetAdc(uint8_t const pinNumber, uint16_t const value) {
+	if(pinNumber < NUM_ANALOG) adc[pinNumber] = value & 0x03FF;
+}
+
+void boardSetTemperature(uint16_t const value) {
+	temperature = value & 0x03FF;
+}
+
+void boardSetId(uint16_t const id) {
+	board_id = id;
+}
+
+void boardSetTime(uint32_t const us) {
+	time_us = us;
+	sampleInputs();
+}
+
+void boardSetGpioInput(uint8_t const pinNumber, uint8_t const value) {
+	if(pinNumber < 2 || pinNumber >= NUM_GPIO) return;
+	in_driven[pinNumber] = 1;
+	in_level[pinNumber] = value ? 1 : 0;
+	updateInput(pinNumber);
+}
+
+uint8_t boardGetGpio(uint8_t const pinNumber) {
+	if(pinNumber < 2 || pinNumber >= NUM_GPIO) return 0;
+	return readLevel(pinNumber);
+}
+
+uint8_t boardIsGpioOutput(uint8_t const pinNumber) {
+	if(pinNumber < 2 || pinNumber >= NUM_GPIO) return 0;
+	return gpio[pinNumber].isOutput;
+}
+
+uint16_t boardGetServoPwm(uint8_t const pinNumber) {
+	for(uint8_t i=0; i<NUM_SERVO; i++) {
+		if(servo_pin_number[i] == pinNumber) return servo_pwm[i];
+	}
+	return 0;
+}
+
+void boardAddI2cDevice(uint8_t const adr) {
+	if(adr < NUM_I2C_ADR) i2c_present[adr] = 1;
+}
+
+void boardSetI2cRegister(uint8_t const adr, uint8_t const offset, uint8_t const value) {
+	if(adr < NUM_I2C_ADR) i2c_reg[adr][offset] = value;
+}
+
+uint8_t boardGetI2cRegister(uint8_t const adr, uint8_t const offset) {
+	if(adr < NUM_I2C_ADR) return i2c_reg[adr][offset];
+	return 0;
+}
+
+// gpio.h
+
+void initGpio() {
+}
+
+void configGpio(gpio_pin const pin, gpio_dir const dir, uint8_t const value, uint8_t const pullUpEnabled) {
+	if(pin == D_ERR) return;
+	uint8_t const pinNumber = (uint8_t)pin + 2;
+	host_gpio *g = &gpio[pinNumber];
+	g->isConfigured = 1;
+	g->rises = g->falls = 0;
+	g->debounce_ms = 0;
+	if(dir == Output) {
+		writeGpio(pin, value);
+		g->isOutput = 1;
+	}
+	else {
+		g->isPullUp = pullUpEnabled;
+		g->isOutput = 0;
+		g->s.pin.value = readLevel(pinNumber);
+	}
+}
+
+void debounceGpio(gpio_pin const pin, uint8_t const debounce_ms) {
+	if(pin == D_ERR) return;
+	uint8_t const pinNumber = (uint8_t)pin + 2;
+	host_gpio *g = &gpio[pinNumber];
+	if(g->isOutput) return;
+	g->debounce_ms = debounce_ms;
+	g->level = g->s.pin.value;
+	g->level_us = time_us;
+	updateInput(pinNumber);
+}
+
+void sampleGpio() {
+	sampleInputs();
+}
+
+uint8_t boardGetDebounceTime(uint8_t const pinNumber) {
+	if(pinNumber >= NUM_GPIO) return 0;
+	return gpio[pinNumber].debounce_ms;
+}
+
+void readGpio(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall) {
+	if(pin == D_ERR) return;
+	host_gpio *g = &gpio[(uint8_t)pin + 2];
+	*value = g->s.pin.value;
+	*rise  = g->s.pin.rise; g->s.pin.rise = 0;
+	*fall  = g->s.pin.fall; g->s.pin.fall = 0;
+}
+
+void readGpioCounts(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall, uint16_t *rises, uint16_t *falls) {
+	if(pin == D_ERR) return;
+	host_gpio *g = &gpio[(uint8_t)pin + 2];
+	readGpio(pin, value, rise, fall);
+	*rises = g->rises; g->rises = 0;
+	*falls = g->falls; g->falls = 0;
+}
+
+void writeGpio(gpio_pin const pin, uint8_t const value) {
+	if(pin == D_ERR) return;
+	host_gpio *g = &gpio[(uint8_t)pin + 2];
+	// like the PORTx register, the value acts as pull up while the pin is an input
+	if(value == 0) g->out = 0;
+	else if(value == 1) g->out = 1;
+	if(!g->isOutput) g->isPullUp = g->out;
+}
+
+void readGpioPort(uint16_t const mask, uint16_t *inputs, uint16_t *value, uint16_t *rise, uint16_t *fall) {
+	*inputs = *value = *rise = *fall = 0;
+	for(uint8_t pinNumber = 2; pinNumber < NUM_GPIO; pinNumber++) {
+		uint16_t const bit = ((uint16_t)1) << pinNumber;
+		host_gpio const *g = &gpio[pinNumber];
+		if((mask & bit) && g->isConfigured && !g->isOutput) {
+			uint8_t v = 0, r = 0, f = 0;
+			readGpio(convertNumberToGpio(pinNumber), &v, &r, &f);
+			*inputs |= bit;
+			if(v) *value |= bit;
+			if(r) *rise |= bit;
+			if(f) *fall |= bit;
+		}
+	}
+}
+
+uint16_t writeGpioPort(uint16_t const mask, uint16_t const value) {
+	uint16_t outputs = 0;
+	for(uint8_t pinNumber = 2; pinNumber < NUM_GPIO; pinNumber++) {
+		uint16_t const bit = ((uint16_t)1) << pinNumber;
+		host_gpio const *g = &gpio[pinNumber];
+		if((mask & bit) && g->isConfigured && g->isOutput) {
+			writeGpio(convertNumberToGpio(pinNumber), (value & bit) ? 1 : 0);
+			outputs |= bit;
+		}
+	}
+	return outputs;
+}
+
+void subscribeGpio(gpio_pin const pin, uint8_t const isSubscribed) {
+	if(pin == D_ERR) return;
+	uint16_t const mask = ((uint16_t)1) << ((uint8_t)pin + 2);
+	if(isSubscribed == 1) ev_subscribed |= mask;
+	else                  ev_subscribed &= ~mask;
+	ev_pending &= ~mask;
+	ev_rise &= ~mask;
+	ev_fall &= ~mask;
+}
+
+uint16_t getGpioEvents() {
+	return ev_pending;
+}
+
+uint8_t fetchGpioEvent(uint8_t const pinNumber, uint8_t *flags) {
+	uint16_t const mask = ((uint16_t)1) << pinNumber;
+	if(!(ev_pending & mask)) return 0;
+	*flags = ((ev_value & mask) ? 0x01 : 0) | ((ev_rise & mask) ? 0x02 : 0) | ((ev_fall & mask) ? 0x04 : 0);
+	ev_pending &= ~mask;
+	ev_rise &= ~mask;
+	ev_fall &= ~mask;
+	return 1;
+}
+
+void recordGpioEdges(gpio_pin const pin, uint8_t const isRecorded) {
+	if(pin == D_ERR) return;
+	uint16_t const mask = ((uint16_t)1) << ((uint8_t)pin + 2);
+	if(isRecorded == 1) edge_recorded |= mask;
+	else                edge_recorded &= ~mask;
+}
+
+uint8_t fetchGpioEdges(uint8_t *records, uint8_t const maxEdges, uint16_t *lost) {
+	uint8_t numEdges = 0;
+	while(edge_cnt > 0 && numEdges < maxEdges) {
+		memcpy(records, edge_queue[edge_rd_ptr], GPIO_EDGE_RECORD_SIZE);
+		records += GPIO_EDGE_RECORD_SIZE;
+		edge_rd_ptr = (edge_rd_ptr + 1) % EDGE_QUEUE_SIZE;
+		edge_cnt--;
+		numEdges++;
+	}
+	*lost = edge_lost;
+	return numEdges;
+}
+
+gpio_pin convertNumberToGpio(uint8_t const pinNumber) {
+	if(pinNumber < 2 || pinNumber >= NUM_GPIO) return D_ERR;
+	return (gpio_pin)(pinNumber - 2);
+}
+
+// analog.h
+
+void initAnalog() {
+}
+
+uint16_t readAdc(analog_pin const pin) {
+	if(pin == TEMP) return temperature;
+	if(pin < NUM_ANALOG) return adc[pin];
+	return 0;
+}
+
+analog_pin convertNumberToAnalog(uint8_t const pinNumber) {
+	if(pinNumber < NUM_ANALOG) return (analog_pin)pinNumber;
+	return A_ERR;
+}
+
+// temperature.h
+
+uint16_t readTemperature() {
+	return readAdc(TEMP);
+}
+
+// id.h
+
+uint16_t getId() {
+	return board_id;
+}
+
+// counter.h
+
+void configCounter(cnt_pin const p, cnt_options const o) {
+	uint8_t const c = (p == CNT_D2) ? 0 : 1;
+	gpio[c + 2].isPullUp = 1;
+	gpio[c + 2].isOutput = 0;
+	gpio[c + 2].debounce_ms = 0;
+	cnt_enabled[c] = 1;
+	cnt_opt[c] = o;
+	readCounter(p);
+}
+
+uint8_t readCounter(cnt_pin const p) {
+	uint8_t const c = (p == CNT_D2) ? 0 : 1;
+	uint8_t const ret = cnt[c];
+	cnt[c] = 0;
+	return ret;
+}
+
+// servo.h
+
+void initServo() {
+}
+
+void configServo(servo_pin const p, uint16_t const pwm_value) {
+	servo_pwm[p] = pwm_value;
+	gpio[servo_pin_number[p]].isOutput = 1;
+}
+
+uint32_t getTime_us() {
+	return time_us;
+}
+
+void setServoPwm(servo_pin const p, uint16_t const pwm_value) {
+	servo_pwm[p] = pwm_value;
+}
+
+// i2c.h
+
+void configI2C(i2c_speed const speed) {
+	i2c_bus_speed = speed;
+}
+
+uint8_t i2c_write(uint8_t const adr, uint8_t const offset, uint8_t *data, uint8_t const length) {
+	uint8_t const a = adr & 0x7F;
+	if(!i2c_present[a]) return 0;
+	for(uint8_t i=0; i<length; i++) {
+		i2c_reg[a][(uint8_t)(offset + i)] = data[i];
+	}
+	return 1;
+}
+
+uint8_t i2c_read(int8_t const adr, uint8_t const offset, uint8_t *data, uint8_t const length) {
+	uint8_t const a = (uint8_t)adr & 0x7F;
+	if(!i2c_present[a]) return 0;
+	for(uint8_t i=0; i<length; i++) {
+		data[i] = i2c_reg[a][(uint8_t)(offset + i)];
+	}
+	return 1;
+}
+
+// uart.h
+
+void initUart() {
+}
+
+void sendByte(uint8_t const data) {
+	if(send_handler != 0) send_handler(data);
+}
+
+void sendByteArray(uint8_t *data, uint8_t const size) {
+	for(uint8_t i=0; i<size; i++) {
+		sendByte(data[i]);
+	}
+}
+
+uint8_t uartTxBufferEmpty() {
+	return 1; // the emulator queues the transmitted bytes without limit
+}
+
+uint8_t switchUartBaudRate(uint8_t const rate) {
+	if(rate > UART_BAUD_1000000) return 0;
+	baud_rate_previous = baud_rate;
+	baud_rate = rate;
+	if(baud_rate_handler != 0) baud_rate_handler(rate, rate == baud_rate_previous);
+	return 1;
+}
+
+void confirmUartBaudRate() {
+	baud_rate_previous = baud_rate;
+	if(baud_rate_handler != 0) baud_rate_handler(baud_rate, 1);
+}
+
+// reset.h
+
+void triggerReset() {
+	boardInit();
+	if(reset_handler != 0) reset_handler();
+}
@@ -0,0 +1,136 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief host side implementation of the firmware modules used by the firmware parser,
+ * pins are numbered like in the protocol, 0 to 5 for A0 to A5 and 2 to 13 for D2 to D13
+ */
+
+/**
+ * @brief brings the emulated microcontroller into its power on state, the stimuli from outside are kept
+ */
+void boardInit();
+
+/**
+ * @brief sets the handler receiving every byte the firmware transmits via the uart
+ */
+void boardSetSendHandler(void (*handler)(uint8_t const data));
+
+/**
+ * @brief sets the handler which is called when the firmware triggers a reset
+ */
+void boardSetResetHandler(void (*handler)());
+
+/**
+ * @brief sets the handler which is called when the firmware changes the baud rate of the uart
+ * @param handler receives the UART_BAUD_x rate and whether the rate is kept, an unconfirmed rate is reverted by
+ * boardRevertUartBaudRate after the confirmation window
+ */
+void boardSetBaudRateHandler(void (*handler)(uint8_t const rate, uint8_t const isConfirmed));
+
+/**
+ * @brief reverts an unconfirmed baud rate switch, emulates the timer of the firmware uart
+ */
+void boardRevertUartBaudRate();
+
+/**
+ * @brief sets the raw 10 bit adc value of an analog input pin
+ */
+void boardSetAdc(uint8_t const pinNumber, uint16_t const value);
+
+/**
+ * @brief sets the raw adc value returned by the temperature sensor
+ */
+void boardSetTemperature(uint16_t const value);
+
+/**
+ * @brief sets the id of the board
+ */
+void boardSetId(uint16_t const id);
+
+/**
+ * @brief sets the time returned by the time base of the firmware, e.g. for the timestamps of the edges
+ * @param time_us time since the start of the emulation in us
+ */
+void boardSetTime(uint32_t const time_us);
+
+/**
+ * @brief drives the level of a digital pin from outside, edges are recorded for input pins and counters
+ */
+void boardSetGpioInput(uint8_t const pinNumber, uint8_t const value);
+
+/**
+ * @brief returns the level of a digital pin, 0 or 1
+ */
+uint8_t boardGetGpio(uint8_t const pinNumber);
+
+/**
+ * @brief returns 1 if the digital pin is configured as output, 0 otherwise
+ */
+uint8_t boardIsGpioOutput(uint8_t const pinNumber);
+
+/**
+ * @brief returns the debounce time of a digital input pin in ms, 0 if the pin is not debounced
+ */
+uint8_t boardGetDebounceTime(uint8_t const pinNumber);
+
+/**
+ * @brief returns the last pwm value set for the servo at the digital pin, 0 if no servo is configured
+ */
+uint16_t boardGetServoPwm(uint8_t const pinNumber);
+
+/**
+ * @brief adds an i2c slave with 256 registers to the bus, unknown addresses are not acknowledged
+ */
+void boardAddI2cDevice(uint8_t const adr);
+
+/**
+ * @brief sets a register of an i2c slave
+ */
+void boardSetI2cRegister(uint8_t const adr, uint8_t const offset, uint8_t const value);
+
+/**
+ * @brief returns a register of an i2c slave
+ */
+uint8_t boardGetI2cRegister(uint8_t const adr, uint8_t const offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
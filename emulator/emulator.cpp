@@ -0,0 +1,562 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulator.h"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <boost/bind/bind.hpp>
+
+extern "C" {
+#include "parser.h"
+#include "uart.h"
+}
+#include "board.h"
+
+namespace arduinoio {
+
+/**
+ * @brief time until the watchdog restarts the board after a reset has been requested (WDTO_500MS)
+ */
+static unsigned int const watchdogTimeout_ms = 500;
+
+/**
+ * @brief bits per byte on the line, 8N1
+ */
+static unsigned int const bitsPerByte = 10;
+
+/**
+ * @brief time in ms the firmware waits for the confirmation of a baud rate switch
+ */
+static unsigned int const baudRateConfirmTime_ms = 500;
+
+emulator *emulator::s_pInstance = 0;
+
+/**
+ * @brief Constructor
+ * @param io_service io service which runs the emulator, usually in its own thread
+ * @param baudRate baud rate of the emulated uart, 0 disables the pacing
+ */
+emulator::emulator(boost::asio::io_service &io_service,
+		unsigned int const baudRate) :
+		m_io_service(io_service), m_byteTime(clock::duration::zero()), m_baudRate(
+				baudRate), m_boardBaudRate(baudRate), m_ptySlaveFd(-1), m_isPtyWriting(false), m_rxTimer(
+				io_service), m_txTimer(io_service), m_baudRateTimer(io_service), m_debounceTimer(io_service), m_isRxTimerArmed(false), m_isTxTimerArmed(false), m_numReceived(
+				0), m_numSent(0), m_dropPercent(0), m_noisePercent(0) {
+	assert(s_pInstance == 0); // the firmware exists only once per process
+	s_pInstance = this;
+
+	m_start = clock::now();
+
+	setByteTime(baudRate);
+
+	boardInit();
+	boardSetSendHandler(&emulator::onSend);
+	boardSetResetHandler(&emulator::onReset);
+	boardSetBaudRateHandler(&emulator::onBaudRate);
+}
+
+/**
+ * @brief Destructor, the io service must not run handlers of the emulator anymore
+ */
+emulator::~emulator() {
+	boardSetSendHandler(0);
+	boardSetResetHandler(0);
+	boardSetBaudRateHandler(0);
+	if (m_loopback) {
+		m_loopback->setDeviceHandler(loopbackTransport::deviceHandler());
+	}
+	m_ptyMaster.reset();
+	if (m_ptySlaveFd >= 0) {
+		close(m_ptySlaveFd);
+	}
+	s_pInstance = 0;
+}
+
+/**
+ * @brief connects the emulator to an in process transport which is passed to an ioboard
+ */
+void emulator::attach(boost::shared_ptr<loopbackTransport> const &t) {
+	m_loopback = t;
+	m_loopback->setDeviceHandler(
+			boost::bind(&emulator::onDeviceData, this,
+					boost::placeholders::_1, boost::placeholders::_2));
+}
+
+/**
+ * @brief creates a pseudo terminal, the ioboard uses its slave device node like a serial port
+ * @return true in case of success, false in case of failure
+ */
+bool emulator::openPty() {
+	int const masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not create pseudo terminal." << std::endl;
+		if (masterFd >= 0) {
+			close(masterFd);
+		}
+		return false;
+	}
+	m_ptyName = ptsname(masterFd);
+
+	struct termios tio;
+	tcgetattr(masterFd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(masterFd, TCSANOW, &tio);
+
+	// keeps the slave open, otherwise reading the master fails until the host has attached
+	m_ptySlaveFd = open(m_ptyName.c_str(), O_RDWR | O_NOCTTY);
+	m_ptyMaster.reset(
+			new boost::asio::posix::stream_descriptor(m_io_service, masterFd));
+
+	startPtyRead();
+	return true;
+}
+
+void emulator::setAnalogValue(E_PIN const p, unsigned int const value) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	boardSetAdc(pin(p).getPinNumber(), value);
+}
+
+void emulator::setTemperature(unsigned int const value) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	boardSetTemperature(value);
+}
+
+void emulator::setId(unsigned int const id) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	boardSetId(id);
+}
+
+void emulator::setLineFaults(unsigned int const dropPercent,
+		unsigned int const noisePercent) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_dropPercent = dropPercent;
+	m_noisePercent = noisePercent;
+}
+
+void emulator::setGpioInput(E_PIN const p, bool const value) {
+	unsigned int debounce_ms = 0;
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		setBoardTime(clock::now());
+		boardSetGpioInput(pin(p).getPinNumber(), value ? 1 : 0);
+		debounce_ms = boardGetDebounceTime(pin(p).getPinNumber());
+	}
+
+	if (debounce_ms > 0) {
+		// the edge of a debounced pin is reported once the level has been stable
+		m_io_service.post(
+				boost::bind(&emulator::armDebounceTimer, this, debounce_ms));
+		return;
+	}
+
+	// the main loop of the firmware reports the edge of a subscribed pin right away
+	m_io_service.post(boost::bind(&emulator::pollEvents, this));
+}
+
+bool emulator::getGpioValue(E_PIN const p) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	return boardGetGpio(pin(p).getPinNumber()) != 0;
+}
+
+unsigned int emulator::getServoPulseWidth(E_PIN const p) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	return boardGetServoPwm(pin(p).getPinNumber());
+}
+
+void emulator::addI2cDevice(unsigned char const adr) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	boardAddI2cDevice(adr);
+}
+
+void emulator::setI2cRegister(unsigned char const adr,
+		unsigned char const offset, unsigned char const value) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	boardSetI2cRegister(adr, offset, value);
+}
+
+unsigned char emulator::getI2cRegister(unsigned char const adr,
+		unsigned char const offset) {
+	boost::mutex::scoped_lock lock(m_mutex);
+	return boardGetI2cRegister(adr, offset);
+}
+
+/**
+ * @brief called by the firmware for every transmitted byte, the byte leaves the uart after the previous ones
+ */
+void emulator::onSend(unsigned char const data) {
+	emulator *e = s_pInstance;
+	timedByte b;
+	b.data = data;
+	b.time = std::max(e->m_now, e->m_txLineFree) + e->m_byteTime;
+	b.baudRate = e->m_boardBaudRate;
+	e->m_txLineFree = b.time;
+	e->m_txQueue.push_back(b);
+}
+
+/**
+ * @brief called by the firmware when it waits for the watchdog to reset the board
+ */
+void emulator::onReset() {
+	emulator *e = s_pInstance;
+	e->m_resetEnd = e->m_now
+			+ boost::asio::chrono::milliseconds(watchdogTimeout_ms);
+	e->setByteTime(e->m_baudRate); // the uart restarts with its initial rate
+	e->m_boardBaudRate = e->m_baudRate;
+	e->m_baudRateTimer.cancel();
+	initParser(); // the parser starts anew and reports the restart to the host
+}
+
+/**
+ * @brief called by the firmware when it switches the baud rate of the uart, bytes already on the line keep their timing
+ */
+void emulator::onBaudRate(unsigned char const rate,
+		unsigned char const isConfirmed) {
+	emulator *e = s_pInstance;
+	if (e->m_baudRate > 0) {
+		switch (rate) {
+		case UART_BAUD_250000:
+			e->m_boardBaudRate = 250000;
+			break;
+		case UART_BAUD_500000:
+			e->m_boardBaudRate = 500000;
+			break;
+		case UART_BAUD_1000000:
+			e->m_boardBaudRate = 1000000;
+			break;
+		default:
+			e->m_boardBaudRate = 230400;
+			break;
+		}
+		e->setByteTime(e->m_boardBaudRate);
+	}
+
+	if (isConfirmed) {
+		e->m_baudRateTimer.cancel();
+		return;
+	}
+
+	// the window starts once the reply to the switch request has left the uart
+	e->m_baudRateTimer.expires_at(
+			std::max(e->m_now, e->m_txLineFree)
+					+ boost::asio::chrono::milliseconds(
+							baudRateConfirmTime_ms));
+	e->m_baudRateTimer.async_wait(
+			boost::bind(&emulator::onBaudRateTimer, e,
+					boost::asio::placeholders::error));
+}
+
+void emulator::onBaudRateTimer(boost::system::error_code const &error) {
+	if (error) {
+		return;
+	}
+
+	boost::mutex::scoped_lock lock(m_mutex);
+	boardRevertUartBaudRate();
+}
+
+/**
+ * @brief polls the events once the debounce time after the last input change has passed, a later
+ * change restarts the timer
+ */
+void emulator::armDebounceTimer(unsigned int const debounce_ms) {
+	m_debounceTimer.expires_after(
+			boost::asio::chrono::milliseconds(debounce_ms + 1));
+	m_debounceTimer.async_wait(
+			boost::bind(&emulator::onDebounceTimer, this,
+					boost::asio::placeholders::error));
+}
+
+void emulator::onDebounceTimer(boost::system::error_code const &error) {
+	if (error) {
+		return;
+	}
+
+	pollEvents();
+}
+
+/**
+ * @brief sets the time a byte occupies the line, 0 disables the pacing
+ */
+void emulator::setByteTime(unsigned int const baudRate) {
+	m_byteTime = clock::duration::zero();
+	if (baudRate > 0) {
+		m_byteTime = boost::asio::chrono::duration_cast<clock::duration>(
+				boost::asio::chrono::nanoseconds(
+						1000000000ULL * bitsPerByte / baudRate));
+	}
+}
+
+/**
+ * @brief returns the baud rate of the host, it is only known for the in process transport which tells the
+ * rate the host has set, the host starts with the initial rate of the board. Without pacing and on the
+ * pseudo terminal all bytes are received at any rate.
+ */
+unsigned int emulator::getHostBaudRate() const {
+	if (m_baudRate == 0 || !m_loopback) {
+		return m_boardBaudRate;
+	}
+	if (m_loopback->getBaudRate() == 0) {
+		return m_baudRate;
+	}
+	return m_loopback->getBaudRate();
+}
+
+/**
+ * @brief advances the time base of the firmware, the emulator mutex must be held
+ */
+void emulator::setBoardTime(clock::time_point const t) {
+	boardSetTime(
+			(uint32_t) boost::asio::chrono::duration_cast<
+					boost::asio::chrono::microseconds>(t - m_start).count());
+}
+
+/**
+ * @brief receives the bytes written by the host via the loopback transport, called from the thread of the host
+ */
+void emulator::onDeviceData(unsigned char const *data, std::size_t const size) {
+	m_io_service.post(
+			boost::bind(&emulator::receive, this,
+					std::vector<unsigned char>(data, data + size)));
+}
+
+/**
+ * @brief puts the bytes written by the host on the line towards the board
+ */
+void emulator::receive(std::vector<unsigned char> const &data) {
+	clock::time_point const now = clock::now();
+	for (std::size_t i = 0; i < data.size(); i++) {
+		timedByte b;
+		b.data = data[i];
+		b.time = std::max(now, m_rxLineFree) + m_byteTime;
+		b.baudRate = getHostBaudRate();
+		m_rxLineFree = b.time;
+		m_rxQueue.push_back(b);
+	}
+	m_numReceived += data.size();
+	armRxTimer();
+}
+
+void emulator::armRxTimer() {
+	if (m_isRxTimerArmed || m_rxQueue.empty()) {
+		return;
+	}
+
+	m_isRxTimerArmed = true;
+	m_rxTimer.expires_at(m_rxQueue.front().time);
+	m_rxTimer.async_wait(
+			boost::bind(&emulator::onRxTimer, this,
+					boost::asio::placeholders::error));
+}
+
+/**
+ * @brief passes all bytes which have completely arrived at the board to the parser of the firmware
+ */
+void emulator::onRxTimer(boost::system::error_code const &error) {
+	m_isRxTimerArmed = false;
+	if (error) {
+		return;
+	}
+
+	clock::time_point const now = clock::now();
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		while (!m_rxQueue.empty() && m_rxQueue.front().time <= now) {
+			timedByte const b = m_rxQueue.front();
+			m_rxQueue.pop_front();
+			if (b.time < m_resetEnd) {
+				continue; // the board is restarting
+			}
+			if (b.baudRate != m_boardBaudRate) {
+				continue; // the uart receives a framing error instead
+			}
+			m_now = b.time;
+			setBoardTime(m_now);
+			std::size_t const replyStart = m_txQueue.size();
+			clock::time_point const lineFree = m_txLineFree;
+			parse(b.data);
+			injectLineFaults(replyStart, lineFree);
+		}
+		if (now >= m_resetEnd) {
+			// the tx buffer of the emulator is always empty, so the passes of the main loop follow each other
+			while (sendEvents()) {
+			}
+		}
+	}
+
+	armRxTimer();
+	armTxTimer();
+}
+
+/**
+ * @brief drops or disturbs the reply the parser has just queued behind the given position
+ */
+void emulator::injectLineFaults(std::size_t const replyStart,
+		clock::time_point const lineFree) {
+	if (m_txQueue.size() == replyStart) {
+		return;
+	}
+
+	unsigned int const dice = std::rand() % 100;
+	if (dice < m_dropPercent) {
+		m_txQueue.erase(m_txQueue.begin() + replyStart, m_txQueue.end());
+		m_txLineFree = lineFree;
+	} else if (dice < m_dropPercent + m_noisePercent) {
+		std::vector<unsigned char> reply;
+		for (std::size_t i = replyStart; i < m_txQueue.size(); i++) {
+			reply.push_back(m_txQueue[i].data);
+		}
+		m_txQueue.erase(m_txQueue.begin() + replyStart, m_txQueue.end());
+		m_txLineFree = lineFree;
+		unsigned int const numNoise = 1 + std::rand() % 3;
+		for (unsigned int i = 0; i < numNoise; i++) {
+			onSend(static_cast<unsigned char>(std::rand()));
+		}
+		for (std::size_t i = 0; i < reply.size(); i++) {
+			onSend(reply[i]);
+		}
+	}
+}
+
+/**
+ * @brief lets the firmware send the events of the subscribed pins, like its main loop does while idle
+ */
+void emulator::pollEvents() {
+	clock::time_point const now = clock::now();
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		if (now < m_resetEnd) {
+			return; // the board is restarting
+		}
+		m_now = std::max(m_now, now);
+		setBoardTime(now);
+		while (sendEvents()) {
+		}
+	}
+
+	armTxTimer();
+}
+
+void emulator::armTxTimer() {
+	if (m_isTxTimerArmed || m_txQueue.empty()) {
+		return;
+	}
+
+	m_isTxTimerArmed = true;
+	m_txTimer.expires_at(m_txQueue.front().time);
+	m_txTimer.async_wait(
+			boost::bind(&emulator::onTxTimer, this,
+					boost::asio::placeholders::error));
+}
+
+/**
+ * @brief passes all bytes which have completely left the board to the host
+ */
+void emulator::onTxTimer(boost::system::error_code const &error) {
+	m_isTxTimerArmed = false;
+	if (error) {
+		return;
+	}
+
+	clock::time_point const now = clock::now();
+	std::vector<unsigned char> data;
+	unsigned int const hostBaudRate = getHostBaudRate();
+	while (!m_txQueue.empty() && m_txQueue.front().time <= now) {
+		if (m_txQueue.front().baudRate == hostBaudRate) {
+			data.push_back(m_txQueue.front().data);
+		}
+		m_txQueue.pop_front();
+	}
+	if (!data.empty()) {
+		transmit(data);
+	}
+
+	armTxTimer();
+}
+
+void emulator::transmit(std::vector<unsigned char> const &data) {
+	m_numSent += data.size();
+	if (m_loopback) {
+		m_loopback->injectToHost(&data[0], data.size());
+	}
+	if (m_ptyMaster) {
+		m_ptyTxPending.insert(m_ptyTxPending.end(), data.begin(), data.end());
+		startPtyWrite();
+	}
+}
+
+void emulator::startPtyRead() {
+	m_ptyMaster->async_read_some(boost::asio::buffer(m_ptyRxBuf),
+			boost::bind(&emulator::onPtyRead, this,
+					boost::asio::placeholders::error,
+					boost::asio::placeholders::bytes_transferred));
+}
+
+void emulator::onPtyRead(boost::system::error_code const &error,
+		std::size_t const bytesTransferred) {
+	if (error) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, reading pty: "
+				<< error.message() << std::endl;
+		return;
+	}
+
+	receive(std::vector<unsigned char>(m_ptyRxBuf,
+			m_ptyRxBuf + bytesTransferred));
+	startPtyRead();
+}
+
+void emulator::startPtyWrite() {
+	if (m_isPtyWriting || m_ptyTxPending.empty()) {
+		return;
+	}
+
+	m_isPtyWriting = true;
+	m_ptyTxBuf.swap(m_ptyTxPending);
+	m_ptyTxPending.clear();
+	boost::asio::async_write(*m_ptyMaster, boost::asio::buffer(m_ptyTxBuf),
+			boost::bind(&emulator::onPtyWrite, this,
+					boost::asio::placeholders::error));
+}
+
+void emulator::onPtyWrite(boost::system::error_code const &error) {
+	m_isPtyWriting = false;
+	if (error) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, writing pty: "
+				<< error.message() << std::endl;
+		return;
+	}
+
+	startPtyWrite();
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,213 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EMULATOR_H_
+#define EMULATOR_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "pin.h"
+#include "loopbackTransport.h"
+
+namespace arduinoio {
+
+/**
+ * @class emulator
+ * @brief emulates an io board on the host by running the parser of the firmware against emulated peripherals,
+ * the bytes are paced like on a uart with the given baud rate. The firmware keeps its state in global
+ * variables, so there can only be one emulator per process.
+ */
+class emulator {
+public:
+	/**
+	 * @brief Constructor
+	 * @param io_service io service which runs the emulator, usually in its own thread
+	 * @param baudRate baud rate of the emulated uart, 0 disables the pacing
+	 */
+	emulator(boost::asio::io_service &io_service, unsigned int const baudRate = 230400);
+
+	/**
+	 * @brief Destructor
+	 */
+	~emulator();
+
+	/**
+	 * @brief connects the emulator to an in process transport which is passed to an ioboard
+	 */
+	void attach(boost::shared_ptr<loopbackTransport> const &t);
+
+	/**
+	 * @brief creates a pseudo terminal, the ioboard uses its slave device node like a serial port
+	 * @return true in case of success, false in case of failure
+	 */
+	bool openPty();
+
+	/**
+	 * @brief returns the slave device node of the pseudo terminal, empty if there is none
+	 */
+	inline std::string const &getPtyName() const {
+		return m_ptyName;
+	}
+
+	/**
+	 * @brief sets the raw 10 bit adc value of an analog pin
+	 */
+	void setAnalogValue(E_PIN const p, unsigned int const value);
+
+	/**
+	 * @brief sets the raw adc value of the temperature sensor
+	 */
+	void setTemperature(unsigned int const value);
+
+	/**
+	 * @brief sets the id reported by the board
+	 */
+	void setId(unsigned int const id);
+
+	/**
+	 * @brief drives a digital pin from outside, edges are seen by gpio input pins and counters
+	 */
+	void setGpioInput(E_PIN const p, bool const value);
+
+	/**
+	 * @brief returns the level of a digital pin
+	 */
+	bool getGpioValue(E_PIN const p);
+
+	/**
+	 * @brief returns the pulse width in us set for the servo at a digital pin
+	 */
+	unsigned int getServoPulseWidth(E_PIN const p);
+
+	/**
+	 * @brief adds an i2c slave with 256 registers to the bus
+	 */
+	void addI2cDevice(unsigned char const adr);
+
+	/**
+	 * @brief accesses a register of an i2c slave
+	 */
+	void setI2cRegister(unsigned char const adr, unsigned char const offset, unsigned char const value);
+	unsigned char getI2cRegister(unsigned char const adr, unsigned char const offset);
+
+	/**
+	 * @brief disturbs the line to the host like a noisy cable, a reply is dropped with the given probability
+	 * and random bytes are put in front of a reply with the given probability, both in percent
+	 */
+	void setLineFaults(unsigned int const dropPercent, unsigned int const noisePercent);
+
+	/**
+	 * @brief returns the number of bytes received from and sent to the host
+	 */
+	inline unsigned long getReceivedByteCount() const {
+		return m_numReceived;
+	}
+	inline unsigned long getSentByteCount() const {
+		return m_numSent;
+	}
+
+private:
+	typedef boost::asio::steady_timer::clock_type clock;
+
+	struct timedByte {
+		unsigned char data;
+		clock::time_point time; // end of the transmission of the byte on the line
+		unsigned int baudRate; // rate of the sender, the receiver gets garbage at another rate
+	};
+
+	boost::asio::io_service &m_io_service;
+	clock::duration m_byteTime;
+	unsigned int m_baudRate; // initial baud rate, 0 if the pacing is disabled
+	unsigned int m_boardBaudRate; // current baud rate of the emulated uart
+	boost::mutex m_mutex; // protects the emulated firmware
+
+	boost::shared_ptr<loopbackTransport> m_loopback;
+	boost::scoped_ptr<boost::asio::posix::stream_descriptor> m_ptyMaster;
+	int m_ptySlaveFd;
+	std::string m_ptyName;
+	unsigned char m_ptyRxBuf[256];
+	std::vector<unsigned char> m_ptyTxBuf; // bytes being written to the pty
+	std::vector<unsigned char> m_ptyTxPending; // bytes waiting for the current write to finish
+	bool m_isPtyWriting;
+
+	std::deque<timedByte> m_rxQueue; // bytes on their way to the board
+	std::deque<timedByte> m_txQueue; // bytes on their way to the host
+	boost::asio::steady_timer m_rxTimer;
+	boost::asio::steady_timer m_txTimer;
+	boost::asio::steady_timer m_baudRateTimer; // confirmation window of a baud rate switch
+	boost::asio::steady_timer m_debounceTimer; // end of the debounce time of the last input change
+	bool m_isRxTimerArmed;
+	bool m_isTxTimerArmed;
+	clock::time_point m_rxLineFree;
+	clock::time_point m_txLineFree;
+	clock::time_point m_now; // time at which the firmware processes the current byte
+	clock::time_point m_resetEnd; // the board ignores all bytes until the watchdog has restarted it
+	clock::time_point m_start; // origin of the time base of the firmware
+
+	unsigned long m_numReceived;
+	unsigned long m_numSent;
+	unsigned int m_dropPercent;
+	unsigned int m_noisePercent;
+
+	static emulator *s_pInstance;
+	static void onSend(unsigned char const data);
+	static void onReset();
+	static void onBaudRate(unsigned char const rate, unsigned char const isConfirmed);
+
+	void setByteTime(unsigned int const baudRate);
+	unsigned int getHostBaudRate() const;
+	void setBoardTime(clock::time_point const t);
+	void onBaudRateTimer(boost::system::error_code const &error);
+	void armDebounceTimer(unsigned int const debounce_ms);
+	void onDebounceTimer(boost::system::error_code const &error);
+
+	void injectLineFaults(std::size_t const replyStart, clock::time_point const lineFree);
+	void onDeviceData(unsigned char const *data, std::size_t const size);
+	void receive(std::vector<unsigned char> const &data);
+	void armRxTimer();
+	void onRxTimer(boost::system::error_code const &error);
+	void pollEvents();
+	void armTxTimer();
+	void onTxTimer(boost::system::error_code const &error);
+	void transmit(std::vector<unsigned char> const &data);
+	void startPtyRead();
+	void onPtyRead(boost::system::error_code const &error, std::size_t const bytesTransferred);
+	void startPtyWrite();
+	void onPtyWrite(boost::system::error_code const &error);
+};
+
+} // end of namespace arduinoio
+
+#endif /* EMULATOR_H_ */
@@ -0,0 +1,160 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulator.h"
+#include "ioboard.h"
+#include "transport_factory.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <boost/atomic.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+using namespace arduinoio;
+
+static unsigned int const numAnalogPins = 6;
+
+/**
+ * @brief time in ms the framework may take to talk to the board again once the line is clean
+ */
+static unsigned int const recoveryTime_ms = 1000;
+
+static boost::atomic<unsigned int> s_numOk(0);
+static boost::atomic<unsigned int> s_numFailed(0);
+static boost::atomic<unsigned int> s_numWrong(0);
+
+/**
+ * @brief raw adc value the emulated board reports for an analog pin
+ */
+static unsigned int adcValue(unsigned int const i) {
+	return 100 * (i + 1);
+}
+
+static void onVoltage(unsigned int const i, bool const ok, float const voltage) {
+	if (!ok) {
+		s_numFailed++;
+	} else if (std::fabs(voltage - adcValue(i) * lsb) > lsb / 2) {
+		s_numWrong++;
+	} else {
+		s_numOk++;
+	}
+}
+
+/**
+ * @brief reads the analog pins of an emulated board in process over a line which drops replies and
+ * injects random bytes, every read must either succeed with the right value or fail after its deadline,
+ * and the framework must talk to the board again once the line is clean
+ * usage: arduinoio_emulator_faults [-r rounds] [-d dropPercent] [-n noisePercent]
+ */
+int main(int argc, char **argv) {
+	unsigned int rounds = 100;
+	unsigned int dropPercent = 3;
+	unsigned int noisePercent = 3;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string const opt(argv[i]);
+		if (opt == "-r") {
+			rounds = std::strtoul(argv[i + 1], 0, 10);
+		} else if (opt == "-d") {
+			dropPercent = std::strtoul(argv[i + 1], 0, 10);
+		} else if (opt == "-n") {
+			noisePercent = std::strtoul(argv[i + 1], 0, 10);
+		} else {
+			std::cerr << "usage: " << argv[0] << " [-r rounds]"
+					<< " [-d dropPercent] [-n noisePercent]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	boost::asio::io_service io_service;
+	boost::asio::io_service::work work(io_service);
+	emulator e(io_service);
+	boost::thread emulatorThread(
+			boost::bind(&boost::asio::io_service::run, &io_service));
+
+	boost::shared_ptr<loopbackTransport> const t =
+			transport_factory::createLoopback();
+	e.attach(t);
+	for (unsigned int i = 0; i < numAnalogPins; i++) {
+		e.setAnalogValue(static_cast<E_PIN>(A0 + i), adcValue(i));
+	}
+
+	bool isPassed = true;
+	{
+		ioboard board(t);
+		boost::shared_ptr<analogPin> pins[numAnalogPins];
+		for (unsigned int i = 0; i < numAnalogPins; i++) {
+			pins[i] = board.createAnalogPin(static_cast<E_PIN>(A0 + i));
+		}
+
+		e.setLineFaults(dropPercent, noisePercent);
+		for (unsigned int r = 0; r < rounds; r++) {
+			for (unsigned int i = 0; i < numAnalogPins; i++) {
+				pins[i]->getPinVoltage(
+						boost::bind(&onVoltage, i, boost::placeholders::_1,
+								boost::placeholders::_2));
+			}
+		}
+		board.waitForAll();
+
+		// once the line is clean the framework has to be in sync with the board again, the supervision
+		// of the ioboard may still probe for a restart caused by the timeouts for a moment
+		e.setLineFaults(0, 0);
+		boost::chrono::steady_clock::time_point const deadline =
+				boost::chrono::steady_clock::now()
+						+ boost::chrono::milliseconds(recoveryTime_ms);
+		unsigned int numRecovered = 0;
+		while (numRecovered < numAnalogPins
+				&& boost::chrono::steady_clock::now() < deadline) {
+			float voltage = 0;
+			if (pins[numRecovered]->getPinVoltage(voltage)
+					&& std::fabs(voltage - adcValue(numRecovered) * lsb)
+							<= lsb / 2) {
+				numRecovered++;
+			}
+		}
+
+		unsigned int const numReads = rounds * numAnalogPins;
+		std::cout << numReads << " reads, " << s_numOk << " ok, "
+				<< s_numFailed << " failed, " << s_numWrong
+				<< " wrong values, " << numRecovered << "/"
+				<< numAnalogPins << " clean reads afterwards" << std::endl;
+		std::cout << board.getDiscardedByteCount() << " bytes discarded, "
+				<< board.getCorruptReplyCount() << " corrupt replies, "
+				<< board.getLostReplyCount() << " lost replies" << std::endl;
+		isPassed = s_numOk + s_numFailed == numReads && s_numWrong == 0
+				&& numRecovered == numAnalogPins;
+	}
+
+	io_service.stop();
+	emulatorThread.join();
+
+	return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,167 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulator.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <boost/bind/bind.hpp>
+
+using namespace arduinoio;
+
+/**
+ * @brief one line of a stimulus script, e.g. "250 gpio 4 1" drives D4 high 250 ms after the start
+ */
+struct scriptEvent {
+	unsigned int time_ms;
+	std::string command;
+	unsigned int arg[3];
+};
+
+static std::vector<scriptEvent> s_script;
+static std::size_t s_nextEvent = 0;
+
+/**
+ * @brief reads a stimulus script, empty lines and lines starting with # are ignored
+ * @return true in case of success, false in case of failure
+ */
+static bool loadScript(std::string const &fileName) {
+	std::ifstream file(fileName.c_str());
+	if (!file) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, could not open "
+				<< fileName << std::endl;
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::istringstream is(line);
+		scriptEvent ev = { 0, "", { 0, 0, 0 } };
+		if (!(is >> ev.time_ms >> ev.command)) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error in script line: " << line << std::endl;
+			return false;
+		}
+		is >> ev.arg[0] >> ev.arg[1] >> ev.arg[2];
+		s_script.push_back(ev);
+	}
+
+	return true;
+}
+
+/**
+ * @brief applies one script event to the emulated board
+ */
+static void execute(emulator &e, scriptEvent const &ev) {
+	if (ev.command == "analog") { // analog <pin 0-5> <adc value>
+		e.setAnalogValue(static_cast<E_PIN>(ev.arg[0]), ev.arg[1]);
+	} else if (ev.command == "gpio") { // gpio <pin 2-13> <0|1>
+		e.setGpioInput(static_cast<E_PIN>(ev.arg[0] + D2 - 2), ev.arg[1] != 0);
+	} else if (ev.command == "temperature") { // temperature <adc value>
+		e.setTemperature(ev.arg[0]);
+	} else if (ev.command == "id") { // id <id>
+		e.setId(ev.arg[0]);
+	} else if (ev.command == "i2cdevice") { // i2cdevice <address>
+		e.addI2cDevice(ev.arg[0]);
+	} else if (ev.command == "i2creg") { // i2creg <address> <register> <value>
+		e.setI2cRegister(ev.arg[0], ev.arg[1], ev.arg[2]);
+	} else {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, unknown command "
+				<< ev.command << std::endl;
+	}
+}
+
+static void onScriptTimer(emulator &e, boost::asio::steady_timer &timer,
+		boost::asio::steady_timer::time_point const start) {
+	while (s_nextEvent < s_script.size()
+			&& start + boost::asio::chrono::milliseconds(s_script[s_nextEvent].time_ms)
+					<= boost::asio::steady_timer::clock_type::now()) {
+		execute(e, s_script[s_nextEvent]);
+		s_nextEvent++;
+	}
+
+	if (s_nextEvent < s_script.size()) {
+		timer.expires_at(
+				start + boost::asio::chrono::milliseconds(s_script[s_nextEvent].time_ms));
+		timer.async_wait(
+				boost::bind(&onScriptTimer, boost::ref(e), boost::ref(timer),
+						start));
+	}
+}
+
+/**
+ * @brief emulates an io board on a pseudo terminal, the framework opens the printed device node
+ * usage: arduinoio_emulator [-b baudRate] [-s scriptFile] [-d dropPercent] [-n noisePercent]
+ * -d and -n disturb the line to the host, e.g. "-d 3 -n 3" drops 3 % of the replies and puts random bytes
+ * in front of another 3 %
+ */
+int main(int argc, char **argv) {
+	unsigned int baudRate = 230400;
+	std::string scriptFile;
+	unsigned int dropPercent = 0;
+	unsigned int noisePercent = 0;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string const opt(argv[i]);
+		if (opt == "-b") {
+			baudRate = std::strtoul(argv[i + 1], 0, 10);
+		} else if (opt == "-s") {
+			scriptFile = argv[i + 1];
+		} else if (opt == "-d") {
+			dropPercent = std::strtoul(argv[i + 1], 0, 10);
+		} else if (opt == "-n") {
+			noisePercent = std::strtoul(argv[i + 1], 0, 10);
+		} else {
+			std::cerr << "usage: " << argv[0] << " [-b baudRate] [-s scriptFile]"
+					<< " [-d dropPercent] [-n noisePercent]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (!scriptFile.empty() && !loadScript(scriptFile)) {
+		return EXIT_FAILURE;
+	}
+
+	boost::asio::io_service io_service;
+	emulator e(io_service, baudRate);
+	e.setLineFaults(dropPercent, noisePercent);
+	if (!e.openPty()) {
+		return EXIT_FAILURE;
+	}
+	std::cout << e.getPtyName() << std::endl;
+
+	boost::asio::steady_timer scriptTimer(io_service);
+	onScriptTimer(e, scriptTimer, boost::asio::steady_timer::clock_type::now());
+
+	io_service.run();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+#include <cmath>
+
+using namespace arduinoio;
+
+static unsigned int const adcValue = 512;
+static unsigned int const numSplitReads = 30;
+
+static bool s_gpioValue = false;
+static unsigned int s_count = 0;
+static float s_voltage = 0;
+static unsigned int s_numOk = 0;
+static unsigned int s_numFailed = 0;
+
+static void countResult(bool const ok) {
+	if (ok) {
+		s_numOk++;
+	} else {
+		s_numFailed++;
+	}
+}
+
+static void onValue(bool const ok, bool const val, bool const, bool const) {
+	countResult(ok);
+	s_gpioValue = val;
+}
+
+static void onCounter(bool const ok, unsigned int const val) {
+	countResult(ok);
+	s_count = val;
+}
+
+static void onVoltage(bool const ok, float const voltage) {
+	countResult(ok && std::fabs(voltage - adcValue * lsb) <= lsb / 2);
+	s_voltage = voltage;
+}
+
+/**
+ * @brief transfers a batch request built from raw sub requests
+ * @param status receives the status of the reply, BATCH_OK or BATCH_NOK
+ * @return true if the reply has been received
+ */
+static bool transferBatch(serial &s, std::vector<unsigned char> const &subRequests,
+		unsigned int const subReplySize, unsigned char &status) {
+	std::vector<unsigned char> msg;
+	msg.push_back(CT_BATCH);
+	msg.push_back(DT_BATCH_EXECUTE);
+	msg.push_back((unsigned char) subRequests.size());
+	msg.insert(msg.end(), subRequests.begin(), subRequests.end());
+	unsigned char cs = 0;
+	for (unsigned int i = 0; i < msg.size(); i++) {
+		cs += msg[i];
+	}
+	msg.push_back(cs);
+
+	std::vector<unsigned char> reply(4 + subReplySize);
+	if (!s.transfer(&msg[0], msg.size(), &reply[0], reply.size(), 100)) {
+		return false;
+	}
+	status = reply[2];
+	return true;
+}
+
+/**
+ * @brief checks that a batch executes the requests of several io entities with their replies handed to
+ * the handlers of the requests, that a batch exceeding the limits of the firmware is split, and that the
+ * board rejects a batch with a request outside the allowed classes before executing any of them
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+	e.setAnalogValue(A2, adcValue);
+
+	{
+		ioboard board(test.getTransport());
+		EMULATOR_CHECK(board.isBatchSupported());
+
+		boost::shared_ptr<gpioInputPin> input = board.createGpioInputPin(D5,
+				false);
+		boost::shared_ptr<counterPin> counter = board.createCounterPin(D2,
+				RISE);
+		boost::shared_ptr<analogPin> analog = board.createAnalogPin(A2);
+		boost::shared_ptr<gpioOutputPin> output = board.createGpioOutputPin(
+				D12, false);
+		boost::shared_ptr<servo> servoPin = board.createServoPin(D9, 1500);
+
+		e.setGpioInput(D5, true);
+		for (unsigned int i = 0; i < 3; i++) {
+			e.setGpioInput(D2, true);
+			e.setGpioInput(D2, false);
+		}
+
+		boost::shared_ptr<batch> b = board.createBatch();
+		input->getPinValue(*b, &onValue);
+		counter->readCounter(*b, &onCounter);
+		analog->getPinVoltage(*b, &onVoltage);
+		output->setPinValue(true, *b, &countResult);
+		servoPin->setPwm(1700, *b, &countResult);
+		EMULATOR_CHECK(b->getRequestCount() == 5);
+		EMULATOR_CHECK(b->execute());
+		EMULATOR_CHECK(b->getRequestCount() == 0);
+		EMULATOR_CHECK(s_numOk == 5 && s_numFailed == 0);
+		EMULATOR_CHECK(s_gpioValue);
+		EMULATOR_CHECK(s_count == 3);
+		EMULATOR_CHECK(std::fabs(s_voltage - adcValue * lsb) <= lsb / 2);
+		EMULATOR_CHECK(e.getGpioValue(D12));
+		EMULATOR_CHECK(output->getPinValue());
+		EMULATOR_CHECK(e.getServoPulseWidth(D9) == 1700);
+
+		// more requests than the firmware takes with one frame are split into several batches
+		s_numOk = 0;
+		for (unsigned int i = 0; i < numSplitReads; i++) {
+			analog->getPinVoltage(*b, &onVoltage);
+		}
+		EMULATOR_CHECK(b->execute());
+		EMULATOR_CHECK(s_numOk == numSplitReads && s_numFailed == 0);
+
+		output->setPinValue(false);
+	}
+
+	{
+		// the board keeps protocol v2 and the configuration of the output pin
+		serial s(test.reconnect());
+		s.setProtocolVersion(PROTOCOL_V2);
+
+		unsigned char const pinNumber = pin(D12).getPinNumber();
+		unsigned char const write[5] = { CT_GPIO, DT_GPIO_WRITE, pinNumber, 1,
+				(unsigned char) (CT_GPIO + DT_GPIO_WRITE + pinNumber + 1) };
+		unsigned char const reset[3] = { CT_MISC, DT_MISC_RESET, CT_MISC
+				+ DT_MISC_RESET };
+		unsigned char const baud[4] = { CT_MISC, DT_MISC_BAUD, 3, CT_MISC
+				+ DT_MISC_BAUD + 3 };
+		unsigned char const protocol[4] = { CT_MISC, DT_MISC_PROTOCOL,
+				PROTOCOL_V1, CT_MISC + DT_MISC_PROTOCOL + PROTOCOL_V1 };
+		unsigned char const *forbidden[3] = { reset, baud, protocol };
+		unsigned int const forbiddenSize[3] = { sizeof(reset), sizeof(baud),
+				sizeof(protocol) };
+
+		// no request of a batch is executed if one of them is not allowed, a rejected batch is answered
+		// with its status alone
+		unsigned char status = BATCH_OK;
+		for (unsigned int i = 0; i < 3; i++) {
+			std::vector<unsigned char> subRequests(write, write + sizeof(write));
+			subRequests.insert(subRequests.end(), forbidden[i],
+					forbidden[i] + forbiddenSize[i]);
+			EMULATOR_CHECK(
+					transferBatch(s, subRequests, 0, status)
+							&& status == BATCH_NOK);
+			EMULATOR_CHECK(!e.getGpioValue(D12));
+		}
+
+		std::vector<unsigned char> const allowed(write, write + sizeof(write));
+		EMULATOR_CHECK(
+				transferBatch(s, allowed, 4, status) && status == BATCH_OK);
+		EMULATOR_CHECK(e.getGpioValue(D12));
+	}
+
+	return emulatorTest::getResult();
+}
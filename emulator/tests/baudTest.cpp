@@ -0,0 +1,115 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+#include <boost/bind/bind.hpp>
+
+using namespace arduinoio;
+
+static unsigned int const numRates = 4;
+static unsigned int const rates[numRates] = { 1000000, 500000, 250000, 230400 };
+static unsigned int const lineDownTime_ms = 200;
+static unsigned int const baudReplySize = 8;
+
+static bool s_isBaudRateSet = false;
+
+static void setBaudRate(ioboard *board, unsigned int const baudRate) {
+	s_isBaudRateSet = board->setBaudRate(baudRate);
+}
+
+static bool hasSent(emulator *e, unsigned long const numBytes) {
+	return e->getSentByteCount() >= numBytes;
+}
+
+/**
+ * @brief checks that the host and the board switch to every supported baud rate together, that the
+ * emulated line drops the bytes sent at a different rate, and that both sides end up at the same rate if
+ * the reply to the request or the confirmation is lost
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+
+	{
+		ioboard board(test.getTransport());
+		unsigned int id = 0;
+		EMULATOR_CHECK(board.getBaudRate() == 230400);
+
+		for (unsigned int i = 0; i < numRates; i++) {
+			EMULATOR_CHECK(board.setBaudRate(rates[i]));
+			EMULATOR_CHECK(board.getBaudRate() == rates[i]);
+			EMULATOR_CHECK(test.getTransport()->getBaudRate() == rates[i]);
+			EMULATOR_CHECK(board.getId(id));
+		}
+		EMULATOR_CHECK(!board.setBaudRate(115200));
+		EMULATOR_CHECK(board.getBaudRate() == 230400);
+
+		// a host at another rate than the board cannot talk to it
+		EMULATOR_CHECK(test.getTransport()->setBaudRate(1000000));
+		EMULATOR_CHECK(!board.getId(id));
+		EMULATOR_CHECK(test.getTransport()->setBaudRate(230400));
+		EMULATOR_CHECK(board.getId(id));
+
+		// the confirmation at the new rate is lost, whether the board falls back or has switched the host
+		// has to end up at its rate
+		unsigned long const numSent = e.getSentByteCount();
+		boost::thread confirmLost(boost::bind(&setBaudRate, &board, 1000000));
+		EMULATOR_CHECK(
+				emulatorTest::waitFor(
+						boost::bind(&hasSent, &e, numSent + baudReplySize),
+						lineDownTime_ms));
+		e.setLineFaults(100, 0);
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(lineDownTime_ms));
+		e.setLineFaults(0, 0);
+		confirmLost.join();
+		EMULATOR_CHECK(test.getTransport()->getBaudRate() == board.getBaudRate());
+		EMULATOR_CHECK(board.getId(id));
+
+		// the reply to the request is lost, the board keeps its rate and so does the host
+		unsigned int const previousRate = board.getBaudRate();
+		e.setLineFaults(100, 0);
+		boost::thread replyLost(boost::bind(&setBaudRate, &board, 500000));
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(lineDownTime_ms));
+		e.setLineFaults(0, 0);
+		replyLost.join();
+		EMULATOR_CHECK(!s_isBaudRateSet);
+		EMULATOR_CHECK(board.getBaudRate() == previousRate);
+		EMULATOR_CHECK(board.getId(id));
+
+		EMULATOR_CHECK(board.setBaudRate(1000000));
+		EMULATOR_CHECK(board.reset());
+		EMULATOR_CHECK(board.getBaudRate() == 230400);
+		EMULATOR_CHECK(board.getId(id));
+	}
+
+	return emulatorTest::getResult();
+}
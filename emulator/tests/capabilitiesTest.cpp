@@ -0,0 +1,83 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+
+using namespace arduinoio;
+
+static unsigned char const i2cAddress = 0x50;
+
+/**
+ * @brief checks that the board reports the limits and the pins of the firmware in its capability record,
+ * and that the host creates io entities only for the pins the board has and keeps to its limits
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+	e.addI2cDevice(i2cAddress);
+
+	{
+		ioboard board(test.getTransport());
+		capabilities const &c = board.getCapabilities();
+
+		// the limits defined by firmware/uart.h and firmware/parser.c
+		EMULATOR_CHECK(c.getProtocolVersion() == PROTOCOL_V2);
+		EMULATOR_CHECK(c.getRxBufferSize() == 256);
+		EMULATOR_CHECK(c.getTxBufferSize() == 256);
+		EMULATOR_CHECK(c.getMaxFramePayload() == 64);
+		EMULATOR_CHECK(c.getBatchMaxRequestSize() == 56);
+		EMULATOR_CHECK(c.getBatchMaxReplySize() == 96);
+		EMULATOR_CHECK(c.getI2cMaxWriteSize() == 8);
+		EMULATOR_CHECK(c.hasClass(CT_BATCH) && board.isBatchSupported());
+		EMULATOR_CHECK(c.hasClass(CT_I2C));
+
+		// the pin maps of the board
+		EMULATOR_CHECK(c.isGpioPin(D2) && c.isGpioPin(D13));
+		EMULATOR_CHECK(c.isAnalogPin(A0) && c.isAnalogPin(A5));
+		EMULATOR_CHECK(c.isServoPin(D9) && !c.isServoPin(D12));
+		EMULATOR_CHECK(c.isCounterPin(D2) && c.isCounterPin(D3));
+		EMULATOR_CHECK(!c.isCounterPin(D4));
+
+		EMULATOR_CHECK(board.createCounterPin(D3, RISE) != 0);
+		EMULATOR_CHECK(!board.createCounterPin(D5, RISE));
+		EMULATOR_CHECK(board.createServoPin(D9, 1500) != 0);
+		EMULATOR_CHECK(!board.createServoPin(D12, 1500));
+
+		// an i2c write longer than the firmware takes is rejected by the host
+		boost::shared_ptr<i2cBridge> i2c = board.createI2CBridge(100000);
+		EMULATOR_CHECK(i2c != 0);
+		unsigned char data[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		EMULATOR_CHECK(i2c->write(i2cAddress, 0, data, 8));
+		EMULATOR_CHECK(e.getI2cRegister(i2cAddress, 7) == 8);
+		EMULATOR_CHECK(!i2c->write(i2cAddress, 0, data, 9));
+	}
+
+	return emulatorTest::getResult();
+}
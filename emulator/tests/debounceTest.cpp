@@ -0,0 +1,137 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+#include <boost/atomic.hpp>
+#include <boost/bind/bind.hpp>
+
+using namespace arduinoio;
+
+static unsigned int const debounceTime_ms = 50;
+static unsigned int const numBounces = 6;
+static unsigned int const bounceTime_us = 700;
+static unsigned int const glitchTime_ms = 5;
+static unsigned int const settleTime_ms = 2 * debounceTime_ms;
+
+static boost::atomic<unsigned int> s_numEvents(0);
+static boost::atomic<unsigned int> s_numRises(0);
+static boost::atomic<unsigned int> s_numFalls(0);
+
+static void onEdge(bool const, bool const rise, bool const fall) {
+	if (rise) s_numRises++;
+	if (fall) s_numFalls++;
+	s_numEvents++;
+}
+
+static bool hasEvents(unsigned int const numEvents) {
+	return s_numEvents >= numEvents;
+}
+
+/**
+ * @brief lets a contact bounce a few times before it settles at a level
+ */
+static void bounce(emulator &e, bool const value) {
+	for (unsigned int i = 0; i < numBounces; i++) {
+		e.setGpioInput(D5, i % 2 == 0 ? value : !value);
+		boost::this_thread::sleep_for(boost::chrono::microseconds(bounceTime_us));
+	}
+	e.setGpioInput(D5, value);
+}
+
+/**
+ * @brief checks that a debounced pin reports a bouncing contact as a single edge once it has been stable
+ * for the debounce time, in its counts, events and recorded edges, that shorter glitches are filtered and
+ * that every edge counts again once the debouncing is disabled
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+
+	{
+		ioboard board(test.getTransport());
+		boost::shared_ptr<gpioInputPin> input = board.createGpioInputPin(D5,
+				false);
+		bool val = false;
+		unsigned int rises = 0, falls = 0;
+
+		// without debouncing every bounce is an edge
+		bounce(e, true);
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(val && rises == numBounces / 2 + 1);
+		EMULATOR_CHECK(falls == numBounces / 2);
+
+		EMULATOR_CHECK(input->setDebounceTime(debounceTime_ms));
+		EMULATOR_CHECK(!input->setDebounceTime(maxDebounceTime_ms + 1));
+		EMULATOR_CHECK(input->getDebounceTime() == debounceTime_ms);
+		EMULATOR_CHECK(input->subscribe(&onEdge));
+		EMULATOR_CHECK(input->recordEdges(true));
+
+		// the level is accepted once it has been stable, until then the pin keeps its value
+		bounce(e, false);
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(val && rises == 0 && falls == 0);
+		EMULATOR_CHECK(
+				emulatorTest::waitFor(boost::bind(&hasEvents, 1),
+						settleTime_ms * 2));
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(settleTime_ms));
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(!val && rises == 0 && falls == 1);
+		EMULATOR_CHECK(s_numEvents == 1 && s_numFalls == 1 && s_numRises == 0);
+		std::vector<gpioEdge> edges;
+		unsigned int lostEdges = 0;
+		EMULATOR_CHECK(board.readGpioEdges(edges, lostEdges));
+		EMULATOR_CHECK(edges.size() == 1 && lostEdges == 0);
+		EMULATOR_CHECK(!edges.empty() && !edges[0].isRising());
+
+		// a glitch shorter than the debounce time is no edge at all
+		e.setGpioInput(D5, true);
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(glitchTime_ms));
+		e.setGpioInput(D5, false);
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(settleTime_ms));
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(!val && rises == 0 && falls == 0);
+		EMULATOR_CHECK(s_numEvents == 1);
+		EMULATOR_CHECK(board.readGpioEdges(edges, lostEdges));
+		EMULATOR_CHECK(edges.empty());
+
+		EMULATOR_CHECK(input->unsubscribe());
+		EMULATOR_CHECK(input->recordEdges(false));
+		EMULATOR_CHECK(input->setDebounceTime(0));
+		bounce(e, true);
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(val && rises == numBounces / 2 + 1);
+		EMULATOR_CHECK(falls == numBounces / 2);
+	}
+
+	return emulatorTest::getResult();
+}
@@ -0,0 +1,112 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+
+using namespace arduinoio;
+
+static unsigned int const numToggles = 1001;
+static unsigned int const numWrapEdges = 65536 + 10;
+
+static unsigned int s_numOk = 0;
+static bool s_value = false;
+static unsigned int s_rises = 0;
+static unsigned int s_falls = 0;
+
+static void onCounts(bool const ok, bool const val, unsigned int const rises,
+		unsigned int const falls) {
+	if (ok) {
+		s_numOk++;
+	}
+	s_value = val;
+	s_rises = rises;
+	s_falls = falls;
+}
+
+/**
+ * @brief checks that the board counts every edge of a pin between two readouts instead of latching
+ * one flag, that a readout clears the counts and the flags while a read clears only the flags, and that
+ * the counts wrap at 16 bits
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+
+	{
+		ioboard board(test.getTransport());
+		boost::shared_ptr<gpioInputPin> input = board.createGpioInputPin(D8,
+				false);
+
+		for (unsigned int i = 0; i < numToggles; i++) {
+			e.setGpioInput(D8, i % 2 == 0);
+		}
+		bool val = false;
+		unsigned int rises = 0, falls = 0;
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(val);
+		EMULATOR_CHECK(rises == numToggles / 2 + 1);
+		EMULATOR_CHECK(falls == numToggles / 2);
+
+		// the readout has cleared the counts and, like a read, the latched flags
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(rises == 0 && falls == 0);
+		bool rise = true, fall = true;
+		EMULATOR_CHECK(input->getPinValue(val, rise, fall));
+		EMULATOR_CHECK(val && !rise && !fall);
+
+		// a read does not clear the counts
+		e.setGpioInput(D8, false);
+		EMULATOR_CHECK(input->getPinValue(val, rise, fall));
+		EMULATOR_CHECK(!val && !rise && fall);
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(rises == 0 && falls == 1);
+
+		// asynchronous and batched readouts
+		e.setGpioInput(D8, true);
+		input->getEdgeCounts(&onCounts);
+		board.waitForAll();
+		EMULATOR_CHECK(s_numOk == 1 && s_value && s_rises == 1 && s_falls == 0);
+		e.setGpioInput(D8, false);
+		boost::shared_ptr<batch> b = board.createBatch();
+		input->getEdgeCounts(*b, &onCounts);
+		EMULATOR_CHECK(b->execute());
+		EMULATOR_CHECK(s_numOk == 2 && !s_value && s_rises == 0 && s_falls == 1);
+
+		// the counts wrap at 16 bits
+		for (unsigned int i = 0; i < 2 * numWrapEdges; i++) {
+			e.setGpioInput(D8, i % 2 == 0);
+		}
+		EMULATOR_CHECK(input->getEdgeCounts(val, rises, falls));
+		EMULATOR_CHECK(rises == numWrapEdges % 65536);
+		EMULATOR_CHECK(falls == numWrapEdges % 65536);
+	}
+
+	return emulatorTest::getResult();
+}
@@ -0,0 +1,105 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+
+using namespace arduinoio;
+
+static unsigned int const numToggles = 10;
+static unsigned int const toggleDelay_us = 500;
+static unsigned int const numOverflowEdges = 50;
+
+/**
+ * @brief checks that the board records the edges of several pins with timestamps in the order they
+ * occurred, that a full queue counts the further edges as lost, and that the recording stops on request
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+
+	{
+		ioboard board(test.getTransport());
+		boost::shared_ptr<gpioInputPin> first = board.createGpioInputPin(D4,
+				false);
+		boost::shared_ptr<gpioInputPin> second = board.createGpioInputPin(D7,
+				false);
+		EMULATOR_CHECK(first->recordEdges(true));
+		EMULATOR_CHECK(second->recordEdges(true));
+
+		for (unsigned int i = 0; i < numToggles; i++) {
+			e.setGpioInput(D4, i % 2 == 0);
+			boost::this_thread::sleep_for(
+					boost::chrono::microseconds(toggleDelay_us));
+			e.setGpioInput(D7, i % 2 == 0);
+		}
+
+		std::vector<gpioEdge> edges;
+		unsigned int lostEdges = 99;
+		EMULATOR_CHECK(board.readGpioEdges(edges, lostEdges));
+		EMULATOR_CHECK(lostEdges == 0);
+		EMULATOR_CHECK(edges.size() == 2 * numToggles);
+		for (unsigned int i = 0; i < edges.size() && i < 2 * numToggles; i++) {
+			EMULATOR_CHECK(edges[i].getPin() == (i % 2 == 0 ? D4 : D7));
+			EMULATOR_CHECK(edges[i].isRising() == (i % 4 < 2));
+			if (i % 2 == 1) {
+				EMULATOR_CHECK(
+						edges[i].getTime_us() - edges[i - 1].getTime_us()
+								>= toggleDelay_us);
+			} else if (i > 0) {
+				EMULATOR_CHECK(
+						edges[i].getTime_us() >= edges[i - 1].getTime_us());
+			}
+		}
+
+		// the edges have been removed from the board
+		EMULATOR_CHECK(board.readGpioEdges(edges, lostEdges));
+		EMULATOR_CHECK(edges.empty());
+
+		// a full queue counts the further edges as lost, one call fetches one queue
+		for (unsigned int i = 0; i < numOverflowEdges; i++) {
+			e.setGpioInput(D4, i % 2 == 0);
+		}
+		EMULATOR_CHECK(board.readGpioEdges(edges, lostEdges));
+		EMULATOR_CHECK(edges.size() == GPIO_EDGE_QUEUE_SIZE);
+		EMULATOR_CHECK(lostEdges == numOverflowEdges - GPIO_EDGE_QUEUE_SIZE);
+		EMULATOR_CHECK(board.readGpioEdges(edges, lostEdges));
+		EMULATOR_CHECK(edges.empty());
+
+		// only the pins still recording add edges
+		EMULATOR_CHECK(first->recordEdges(false));
+		e.setGpioInput(D4, true);
+		e.setGpioInput(D7, true);
+		EMULATOR_CHECK(board.readGpioEdges(edges, lostEdges));
+		EMULATOR_CHECK(edges.size() == 1 && edges[0].getPin() == D7);
+		EMULATOR_CHECK(lostEdges == numOverflowEdges - GPIO_EDGE_QUEUE_SIZE);
+	}
+
+	return emulatorTest::getResult();
+}
@@ -0,0 +1,97 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "transport_factory.h"
+#include <cstdlib>
+#include <iostream>
+#include <boost/bind/bind.hpp>
+
+namespace arduinoio {
+
+unsigned int emulatorTest::s_numFailed = 0;
+
+/**
+ * @brief Constructor
+ * @param baudRate baud rate of the emulated uart, 0 disables the pacing
+ */
+emulatorTest::emulatorTest(unsigned int const baudRate) :
+		m_work(m_io_service), m_emulator(m_io_service, baudRate), m_thread(
+				boost::bind(&boost::asio::io_service::run, &m_io_service)), m_transport(
+				transport_factory::createLoopback()) {
+	m_emulator.attach(m_transport);
+}
+
+/**
+ * @brief Destructor
+ */
+emulatorTest::~emulatorTest() {
+	m_io_service.stop();
+	m_thread.join();
+}
+
+boost::shared_ptr<loopbackTransport> const &emulatorTest::reconnect() {
+	m_transport = transport_factory::createLoopback();
+	m_emulator.attach(m_transport);
+	return m_transport;
+}
+
+bool emulatorTest::check(bool const condition, char const *text,
+		char const *file, int const line) {
+	if (!condition) {
+		std::cerr << file << ":" << line << " Error, check failed: " << text
+				<< std::endl;
+		s_numFailed++;
+	}
+	return condition;
+}
+
+bool emulatorTest::waitFor(boost::function<bool()> const &condition,
+		unsigned int const timeout_ms) {
+	boost::chrono::steady_clock::time_point const deadline =
+			boost::chrono::steady_clock::now()
+					+ boost::chrono::milliseconds(timeout_ms);
+	while (!condition()) {
+		if (boost::chrono::steady_clock::now() >= deadline) {
+			return false;
+		}
+		boost::this_thread::sleep_for(boost::chrono::microseconds(100));
+	}
+	return true;
+}
+
+int emulatorTest::getResult() {
+	if (s_numFailed > 0) {
+		std::cerr << s_numFailed << " checks failed." << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+} // end of namespace arduinoio
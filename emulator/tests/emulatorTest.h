@@ -0,0 +1,117 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EMULATORTEST_H_
+#define EMULATORTEST_H_
+
+#include <boost/asio.hpp>
+#include <boost/chrono.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include "emulator.h"
+#include "loopbackTransport.h"
+
+/**
+ * @brief checks a condition of a test, a failed check is reported with its location and the test goes on
+ */
+#define EMULATOR_CHECK(condition) \
+	arduinoio::emulatorTest::check((condition), #condition, __FILE__, __LINE__)
+
+namespace arduinoio {
+
+/**
+ * @class emulatorTest
+ * @brief runs an emulated board in process for the tests of the framework and the firmware, the emulator
+ * is driven by an io thread of its own. The board under test is created on the transport and has to be
+ * destroyed before the test object.
+ */
+class emulatorTest {
+public:
+	/**
+	 * @brief Constructor
+	 * @param baudRate baud rate of the emulated uart, 0 disables the pacing
+	 */
+	emulatorTest(unsigned int const baudRate = 230400);
+
+	/**
+	 * @brief Destructor
+	 */
+	~emulatorTest();
+
+	inline emulator &getEmulator() {
+		return m_emulator;
+	}
+
+	/**
+	 * @brief returns the in process transport to the emulated board
+	 */
+	inline boost::shared_ptr<loopbackTransport> const &getTransport() const {
+		return m_transport;
+	}
+
+	/**
+	 * @brief attaches a new transport to the emulated board for another host, e.g. a raw serial after an
+	 * ioboard has been destroyed. The firmware keeps its state.
+	 * @return the new transport
+	 */
+	boost::shared_ptr<loopbackTransport> const &reconnect();
+
+	/**
+	 * @brief counts a failed check and reports it on stderr
+	 * @return the condition
+	 */
+	static bool check(bool const condition, char const *text,
+			char const *file, int const line);
+
+	/**
+	 * @brief waits until the condition holds, e.g. until an event has been delivered by the io thread
+	 * @return true if the condition holds, false if the timeout has passed
+	 */
+	static bool waitFor(boost::function<bool()> const &condition,
+			unsigned int const timeout_ms);
+
+	/**
+	 * @brief returns the exit code of the test, EXIT_SUCCESS if all checks have passed
+	 */
+	static int getResult();
+
+private:
+	boost::asio::io_service m_io_service;
+	boost::asio::io_service::work m_work;
+	emulator m_emulator;
+	boost::thread m_thread;
+	boost::shared_ptr<loopbackTransport> m_transport;
+
+	static unsigned int s_numFailed;
+};
+
+} // end of namespace arduinoio
+
+#endif /* EMULATORTEST_H_ */
@@ -0,0 +1,136 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+#include <cmath>
+#include <boost/atomic.hpp>
+#include <boost/bind/bind.hpp>
+
+using namespace arduinoio;
+
+static unsigned int const numToggles = 20;
+static unsigned int const numReads = 300;
+static unsigned int const adcValue = 300;
+static unsigned int const eventTimeout_ms = 100;
+
+static boost::atomic<unsigned int> s_numEvents(0);
+static boost::atomic<unsigned int> s_numRises(0);
+static boost::atomic<unsigned int> s_numFalls(0);
+static boost::atomic<bool> s_value(false);
+static boost::atomic<unsigned int> s_numReadsOk(0);
+
+static void onEdge(bool const val, bool const rise, bool const fall) {
+	s_value = val;
+	if (rise) s_numRises++;
+	if (fall) s_numFalls++;
+	s_numEvents++;
+}
+
+static void onVoltage(bool const ok, float const voltage) {
+	if (ok && std::fabs(voltage - adcValue * lsb) <= lsb / 2) {
+		s_numReadsOk++;
+	}
+}
+
+static bool hasEvents(unsigned int const numEvents) {
+	return s_numEvents >= numEvents;
+}
+
+/**
+ * @brief checks that the board pushes an event for every change of a subscribed pin, that the events
+ * never disturb the replies of pipelined requests, and that the events stop once the pin has been
+ * unsubscribed or destroyed
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+	e.setAnalogValue(A2, adcValue);
+
+	{
+		ioboard board(test.getTransport());
+		boost::shared_ptr<gpioInputPin> input = board.createGpioInputPin(D4,
+				false);
+		boost::shared_ptr<analogPin> analog = board.createAnalogPin(A2);
+		EMULATOR_CHECK(input->subscribe(&onEdge));
+
+		// one event per change, the host does not poll
+		for (unsigned int i = 0; i < numToggles; i++) {
+			bool const val = (i % 2 == 0);
+			e.setGpioInput(D4, val);
+			EMULATOR_CHECK(
+					emulatorTest::waitFor(boost::bind(&hasEvents, i + 1),
+							eventTimeout_ms));
+			EMULATOR_CHECK(s_value == val);
+		}
+		EMULATOR_CHECK(s_numEvents == numToggles);
+		EMULATOR_CHECK(s_numRises == numToggles / 2);
+		EMULATOR_CHECK(s_numFalls == numToggles / 2);
+
+		// events between the replies of pipelined requests
+		for (unsigned int i = 0; i < numReads; i++) {
+			analog->getPinVoltage(&onVoltage);
+			if (i % 10 == 0) {
+				e.setGpioInput(D4, (i / 10) % 2 == 0);
+			}
+		}
+		board.waitForAll();
+		EMULATOR_CHECK(s_numReadsOk == numReads);
+		EMULATOR_CHECK(board.getCorruptReplyCount() == 0);
+		bool const last = ((numReads - 1) / 10) % 2 == 0;
+		EMULATOR_CHECK(
+				emulatorTest::waitFor(boost::bind(&hasEvents, numToggles + 1),
+						eventTimeout_ms));
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(eventTimeout_ms));
+		EMULATOR_CHECK(s_value == last);
+
+		// no events after unsubscribing
+		EMULATOR_CHECK(input->unsubscribe());
+		unsigned int const numEvents = s_numEvents;
+		e.setGpioInput(D4, !last);
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(eventTimeout_ms));
+		EMULATOR_CHECK(s_numEvents == numEvents);
+
+		// a destroyed pin unsubscribes, the board sends nothing for its changes
+		EMULATOR_CHECK(input->subscribe(&onEdge));
+		input.reset();
+		board.waitForAll();
+		unsigned long const numSent = e.getSentByteCount();
+		for (unsigned int i = 0; i < numToggles; i++) {
+			e.setGpioInput(D4, i % 2 == 0);
+		}
+		boost::this_thread::sleep_for(
+				boost::chrono::milliseconds(eventTimeout_ms));
+		EMULATOR_CHECK(e.getSentByteCount() == numSent);
+	}
+
+	return emulatorTest::getResult();
+}
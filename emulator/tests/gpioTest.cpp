@@ -0,0 +1,293 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+extern "C" {
+#include <avr/io.h>
+#include "gpio.h"
+
+volatile uint8_t PINB = 0;
+volatile uint8_t DDRB = 0;
+volatile uint8_t PORTB = 0;
+volatile uint8_t PIND = 0;
+volatile uint8_t DDRD = 0;
+volatile uint8_t PORTD = 0;
+volatile uint8_t PCMSK0 = 0;
+volatile uint8_t PCMSK2 = 0;
+volatile uint8_t PCICR = 0;
+volatile uint8_t MCUCR = 0;
+volatile uint8_t SREG = 0;
+
+void PCINT0_vect(void);
+void PCINT2_vect(void);
+
+static uint32_t s_time_us = 0;
+
+uint32_t getTime_us() {
+	return s_time_us;
+}
+}
+
+/**
+ * @brief checks a condition like EMULATOR_CHECK, the firmware module replaces the emulated board of the
+ * other tests and cannot be linked with their emulator
+ */
+#define GPIO_CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+static unsigned int s_numFailed = 0;
+
+static bool check(bool const condition, char const *text, char const *file,
+		int const line) {
+	if (!condition) {
+		std::cerr << file << ":" << line << " Error, check failed: " << text
+				<< std::endl;
+		s_numFailed++;
+	}
+	return condition;
+}
+
+/**
+ * @brief registers of a pin as wired on the arduino uno, indexed by gpio_pin
+ */
+struct pinRegisters {
+	volatile uint8_t *pin;
+	volatile uint8_t *ddr;
+	volatile uint8_t *port;
+	volatile uint8_t *pcmsk;
+	uint8_t bit;
+	void (*isr)(void);
+};
+
+static pinRegisters const pins[D_ERR] = {
+	{ &PIND, &DDRD, &PORTD, &PCMSK2, 1 << 2, PCINT2_vect },
+	{ &PIND, &DDRD, &PORTD, &PCMSK2, 1 << 3, PCINT2_vect },
+	{ &PIND, &DDRD, &PORTD, &PCMSK2, 1 << 4, PCINT2_vect },
+	{ &PIND, &DDRD, &PORTD, &PCMSK2, 1 << 5, PCINT2_vect },
+	{ &PIND, &DDRD, &PORTD, &PCMSK2, 1 << 6, PCINT2_vect },
+	{ &PIND, &DDRD, &PORTD, &PCMSK2, 1 << 7, PCINT2_vect },
+	{ &PINB, &DDRB, &PORTB, &PCMSK0, 1 << 0, PCINT0_vect },
+	{ &PINB, &DDRB, &PORTB, &PCMSK0, 1 << 1, PCINT0_vect },
+	{ &PINB, &DDRB, &PORTB, &PCMSK0, 1 << 2, PCINT0_vect },
+	{ &PINB, &DDRB, &PORTB, &PCMSK0, 1 << 3, PCINT0_vect },
+	{ &PINB, &DDRB, &PORTB, &PCMSK0, 1 << 4, PCINT0_vect },
+	{ &PINB, &DDRB, &PORTB, &PCMSK0, 1 << 5, PCINT0_vect },
+};
+
+static uint16_t pinMask(gpio_pin const pin) {
+	return ((uint16_t) 1) << (pin + 2);
+}
+
+/**
+ * @brief drives the levels of several pins of a port at once and raises the pin change interrupt of the
+ * port if one of them is enabled in its mask register, like the hardware does. The outputs read back the
+ * values written to the port.
+ * @param mask pins to drive, bit per pin number, all of the same port
+ * @param values levels of the pins, bit per pin number
+ */
+static void drivePins(uint16_t const mask, uint16_t const values) {
+	bool isEnabled = false;
+	void (*isr)(void) = 0;
+	for (int i = 0; i < D_ERR; i++) {
+		gpio_pin const pin = static_cast<gpio_pin>(i);
+		if ((mask & pinMask(pin)) == 0) continue;
+		pinRegisters const &r = pins[pin];
+		uint8_t const previous = *r.pin;
+		if (values & pinMask(pin)) *r.pin |= r.bit;
+		else *r.pin &= ~r.bit;
+		if (*r.pin != previous && (*r.pcmsk & r.bit)) isEnabled = true;
+		isr = r.isr;
+	}
+	PIND = (PIND & ~DDRD) | (PORTD & DDRD);
+	PINB = (PINB & ~DDRB) | (PORTB & DDRB);
+	if (isEnabled) isr();
+}
+
+static void drivePin(gpio_pin const pin, bool const value) {
+	drivePins(pinMask(pin), value ? pinMask(pin) : 0);
+}
+
+/**
+ * @brief checks the edge counts of all pins and clears them
+ * @param rises pins expected to have one rising edge, bit per pin number
+ * @param falls pins expected to have one falling edge, bit per pin number
+ */
+static void checkCounts(uint16_t const rises, uint16_t const falls) {
+	for (int i = 0; i < D_ERR; i++) {
+		gpio_pin const pin = static_cast<gpio_pin>(i);
+		uint8_t value = 0, rise = 0, fall = 0;
+		uint16_t numRises = 0, numFalls = 0;
+		readGpioCounts(pin, &value, &rise, &fall, &numRises, &numFalls);
+		GPIO_CHECK(numRises == ((rises & pinMask(pin)) ? 1 : 0));
+		GPIO_CHECK(numFalls == ((falls & pinMask(pin)) ? 1 : 0));
+	}
+}
+
+/**
+ * @brief checks the descriptor tables and the pin change ISRs of the firmware gpio module against the
+ * registers of every pin: configuration, reads and writes of each pin, edges of several pins of a port
+ * latched by one interrupt, and outputs which share a port with inputs
+ */
+int main() {
+	initGpio();
+	GPIO_CHECK((PCICR & ((1 << PCIE0) | (1 << PCIE2))) != 0);
+
+	for (uint8_t n = 0; n < 16; n++) {
+		gpio_pin const expected =
+				(n >= 2 && n <= 13) ? static_cast<gpio_pin>(n - 2) : D_ERR;
+		GPIO_CHECK(convertNumberToGpio(n) == expected);
+	}
+
+	// every pin is configured through its own register bits
+	for (int i = 0; i < D_ERR; i++) {
+		gpio_pin const pin = static_cast<gpio_pin>(i);
+		pinRegisters const &r = pins[pin];
+		configGpio(pin, Input, 0, 1);
+		GPIO_CHECK((*r.ddr & r.bit) == 0);
+		GPIO_CHECK((*r.port & r.bit) != 0);
+		GPIO_CHECK((*r.pcmsk & r.bit) != 0);
+		configGpio(pin, Input, 0, 0);
+		GPIO_CHECK((*r.port & r.bit) == 0);
+	}
+	GPIO_CHECK(PCMSK2 == 0xFC && PCMSK0 == 0x3F);
+
+	// an edge of one pin is latched for this pin only
+	for (int i = 0; i < D_ERR; i++) {
+		gpio_pin const pin = static_cast<gpio_pin>(i);
+		uint8_t value = 0, rise = 0, fall = 0;
+		drivePin(pin, true);
+		readGpio(pin, &value, &rise, &fall);
+		GPIO_CHECK(value == 1 && rise == 1 && fall == 0);
+		checkCounts(pinMask(pin), 0);
+		drivePin(pin, false);
+		readGpio(pin, &value, &rise, &fall);
+		GPIO_CHECK(value == 0 && rise == 0 && fall == 1);
+		checkCounts(0, pinMask(pin));
+	}
+
+	// one interrupt latches the rising and falling edges of several pins of a port
+	uint16_t const portD = pinMask(D2) | pinMask(D3) | pinMask(D4)
+			| pinMask(D5) | pinMask(D6) | pinMask(D7);
+	uint16_t const portB = pinMask(D8) | pinMask(D9) | pinMask(D10)
+			| pinMask(D11) | pinMask(D12) | pinMask(D13);
+	drivePins(portD, pinMask(D2) | pinMask(D5));
+	drivePins(portB, pinMask(D9) | pinMask(D10) | pinMask(D13));
+	drivePins(portD, pinMask(D3) | pinMask(D5));
+
+	uint16_t inputs = 0, values = 0, rises = 0, falls = 0;
+	readGpioPort(0x3FFC, &inputs, &values, &rises, &falls);
+	GPIO_CHECK(inputs == (portD | portB));
+	GPIO_CHECK(
+			values
+					== (pinMask(D3) | pinMask(D5) | pinMask(D9) | pinMask(D10)
+							| pinMask(D13)));
+	GPIO_CHECK(
+			rises
+					== (pinMask(D2) | pinMask(D3) | pinMask(D5) | pinMask(D9)
+							| pinMask(D10) | pinMask(D13)));
+	GPIO_CHECK(falls == pinMask(D2));
+	readGpioPort(0x3FFC, &inputs, &values, &rises, &falls);
+	GPIO_CHECK(rises == 0 && falls == 0);
+	checkCounts(
+			pinMask(D2) | pinMask(D3) | pinMask(D5) | pinMask(D9)
+					| pinMask(D10) | pinMask(D13), pinMask(D2));
+
+	// subscribed and recorded pins are selected from the changed pins of the interrupt
+	subscribeGpio(D11, 1);
+	recordGpioEdges(D8, 1);
+	recordGpioEdges(D12, 1);
+	s_time_us = 1000;
+	drivePins(portB, portB);
+	GPIO_CHECK(getGpioEvents() == pinMask(D11));
+	uint8_t flags = 0;
+	GPIO_CHECK(fetchGpioEvent(11, &flags) == 1 && flags == 0x03);
+	uint8_t records[4 * GPIO_EDGE_RECORD_SIZE];
+	uint16_t lost = 0;
+	GPIO_CHECK(fetchGpioEdges(records, 4, &lost) == 2 && lost == 0);
+	GPIO_CHECK(records[0] == (8 | 0x80) && records[1] == (1000 & 0xFF));
+	GPIO_CHECK(records[GPIO_EDGE_RECORD_SIZE] == (12 | 0x80));
+	subscribeGpio(D11, 0);
+	recordGpioEdges(D8, 0);
+	recordGpioEdges(D12, 0);
+	checkCounts(pinMask(D8) | pinMask(D11) | pinMask(D12), 0);
+
+	// outputs share the ports with inputs, their writes do not show up as edges
+	configGpio(D4, Output, 1, 0);
+	configGpio(D12, Output, 0, 0);
+	GPIO_CHECK((DDRD & (1 << 4)) != 0 && (PCMSK2 & (1 << 4)) == 0);
+	GPIO_CHECK((DDRB & (1 << 4)) != 0 && (PCMSK0 & (1 << 4)) == 0);
+	GPIO_CHECK((PORTD & (1 << 4)) != 0 && (PORTB & (1 << 4)) == 0);
+	writeGpio(D4, 0);
+	writeGpio(D12, 1);
+	GPIO_CHECK((PORTD & (1 << 4)) == 0 && (PORTB & (1 << 4)) != 0);
+	drivePins(portD & ~pinMask(D4), pinMask(D3) | pinMask(D5) | pinMask(D6));
+	drivePins(portB & ~pinMask(D12), portB);
+	checkCounts(pinMask(D6), 0);
+	writeGpio(D4, 1);
+	writeGpio(D12, 0);
+	drivePins(portD & ~pinMask(D4), pinMask(D5) | pinMask(D6));
+	drivePins(portB & ~pinMask(D12), portB & ~pinMask(D8));
+	checkCounts(0, pinMask(D3) | pinMask(D8));
+
+	// a port write changes only the configured outputs, the pull ups of the inputs are kept
+	configGpio(D7, Input, 0, 1);
+	configGpio(D13, Output, 0, 0);
+	GPIO_CHECK(
+			writeGpioPort(0x3FFC, pinMask(D4) | pinMask(D13))
+					== (pinMask(D4) | pinMask(D12) | pinMask(D13)));
+	GPIO_CHECK(PORTD == ((1 << 4) | (1 << 7)));
+	GPIO_CHECK(PORTB == (1 << 5));
+	GPIO_CHECK(writeGpioPort(pinMask(D12), pinMask(D12)) == pinMask(D12));
+	GPIO_CHECK(PORTB == ((1 << 4) | (1 << 5)));
+
+	// a debounced pin is sampled instead of interrupting, the new level counts once it is stable
+	configGpio(D9, Input, 0, 0);
+	debounceGpio(D9, 3);
+	GPIO_CHECK((PCMSK0 & (1 << 1)) == 0);
+	drivePin(D9, false);
+	sampleGpio();
+	sampleGpio();
+	drivePin(D9, true);
+	sampleGpio();
+	drivePin(D9, false);
+	sampleGpio();
+	sampleGpio();
+	checkCounts(0, 0);
+	sampleGpio();
+	checkCounts(0, pinMask(D9));
+	debounceGpio(D9, 0);
+	GPIO_CHECK((PCMSK0 & (1 << 1)) != 0);
+
+	if (s_numFailed > 0) {
+		std::cerr << s_numFailed << " checks failed." << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+
+using namespace arduinoio;
+
+/**
+ * @brief writes per kind of request, the loopback transport takes any number of bytes at once unlike the
+ * kernel buffer of a serial port, so the backlog of the emulated line is kept below the deadline of the
+ * acknowledged request that follows
+ */
+static unsigned int const numWrites = 50;
+
+static unsigned int s_numOk = 0;
+
+static void onResult(bool const ok) {
+	if (ok) {
+		s_numOk++;
+	}
+}
+
+/**
+ * @brief checks that unacknowledged gpio writes and servo sets are executed by the board in order
+ * without a reply, and that the error counters of the board account for every one of them
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+
+	{
+		ioboard board(test.getTransport());
+		boost::shared_ptr<gpioOutputPin> output = board.createGpioOutputPin(
+				D7, false);
+		boost::shared_ptr<servo> servoPin = board.createServoPin(D9, 1500);
+		output->setAcknowledged(false);
+		servoPin->setAcknowledged(false);
+
+		unsigned long const numSentBefore = e.getSentByteCount();
+		unsigned int numOk = 0;
+		for (unsigned int i = 0; i < numWrites; i++) {
+			numOk += output->setPinValue(i % 2 == 0);
+			numOk += servoPin->setPwm(1000 + i);
+		}
+		for (unsigned int i = 0; i < numWrites; i++) {
+			output->setPinValue(i % 2 != 0, &onResult);
+			servoPin->setPwm(1000 + numWrites + i, &onResult);
+		}
+		board.waitForAll();
+		EMULATOR_CHECK(numOk == 2 * numWrites);
+		EMULATOR_CHECK(s_numOk == 2 * numWrites);
+
+		// the board has not answered any of them
+		EMULATOR_CHECK(e.getSentByteCount() == numSentBefore);
+
+		// the counters are read after the requests sent before have been executed
+		unsigned int droppedFrames = 0, failedRequests = 0, executedRequests = 0;
+		EMULATOR_CHECK(
+				board.getErrorCounters(droppedFrames, failedRequests,
+						executedRequests));
+		EMULATOR_CHECK(droppedFrames == 0);
+		EMULATOR_CHECK(failedRequests == 0);
+		EMULATOR_CHECK(executedRequests == 4 * numWrites);
+		EMULATOR_CHECK(board.getUnacknowledgedCount() == 4 * numWrites);
+
+		// the last values have been applied
+		EMULATOR_CHECK(e.getGpioValue(D7));
+		EMULATOR_CHECK(output->getPinValue());
+		EMULATOR_CHECK(e.getServoPulseWidth(D9) == 1000 + 2 * numWrites - 1);
+
+		// acknowledged requests work as before
+		output->setAcknowledged(true);
+		EMULATOR_CHECK(output->setPinValue(false) && !e.getGpioValue(D7));
+	}
+
+	return emulatorTest::getResult();
+}
@@ -0,0 +1,110 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "ioboard.h"
+
+using namespace arduinoio;
+
+static unsigned int const numInputs = 6;
+static E_PIN const inputPins[numInputs] = { D2, D3, D4, D5, D6, D8 };
+
+/**
+ * @brief checks that one port read returns the values and edges of all configured input pins and clears
+ * the edges, and that one masked port write sets the selected output pins and leaves the others
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+
+	{
+		ioboard board(test.getTransport());
+		unsigned int inputMask = 0;
+		std::vector<boost::shared_ptr<gpioInputPin> > inputs;
+		for (unsigned int i = 0; i < numInputs; i++) {
+			inputs.push_back(board.createGpioInputPin(inputPins[i], false));
+			inputMask |= gpioPortSnapshot::getPinMask(inputPins[i]);
+		}
+		boost::shared_ptr<gpioOutputPin> out12 = board.createGpioOutputPin(D12,
+				false);
+		boost::shared_ptr<gpioOutputPin> out13 = board.createGpioOutputPin(D13,
+				true);
+
+		e.setGpioInput(D3, true);
+		e.setGpioInput(D5, true);
+		e.setGpioInput(D5, false);
+
+		gpioPortSnapshot snapshot;
+		EMULATOR_CHECK(board.readGpioPort(allGpioPins, snapshot));
+		EMULATOR_CHECK(snapshot.getInputs() == inputMask);
+		EMULATOR_CHECK(!snapshot.isRead(D12));
+		EMULATOR_CHECK(snapshot.getValue(D3) && snapshot.getRise(D3));
+		EMULATOR_CHECK(!snapshot.getValue(D5) && snapshot.getRise(D5));
+		EMULATOR_CHECK(snapshot.getFall(D5));
+		EMULATOR_CHECK(
+				snapshot.getRises()
+						== (gpioPortSnapshot::getPinMask(D3)
+								| gpioPortSnapshot::getPinMask(D5)));
+		EMULATOR_CHECK(snapshot.getFalls() == gpioPortSnapshot::getPinMask(D5));
+
+		// the port read has cleared the edges like a read of every pin
+		EMULATOR_CHECK(board.readGpioPort(allGpioPins, snapshot));
+		EMULATOR_CHECK(snapshot.getRises() == 0 && snapshot.getFalls() == 0);
+		EMULATOR_CHECK(snapshot.getValue(D3));
+		bool val = false, rise = true, fall = true;
+		EMULATOR_CHECK(inputs[1]->getPinValue(val, rise, fall));
+		EMULATOR_CHECK(val && !rise && !fall);
+
+		// only the selected pins are read
+		EMULATOR_CHECK(
+				board.readGpioPort(gpioPortSnapshot::getPinMask(D3), snapshot));
+		EMULATOR_CHECK(
+				snapshot.getInputs() == gpioPortSnapshot::getPinMask(D3));
+
+		// a masked write sets the selected outputs and the state of their pin objects
+		unsigned int const outputMask = gpioPortSnapshot::getPinMask(D12)
+				| gpioPortSnapshot::getPinMask(D13);
+		EMULATOR_CHECK(
+				board.writeGpioPort(outputMask,
+						gpioPortSnapshot::getPinMask(D12)));
+		EMULATOR_CHECK(e.getGpioValue(D12) && !e.getGpioValue(D13));
+		EMULATOR_CHECK(out12->getPinValue() && !out13->getPinValue());
+		EMULATOR_CHECK(
+				board.writeGpioPort(gpioPortSnapshot::getPinMask(D13),
+						gpioPortSnapshot::getPinMask(D13)));
+		EMULATOR_CHECK(e.getGpioValue(D12) && e.getGpioValue(D13));
+
+		// input pins are not written, the write reports that not all selected pins were outputs
+		EMULATOR_CHECK(!board.writeGpioPort(allGpioPins, 0));
+		EMULATOR_CHECK(e.getGpioValue(D3));
+		EMULATOR_CHECK(!e.getGpioValue(D12) && !e.getGpioValue(D13));
+	}
+
+	return emulatorTest::getResult();
+}
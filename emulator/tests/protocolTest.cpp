@@ -0,0 +1,130 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "emulatorTest.h"
+#include "serial.h"
+#include "tags.h"
+
+using namespace arduinoio;
+
+static unsigned int const boardId = 0x1234;
+
+/**
+ * @brief requests the id of the board with the framing currently used by the serial
+ */
+static bool transferId(serial &s, unsigned int &id) {
+	unsigned char const msg[3] = { CT_MISC, DT_MISC_ID, CT_MISC + DT_MISC_ID };
+	unsigned char reply[6];
+	if (!s.transfer(msg, sizeof(msg), reply, sizeof(reply), 50)
+			|| reply[2] == MISC_NOK) {
+		return false;
+	}
+	id = (reply[3] << 8) | reply[4];
+	return true;
+}
+
+/**
+ * @brief checks the framing of protocol v2: the negotiation from protocol v1, the crc of the requests
+ * checked by the board, the sequence ids detecting lost replies and the resynchronisation to the replies
+ * after random bytes on the line
+ */
+int main() {
+	emulatorTest test;
+	emulator &e = test.getEmulator();
+	e.setId(boardId);
+
+	{
+		serial s(test.getTransport());
+		s.startIoThread();
+		unsigned int id = 0;
+
+		// the board starts with protocol v1
+		EMULATOR_CHECK(s.getProtocolVersion() == PROTOCOL_V1);
+		EMULATOR_CHECK(transferId(s, id) && id == boardId);
+
+		// the serial switches to the new framing once it has received the reply
+		unsigned char const protocol[4] = { CT_MISC, DT_MISC_PROTOCOL,
+				PROTOCOL_V2, CT_MISC + DT_MISC_PROTOCOL + PROTOCOL_V2 };
+		unsigned char reply[10];
+		EMULATOR_CHECK(
+				s.transfer(protocol, sizeof(protocol), reply, 5, 50)
+						&& reply[3] == PROTOCOL_V2);
+		EMULATOR_CHECK(s.getProtocolVersion() == PROTOCOL_V2);
+		id = 0;
+		EMULATOR_CHECK(transferId(s, id) && id == boardId);
+
+		// a frame with a wrong crc is dropped and counted by the board, which stays in sync
+		unsigned char frame[3 + 2 + 2] = { FRAME_START, 2, 0x10, CT_MISC,
+				DT_MISC_ID };
+		unsigned short const crc = computeCrc16(frame + 1, 4) ^ 0x0101;
+		frame[5] = crc & 0xFF;
+		frame[6] = (crc >> 8) & 0xFF;
+		s.setProtocolVersion(PROTOCOL_V1); // the frame is passed on as it is
+		EMULATOR_CHECK(s.send(frame, sizeof(frame)));
+		s.setProtocolVersion(PROTOCOL_V2);
+		unsigned char const errors[3] = { CT_MISC, DT_MISC_ERRORS, CT_MISC
+				+ DT_MISC_ERRORS };
+		EMULATOR_CHECK(
+				s.transfer(errors, sizeof(errors), reply, 10, 50)
+						&& reply[2] != MISC_NOK);
+		EMULATOR_CHECK((reply[3] | (reply[4] << 8)) == 1);
+
+		// the reply of the next request shows the host the reply it has missed before its deadline
+		unsigned char const idRequest[3] = { CT_MISC, DT_MISC_ID, CT_MISC
+				+ DT_MISC_ID };
+		e.setLineFaults(100, 0);
+		s.asyncRequest(idRequest, sizeof(idRequest), 6, replyHandler(),
+				500);
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(5));
+		e.setLineFaults(0, 0);
+		id = 0;
+		EMULATOR_CHECK(transferId(s, id) && id == boardId);
+		EMULATOR_CHECK(s.getLostReplyCount() == 1);
+		EMULATOR_CHECK(s.getCorruptReplyCount() == 0);
+		EMULATOR_CHECK(s.getTimeoutCount() == 0);
+
+		// random bytes in front of the replies are skipped, a failed transfer never returns a wrong id
+		e.setLineFaults(0, 100);
+		unsigned int numOk = 0;
+		for (unsigned int i = 0; i < 20; i++) {
+			id = 0;
+			if (transferId(s, id)) {
+				EMULATOR_CHECK(id == boardId);
+				numOk++;
+			}
+		}
+		e.setLineFaults(0, 0);
+		EMULATOR_CHECK(numOk > 0);
+		EMULATOR_CHECK(s.getDiscardedByteCount() > 0);
+		id = 0;
+		EMULATOR_CHECK(transferId(s, id) && id == boardId);
+	}
+
+	return emulatorTest::getResult();
+}
@@ -29,13 +29,160 @@
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include <string.h>
 #include "gpio.h"
+#include "servo.h"
 #include "hal.h"
 #include "project.h"
 
-// static variables
-static volatile s_pin io2, io3, io4, io5, io6, io7, io8, io9, io10, io11, io12, io13;
+// registers of a port, the pins of the port are bit (pin number - shift) of the registers
+typedef struct {
+	volatile uint8_t *pin;
+	volatile uint8_t *ddr;
+	volatile uint8_t *port;
+	volatile uint8_t *pcmsk;
+	uint8_t shift;
+} s_gpio_port;
+
+#define GPIO_PORT_D		(0) // D2 to D7
+#define GPIO_PORT_B		(1) // D8 to D13
+#define GPIO_NUM_PORTS	(2)
+
+static s_gpio_port const gpio_ports[GPIO_NUM_PORTS] PROGMEM = {
+	{&IO2_PIN, &IO2_DDR, &IO2_PORT, &IO2_PCMSK, 2 - IO2},
+	{&IO8_PIN, &IO8_DDR, &IO8_PORT, &IO8_PCMSK, 8 - IO8},
+};
+
+// pin descriptor, indexed by gpio_pin
+typedef struct {
+	uint8_t port;	// index into gpio_ports
+	uint8_t bit;	// mask of the pin in the port registers
+	uint8_t pcint;	// mask of the pin in the pin change mask register
+} s_gpio_desc;
+
+static s_gpio_desc const gpio_desc[D_ERR] PROGMEM = {
+	{GPIO_PORT_D, (1<<IO2),  (1<<IO2_PCINT)},
+	{GPIO_PORT_D, (1<<IO3),  (1<<IO3_PCINT)},
+	{GPIO_PORT_D, (1<<IO4),  (1<<IO4_PCINT)},
+	{GPIO_PORT_D, (1<<IO5),  (1<<IO5_PCINT)},
+	{GPIO_PORT_D, (1<<IO6),  (1<<IO6_PCINT)},
+	{GPIO_PORT_D, (1<<IO7),  (1<<IO7_PCINT)},
+	{GPIO_PORT_B, (1<<IO8),  (1<<IO8_PCINT)},
+	{GPIO_PORT_B, (1<<IO9),  (1<<IO9_PCINT)},
+	{GPIO_PORT_B, (1<<IO10), (1<<IO10_PCINT)},
+	{GPIO_PORT_B, (1<<IO11), (1<<IO11_PCINT)},
+	{GPIO_PORT_B, (1<<IO12), (1<<IO12_PCINT)},
+	{GPIO_PORT_B, (1<<IO13), (1<<IO13_PCINT)},
+};
+
+#define PORT_REG(p, reg)	((volatile uint8_t *)pgm_read_word(&gpio_ports[(p)].reg))
+
+// values and edges of the input pins as seen by the pin change interrupts, bit per pin number
+static volatile uint16_t in_value = 0;
+static volatile uint16_t in_rise = 0;
+static volatile uint16_t in_fall = 0;
+
+// events of the subscribed pins, bit per pin number
+static volatile uint16_t ev_subscribed = 0;
+static volatile uint16_t ev_pending = 0;
+static volatile uint16_t ev_value = 0;
+static volatile uint16_t ev_rise = 0;
+static volatile uint16_t ev_fall = 0;
+
+// configured pins, bit per pin number
+static uint16_t cfg_inputs = 0;
+static uint16_t cfg_outputs = 0;
+
+// debounced input pins, sampled by sampleGpio instead of the pin change interrupts, bit per pin number
+static volatile uint16_t db_pins = 0;
+static volatile uint8_t db_time[D_ERR];		// samples a new value must be stable, indexed by gpio_pin
+static volatile uint8_t db_count[D_ERR];	// consecutive samples which differ from the stable value
+
+// edges of every input pin since the last readGpioCounts, indexed by gpio_pin
+static volatile uint16_t cnt_rise[D_ERR];
+static volatile uint16_t cnt_fall[D_ERR];
+
+// timestamped edges of the recorded pins, bit per pin number
+#define EDGE_QUEUE_SIZE (32)
+
+typedef struct {
+	uint8_t pin; // pin number, bit 7 is set for a rising edge
+	uint32_t time_us;
+} s_edge;
+
+static volatile uint16_t edge_recorded = 0;
+static volatile s_edge edge_queue[EDGE_QUEUE_SIZE];
+static volatile uint8_t edge_rd_ptr = 0;
+static volatile uint8_t edge_wr_ptr = 0;
+static volatile uint8_t edge_cnt = 0;
+static volatile uint16_t edge_lost = 0; // edges dropped since the queue was full
+
+/**
+ * @brief returns the bit of a pin in the bitmaps, bit per pin number
+ */
+static inline uint16_t pinMask(gpio_pin const pin) {
+	return ((uint16_t)1) << ((uint8_t)pin + 2);
+}
+
+/**
+ * @brief latches the edges of the changed pins, counts them, latches them for the events and queues the
+ * ones of the recorded pins, interrupts must be disabled
+ * @param changed pins which have changed, bit per pin number
+ * @param value new values of the pins, bit per pin number
+ * @param now time of the edges, only valid while a pin is recorded
+ */
+static inline void latchEdges(uint16_t const changed, uint16_t const value, uint32_t const now) {
+	uint16_t const rises = changed & value;
+	uint16_t const falls = changed & ~value;
+	in_value ^= changed;
+	in_rise |= rises;
+	in_fall |= falls;
+
+	uint16_t const subscribed = changed & ev_subscribed;
+	if(subscribed) {
+		ev_value = (ev_value & ~subscribed) | (rises & subscribed);
+		ev_rise |= rises & subscribed;
+		ev_fall |= falls & subscribed;
+		ev_pending |= subscribed;
+	}
+
+	// counters and queue are kept per pin, usually a single pin has changed
+	uint16_t const recorded = changed & edge_recorded;
+	uint16_t bits = changed >> 2;
+	for(uint8_t pinNumber = 2; bits != 0; pinNumber++, bits >>= 1) {
+		if((bits & 0x01) == 0) continue;
+		uint16_t const mask = ((uint16_t)1) << pinNumber;
+		uint8_t const isRising = (rises & mask) ? 1 : 0;
+		if(isRising) cnt_rise[pinNumber - 2]++;
+		else         cnt_fall[pinNumber - 2]++;
+		if(recorded & mask) {
+			if(edge_cnt == EDGE_QUEUE_SIZE) {
+				edge_lost++;
+				continue;
+			}
+			edge_queue[edge_wr_ptr].pin = pinNumber | (isRising ? 0x80 : 0);
+			edge_queue[edge_wr_ptr].time_us = now;
+			edge_wr_ptr = (edge_wr_ptr + 1) % EDGE_QUEUE_SIZE;
+			edge_cnt++;
+		}
+	}
+}
+
+/**
+ * @brief latches the edges of the enabled pins of a port which have changed since the last interrupt,
+ * called by the pin change ISRs with the constant registers of their port
+ * @param pins value of the PINx register
+ * @param enabled value of the PCMSKx register
+ * @param shift pin number of bit 0 of the port
+ */
+static inline void latchPortEdges(uint8_t const pins, uint8_t const enabled, uint8_t const shift) {
+	uint32_t const now = edge_recorded ? getTime_us() : 0;
+
+	uint16_t const value = ((uint16_t)pins) << shift;
+	uint16_t const changed = (value ^ in_value) & (((uint16_t)enabled) << shift);
+	if(changed) latchEdges(changed, value, now);
+}
 
 /**
  * @brief initialies the gpio handling
@@ -43,18 +190,14 @@ static volatile s_pin io2, io3, io4, io5, io6, io7, io8, io9, io10, io11, io12,
 void initGpio() {
 	MCUCR &= ~(1<<PUD); // clear pull up disable, thereby preparing to allow the use of a pullup
 	PCICR |=  (1<<PCIE0) | (1<<PCIE2); // enable pin change interrupts at PCINT[7:0], PCINT[23:16]
-	memset((void*)&io2, 0, sizeof(io2)); // set everything to zero
-	memset((void*)&io3, 0, sizeof(io3));
-	memset((void*)&io4, 0, sizeof(io4));
-	memset((void*)&io5, 0, sizeof(io5));
-	memset((void*)&io6, 0, sizeof(io6));
-	memset((void*)&io6, 0, sizeof(io7));
-	memset((void*)&io8, 0, sizeof(io8));
-	memset((void*)&io9, 0, sizeof(io9));
-	memset((void*)&io10, 0, sizeof(io10));
-	memset((void*)&io11, 0, sizeof(io11));
-	memset((void*)&io12, 0, sizeof(io12));
-	memset((void*)&io13, 0, sizeof(io13));
+	in_value = in_rise = in_fall = 0;
+	ev_subscribed = ev_pending = ev_value = ev_rise = ev_fall = 0;
+	cfg_inputs = cfg_outputs = 0;
+	db_pins = 0;
+	memset((void*)cnt_rise, 0, sizeof(cnt_rise));
+	memset((void*)cnt_fall, 0, sizeof(cnt_fall));
+	edge_recorded = edge_lost = 0;
+	edge_rd_ptr = edge_wr_ptr = edge_cnt = 0;
 }
 
 /**
@@ -65,180 +208,104 @@ void initGpio() {
  * @param 1 = pullUpEnabled, needs to be set only in case of input
  */
 void configGpio(gpio_pin const pin, gpio_dir const dir, uint8_t const value, uint8_t const pullUpEnabled) {
+	if(pin == D_ERR) return;
 
-	switch(pin) {
-	case D2: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO2_DDR, IO2);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO2_PORT, IO2);
-			else clear_bit(IO2_PORT, IO2);
-			set_bit(IO2_PCMSK, IO2_PCINT);
-			clear_bit(IO2_DDR, IO2);
-			io2.pin.value = (IO2_PIN & (1<<IO2)) >> IO2;
-		}
-	}
-	break;
-	case D3: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO3_DDR, IO3);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO3_PORT, IO3);
-			else clear_bit(IO3_PORT, IO3);
-			set_bit(IO3_PCMSK, IO3_PCINT);
-			clear_bit(IO3_DDR, IO3);
-			io3.pin.value = (IO3_PIN & (1<<IO3)) >> IO3;
-		}
-	}
-	break;
-	case D4: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO4_DDR, IO4);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO4_PORT, IO4);
-			else clear_bit(IO4_PORT, IO4);
-			set_bit(IO4_PCMSK, IO4_PCINT);
-			clear_bit(IO4_DDR, IO4);
-			io4.pin.value = (IO4_PIN & (1<<IO4)) >> IO4;
-		}
-	}
-	break;
-	case D5: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO5_DDR, IO5);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO5_PORT, IO5);
-			else clear_bit(IO5_PORT, IO5);
-			set_bit(IO5_PCMSK, IO5_PCINT);
-			clear_bit(IO5_DDR, IO5);
-			io5.pin.value = (IO5_PIN & (1<<IO5)) >> IO5;
-		}
-	}
-	break;
-	case D6: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO6_DDR, IO6);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO6_PORT, IO6);
-			else clear_bit(IO6_PORT, IO6);
-			set_bit(IO6_PCMSK, IO6_PCINT);
-			clear_bit(IO6_DDR, IO6);
-			io6.pin.value = (IO6_PIN & (1<<IO6)) >> IO6;
-		}
-	}
-	break;
-	case D7: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO7_DDR, IO7);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO7_PORT, IO7);
-			else clear_bit(IO7_PORT, IO7);
-			set_bit(IO7_PCMSK, IO7_PCINT);
-			clear_bit(IO7_DDR, IO7);
-			io7.pin.value = (IO7_PIN & (1<<IO7)) >> IO7;
-		}
-	}
-	break;
-	case D8: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO8_DDR, IO8);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO8_PORT, IO8);
-			else clear_bit(IO8_PORT, IO8);
-			set_bit(IO8_PCMSK, IO8_PCINT);
-			clear_bit(IO8_DDR, IO8);
-			io8.pin.value = (IO8_PIN & (1<<IO8)) >> IO8;
-		}
-	}
-	break;
-	case D9: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO9_DDR, IO9);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO9_PORT, IO9);
-			else clear_bit(IO9_PORT, IO9);
-			set_bit(IO9_PCMSK, IO9_PCINT);
-			clear_bit(IO9_DDR, IO9);
-			io9.pin.value = (IO9_PIN & (1<<IO9)) >> IO9;
-		}
-	}
-	break;
-	case D10: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO10_DDR, IO10);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO10_PORT, IO10);
-			else clear_bit(IO10_PORT, IO10);
-			set_bit(IO10_PCMSK, IO10_PCINT);
-			clear_bit(IO10_DDR, IO10);
-			io10.pin.value = (IO10_PIN & (1<<IO10)) >> IO10;
-		}
-	}
-	break;
-	case D11: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO11_DDR, IO11);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO11_PORT, IO11);
-			else clear_bit(IO11_PORT, IO11);
-			set_bit(IO11_PCMSK, IO11_PCINT);
-			clear_bit(IO11_DDR, IO11);
-			io11.pin.value = (IO11_PIN & (1<<IO11)) >> IO11;
-		}
+	uint8_t const p = pgm_read_byte(&gpio_desc[pin].port);
+	uint8_t const bit = pgm_read_byte(&gpio_desc[pin].bit);
+	uint8_t const pcint = pgm_read_byte(&gpio_desc[pin].pcint);
+	volatile uint8_t *ddr = PORT_REG(p, ddr);
+	volatile uint8_t *port = PORT_REG(p, port);
+	volatile uint8_t *pcmsk = PORT_REG(p, pcmsk);
+	uint16_t const mask = pinMask(pin);
+
+	if(dir == Output) {
+		writeGpio(pin, value);
+		cli();
+		*pcmsk &= ~pcint; // the edges of an output are not reported
+		*ddr |= bit;
+		cfg_outputs |= mask; cfg_inputs &= ~mask;
+	}
+	else {
+		cli();
+		if(pullUpEnabled == 1) *port |= bit;
+		else *port &= ~bit;
+		*pcmsk |= pcint;
+		*ddr &= ~bit;
+		if(*PORT_REG(p, pin) & bit) in_value |= mask;
+		else                        in_value &= ~mask;
+		cfg_inputs |= mask;  cfg_outputs &= ~mask;
+	}
+	db_pins &= ~mask;
+	cnt_rise[pin] = cnt_fall[pin] = 0;
+	sei();
+}
+
+/**
+ * @brief sets the debounce time of a gpio input pin, the pin is sampled by sampleGpio instead of
+ * triggering the pin change interrupt and a new value counts as edge once it has been stable
+ * @param pin pin to debounce
+ * @param debounce_ms debounce time in ms, 0 = edges are latched by the pin change interrupt at once
+ */
+void debounceGpio(gpio_pin const pin, uint8_t const debounce_ms) {
+	if(pin == D_ERR) return;
+
+	uint8_t const pcint = pgm_read_byte(&gpio_desc[pin].pcint);
+	volatile uint8_t *pcmsk = PORT_REG(pgm_read_byte(&gpio_desc[pin].port), pcmsk);
+	uint16_t const mask = pinMask(pin);
+
+	cli();
+	db_time[pin] = debounce_ms / GPIO_SAMPLE_PERIOD_MS;
+	db_count[pin] = 0;
+	if(debounce_ms > 0 && (cfg_inputs & mask)) {
+		db_pins |= mask;
+		*pcmsk &= ~pcint;
 	}
-	break;
-	case D12: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO12_DDR, IO12);
-		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO12_PORT, IO12);
-			else clear_bit(IO12_PORT, IO12);
-			clear_bit(IO12_DDR, IO12);
-			set_bit(IO12_PCMSK, IO12_PCINT);
-			io12.pin.value = (IO12_PIN & (1<<IO12)) >> IO12;
-		}
+	else {
+		db_pins &= ~mask;
+		if(cfg_inputs & mask) *pcmsk |= pcint;
 	}
-	break;
-	case D13: {
-	    if(dir == Output) {
-			writeGpio(pin, value);
-			set_bit(IO13_DDR, IO13);
+	sei();
+}
+
+/**
+ * @brief samples the debounced input pins, called every GPIO_SAMPLE_PERIOD_MS by the timer 0 ISR
+ */
+void sampleGpio() {
+	uint16_t const pins = db_pins;
+	if(pins == 0) return;
+
+	uint16_t const value = (((uint16_t)IO2_PIN) << (2 - IO2)) | (((uint16_t)IO8_PIN) << (8 - IO8));
+	uint16_t const differing = (value ^ in_value) & pins;
+	uint16_t stable = 0;
+	for(uint8_t i = 0; i < D_ERR; i++) {
+		uint16_t const mask = ((uint16_t)1) << (i + 2);
+		if((pins & mask) == 0) continue;
+		if((differing & mask) == 0) {
+			db_count[i] = 0; // bounced back to the stable value
 		}
-		else {
-			if(pullUpEnabled == 1) set_bit(IO13_PORT, IO13);
-			else clear_bit(IO13_PORT, IO13);
-			clear_bit(IO13_DDR, IO13);
-			set_bit(IO13_PCMSK, IO13_PCINT);
-			io13.pin.value = (IO13_PIN & (1<<IO13)) >> IO13;
+		else if(++db_count[i] >= db_time[i]) {
+			db_count[i] = 0;
+			stable |= mask;
 		}
 	}
-	break;
-	default: {
-	}
-	break;
-	}
+
+	if(stable) latchEdges(stable, value, edge_recorded ? getTime_us() : 0);
+}
+
+/**
+ * @brief reads the status of a gpio input pin, interrupts must be disabled
+ * @param pin pin to read 
+ * @param value current value of the pin
+ * @param rise signals that a rising edge has occured
+ * @param fall signals that a falling edge has occured
+ */
+static void readGpioLocked(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall) {
+	uint16_t const mask = pinMask(pin);
+	*value = (in_value & mask) ? 1 : 0;
+	*rise  = (in_rise & mask) ? 1 : 0;
+	*fall  = (in_fall & mask) ? 1 : 0;
+	in_rise &= ~mask;
+	in_fall &= ~mask;
 }
 
 /**
@@ -249,87 +316,29 @@ void configGpio(gpio_pin const pin, gpio_dir const dir, uint8_t const value, uin
  * @param fall signals that a falling edge has occured
  */
 void readGpio(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall) {
+	if(pin == D_ERR) return;
+	cli();
+	readGpioLocked(pin, value, rise, fall);
+	sei();
+}
 
-	cli();	
-
-	switch(pin) {
-	case D2: {
-		*value = io2.pin.value;
-		*rise  = io2.pin.rise; io2.pin.rise = 0;
-		*fall  = io2.pin.fall; io2.pin.fall = 0;
-	}
-	break;
-	case D3: {
-		*value = io3.pin.value;
-		*rise  = io3.pin.rise; io3.pin.rise = 0;
-		*fall  = io3.pin.fall; io3.pin.fall = 0;
-	}
-	break;
-	case D4: {
-		*value = io4.pin.value;
-		*rise  = io4.pin.rise; io4.pin.rise = 0;
-		*fall  = io4.pin.fall; io4.pin.fall = 0;
-	}
-	break;
-	case D5: {
-		*value = io5.pin.value;
-		*rise  = io5.pin.rise; io5.pin.rise = 0;
-		*fall  = io5.pin.fall; io5.pin.fall = 0;
-	}
-	break;
-	case D6: {
-		*value = io6.pin.value;
-		*rise  = io6.pin.rise; io6.pin.rise = 0;
-		*fall  = io6.pin.fall; io6.pin.fall = 0;
-	}
-	break;
-	case D7: {
-		*value = io7.pin.value;
-		*rise  = io7.pin.rise; io7.pin.rise = 0;
-		*fall  = io7.pin.fall; io7.pin.fall = 0;
-	}
-	break;
-	case D8: {
-		*value = io8.pin.value;
-		*rise  = io8.pin.rise; io8.pin.rise = 0;
-		*fall  = io8.pin.fall; io8.pin.fall = 0;
-	}
-	break;
-	case D9: {
-		*value = io9.pin.value;
-		*rise  = io9.pin.rise; io9.pin.rise = 0;
-		*fall  = io9.pin.fall; io9.pin.fall = 0;
-	}
-	break;
-	case D10: {
-		*value = io10.pin.value;
-		*rise  = io10.pin.rise; io10.pin.rise = 0;
-		*fall  = io10.pin.fall; io10.pin.fall = 0;
-	}
-	break;
-	case D11: {
-		*value = io11.pin.value;
-		*rise  = io11.pin.rise; io11.pin.rise = 0;
-		*fall  = io11.pin.fall; io11.pin.fall = 0;
-	}
-	break;
-	case D12: {
-		*value = io12.pin.value;
-		*rise  = io12.pin.rise; io12.pin.rise = 0;
-		*fall  = io12.pin.fall; io12.pin.fall = 0;
-	}
-	break;
-	case D13: {
-		*value = io13.pin.value;
-		*rise  = io13.pin.rise; io13.pin.rise = 0;
-		*fall  = io13.pin.fall; io13.pin.fall = 0;
-	}
-	break;
-	default: {
-	}
-	break;
-	}
+/**
+ * @brief reads the status of a gpio input pin like readGpio together with the number of its edges, the
+ * counts are reset to zero
+ * @param pin pin to read
+ * @param value current value of the pin
+ * @param rise signals that a rising edge has occured
+ * @param fall signals that a falling edge has occured
+ * @param rises rising edges since the last readout of the counts, modulo 65536
+ * @param falls falling edges since the last readout of the counts, modulo 65536
+ */
+void readGpioCounts(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall, uint16_t *rises, uint16_t *falls) {
+	if(pin == D_ERR) return;
 
+	cli();
+	readGpioLocked(pin, value, rise, fall);
+	*rises = cnt_rise[pin]; cnt_rise[pin] = 0;
+	*falls = cnt_fall[pin]; cnt_fall[pin] = 0;
 	sei();
 }
 
@@ -339,215 +348,192 @@ void readGpio(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall)
  * @param value value to be written at a port pin
  */
 void writeGpio(gpio_pin const pin, uint8_t const value) {
-	
-	switch(pin) {
-	case D2: {
-		if(value == 0) clear_bit(IO2_PORT, IO2);
-		else if(value == 1) set_bit(IO2_PORT, IO2);
-	}
-	break;
-	case D3: {
-		if(value == 0) clear_bit(IO3_PORT, IO3);
-		else if(value == 1) set_bit(IO3_PORT, IO3);
-	}
-	break;
-	case D4: {
-		if(value == 0) clear_bit(IO4_PORT, IO4);
-		else if(value == 1) set_bit(IO4_PORT, IO4);
-	}
-	break;
-	case D5: {
-		if(value == 0) clear_bit(IO5_PORT, IO5);
-		else if(value == 1) set_bit(IO5_PORT, IO5);
-	}
-	break;
-	case D6: {
-		if(value == 0) clear_bit(IO6_PORT, IO6);
-		else if(value == 1) set_bit(IO6_PORT, IO6);
-	}
-	break;
-	case D7: {
-		if(value == 0) clear_bit(IO7_PORT, IO7);
-		else if(value == 1) set_bit(IO7_PORT, IO7);
-	}
-	break;
-	case D8: {
-		if(value == 0) clear_bit(IO8_PORT, IO8);
-		else if(value == 1) set_bit(IO8_PORT, IO8);
-	}
-	break;
-	case D9: {
-		if(value == 0) clear_bit(IO9_PORT, IO9);
-		else if(value == 1) set_bit(IO9_PORT, IO9);
-	}
-	break;
-	case D10: {
-		if(value == 0) clear_bit(IO10_PORT, IO10);
-		else if(value == 1) set_bit(IO10_PORT, IO10);
-	}
-	break;
-	case D11: {
-		if(value == 0) clear_bit(IO11_PORT, IO11);
-		else if(value == 1) set_bit(IO11_PORT, IO11);
-	}
-	break;
-	case D12: {
-		if(value == 0) clear_bit(IO12_PORT, IO12);
-		else if(value == 1) set_bit(IO12_PORT, IO12);
-	}
-	break;
-	case D13: {
-		if(value == 0) clear_bit(IO13_PORT, IO13);
-		else if(value == 1) set_bit(IO13_PORT, IO13);
-	}
-	break;
-	default: {
-	}
-	break;
-	}
+	if(pin == D_ERR || value > 1) return;
+
+	uint8_t const bit = pgm_read_byte(&gpio_desc[pin].bit);
+	volatile uint8_t *port = PORT_REG(pgm_read_byte(&gpio_desc[pin].port), port);
+
+	// the software servos write the same ports from their ISR
+	uint8_t const sreg = SREG;
+	cli();
+	if(value == 0) *port &= ~bit;
+	else           *port |= bit;
+	SREG = sreg;
 }
 
 /**
- * @brief converts a number to the corresponding gpio pin
+ * @brief reads the status of all configured gpio input pins selected by a mask, bit per pin number
+ * @param mask pins to read
+ * @param inputs configured input pins which have been read
+ * @param value current values of the pins
+ * @param rise pins with a rising edge since their last readout
+ * @param fall pins with a falling edge since their last readout
+ */
+void readGpioPort(uint16_t const mask, uint16_t *inputs, uint16_t *value, uint16_t *rise, uint16_t *fall) {
+	uint16_t const selected = mask & cfg_inputs;
+	*inputs = selected;
+
+	cli();
+	*value = in_value & selected;
+	*rise = in_rise & selected;
+	*fall = in_fall & selected;
+	in_rise &= ~selected;
+	in_fall &= ~selected;
+	sei();
+}
+
+/**
+ * @brief writes the values of all configured gpio output pins selected by a mask, bit per pin number,
+ * the pins of a port change at the same time
+ * @param mask pins to write
+ * @param value values to be written
+ * @return configured output pins which have been written
+ */
+uint16_t writeGpioPort(uint16_t const mask, uint16_t const value) {
+	uint16_t const outputs = mask & cfg_outputs;
+	for(uint8_t p = 0; p < GPIO_NUM_PORTS; p++) {
+		uint8_t const shift = pgm_read_byte(&gpio_ports[p].shift);
+		uint8_t const bits = (uint8_t)(outputs >> shift);
+		if(bits == 0) continue;
+		volatile uint8_t *port = PORT_REG(p, port);
+		uint8_t const sreg = SREG;
+		cli();
+		*port = (*port & ~bits) | ((uint8_t)(value >> shift) & bits);
+		SREG = sreg;
+	}
+	return outputs;
+}
+
+/**
+ * @brief enables or disables the events of a gpio input pin, the pin change interrupts latch the
+ * edges of a subscribed pin until they are fetched by fetchGpioEvent
+ * @param pin pin to subscribe
+ * @param isSubscribed 1 = events are latched, 0 = events are discarded
+ */
+void subscribeGpio(gpio_pin const pin, uint8_t const isSubscribed) {
+	if(pin == D_ERR) return;
+	uint16_t const mask = ((uint16_t)1) << ((uint8_t)pin + 2);
+
+	cli();
+
+	if(isSubscribed == 1) ev_subscribed |= mask;
+	else                  ev_subscribed &= ~mask;
+	ev_pending &= ~mask;
+	ev_rise &= ~mask;
+	ev_fall &= ~mask;
+
+	sei();
+}
+
+/**
+ * @brief returns the pins with a pending event, bit per pin number
+ */
+uint16_t getGpioEvents() {
+	cli();
+
+	uint16_t tmp = ev_pending;
+
+	sei();
+
+	return tmp;
+}
+
+/**
+ * @brief fetches the pending event of a subscribed pin, the edges of a pin are combined until its
+ * event is fetched
  * @param pinNumber number of the pin e.g. 3 for D3
- * @return corresponding gpio pin
+ * @param flags value, rising and falling edge at bit 0, 1 and 2 like the reply to a gpio read
+ * @return 1 if an event has been fetched, 0 if no event is pending
  */
-gpio_pin convertNumberToGpio(uint8_t const pinNumber) {
+uint8_t fetchGpioEvent(uint8_t const pinNumber, uint8_t *flags) {
+	uint16_t const mask = ((uint16_t)1) << pinNumber;
+	uint8_t isPending = 0;
 
-	switch(pinNumber) {
-	case 2: return D2; break;
-	case 3: return D3; break;
-	case 4: return D4; break;
-	case 5: return D5; break;
-	case 6: return D6; break;
-	case 7: return D7; break;
-	case 8: return D8; break;
-	case 9: return D9; break;
-	case 10: return D10; break;
-	case 11: return D11; break;
-	case 12: return D12; break;
-	case 13: return D13; break;
-	default: return D_ERR; break;
+	cli();
+
+	if(ev_pending & mask) {
+		*flags = ((ev_value & mask) ? 0x01 : 0) | ((ev_rise & mask) ? 0x02 : 0) | ((ev_fall & mask) ? 0x04 : 0);
+		ev_pending &= ~mask;
+		ev_rise &= ~mask;
+		ev_fall &= ~mask;
+		isPending = 1;
 	}
+
+	sei();
+
+	return isPending;
 }
 
 /**
- * @brief pin change interrupt 0 ISR
+ * @brief enables or disables the recording of the edges of a gpio input pin, the pin change interrupts
+ * queue every edge of a recorded pin with its time until it is fetched by fetchGpioEdges
+ * @param pin pin to record
+ * @param isRecorded 1 = edges are queued, 0 = edges are not queued
  */
-ISR(PCINT0_vect) {
+void recordGpioEdges(gpio_pin const pin, uint8_t const isRecorded) {
+	if(pin == D_ERR) return;
+	uint16_t const mask = ((uint16_t)1) << ((uint8_t)pin + 2);
 
-	if(IO8_PCMSK & (1<<IO8_PCINT)) {
-		uint8_t io8_val  = (IO8_PIN & (1<<IO8)) >> IO8;
-		if(io8_val != io8.pin.value) {
-			if(io8_val == 0) io8.pin.fall = 1;
-			else             io8.pin.rise = 1;
-			io8.pin.value = io8_val;
-		}
-	}
+	cli();
 
-	if(IO9_PCMSK & (1<<IO9_PCINT)) {
-		uint8_t io9_val  = (IO9_PIN & (1<<IO9)) >> IO9;
-		if(io9_val != io9.pin.value) {
-			if(io9_val == 0) io9.pin.fall = 1;
-			else             io9.pin.rise = 1;
-			io9.pin.value = io9_val;
-		}
-	}
+	if(isRecorded == 1) edge_recorded |= mask;
+	else                edge_recorded &= ~mask;
 
-	if(IO10_PCMSK & (1<<IO10_PCINT)) {
-		uint8_t io10_val  = (IO10_PIN & (1<<IO10)) >> IO10;
-		if(io10_val != io10.pin.value) {
-			if(io10_val == 0) io10.pin.fall = 1;
-			else              io10.pin.rise = 1;
-			io10.pin.value = io10_val;
-		}
-	}
-	
-	if(IO11_PCMSK & (1<<IO11_PCINT)) {
-		uint8_t io11_val  = (IO11_PIN & (1<<IO11)) >> IO11;
-		if(io11_val != io11.pin.value) {
-			if(io11_val == 0) io11.pin.fall = 1;
-			else              io11.pin.rise = 1;
-			io11.pin.value = io11_val;
-		}
-	}
-	
-	if(IO12_PCMSK & (1<<IO12_PCINT)) {
-		uint8_t io12_val  = (IO12_PIN & (1<<IO12)) >> IO12;
-		if(io12_val != io12.pin.value) {
-			if(io12_val == 0) io12.pin.fall = 1;
-			else              io12.pin.rise = 1;
-			io12.pin.value = io12_val;
-		}
-	}
-	
-	if(IO13_PCMSK & (1<<IO13_PCINT)) {
-		uint8_t io13_val  = (IO13_PIN & (1<<IO13)) >> IO13;
-		if(io13_val != io13.pin.value) {
-			if(io13_val == 0) io13.pin.fall = 1;
-			else              io13.pin.rise = 1;
-			io13.pin.value = io13_val;
-		}
-	}
+	sei();
 }
 
 /**
- * @brief pin change interrupt 2 ISR
+ * @brief fetches the oldest queued edges
+ * @param records buffer receiving GPIO_EDGE_RECORD_SIZE bytes per edge: pin number with bit 7 set for a
+ * rising edge, time in us with the low byte first
+ * @param maxEdges maximum number of edges to fetch
+ * @param lost number of edges dropped since the start of the board as the queue was full
+ * @return number of edges fetched
  */
-ISR(PCINT2_vect) {
+uint8_t fetchGpioEdges(uint8_t *records, uint8_t const maxEdges, uint16_t *lost) {
+	uint8_t numEdges = 0;
 
-	if(IO2_PCMSK & (1<<IO2_PCINT)) {
-		uint8_t io2_val  = (IO2_PIN & (1<<IO2)) >> IO2;
-		if(io2_val != io2.pin.value) {
-			if(io2_val == 0) io2.pin.fall = 1;
-			else             io2.pin.rise = 1;
-			io2.pin.value = io2_val;
-		}
-	}
+	cli();
 
-	if(IO3_PCMSK & (1<<IO3_PCINT)) {
-		uint8_t io3_val  = (IO3_PIN & (1<<IO3)) >> IO3;
-		if(io3_val != io3.pin.value) {
-			if(io3_val == 0) io3.pin.fall = 1;
-			else             io3.pin.rise = 1;
-			io3.pin.value = io3_val;
-		}
-	}
+	while(edge_cnt > 0 && numEdges < maxEdges) {
+		uint32_t const time_us = edge_queue[edge_rd_ptr].time_us;
+		records[0] = edge_queue[edge_rd_ptr].pin;
+		records[1] = (uint8_t)(time_us & 0xFF);
+		records[2] = (uint8_t)((time_us >> 8) & 0xFF);
+		records[3] = (uint8_t)((time_us >> 16) & 0xFF);
+		records[4] = (uint8_t)((time_us >> 24) & 0xFF);
+		records += GPIO_EDGE_RECORD_SIZE;
+		edge_rd_ptr = (edge_rd_ptr + 1) % EDGE_QUEUE_SIZE;
+		edge_cnt--;
+		numEdges++;
+	}
+	*lost = edge_lost;
 
-	if(IO4_PCMSK & (1<<IO4_PCINT)) {
-		uint8_t io4_val  = (IO4_PIN & (1<<IO4)) >> IO4;
-		if(io4_val != io4.pin.value) {
-			if(io4_val == 0) io4.pin.fall = 1;
-			else             io4.pin.rise = 1;
-			io4.pin.value = io4_val;
-		}
-	}
-	
-	if(IO5_PCMSK & (1<<IO5_PCINT)) {
-		uint8_t io5_val  = (IO5_PIN & (1<<IO5)) >> IO5;
-		if(io5_val != io5.pin.value) {
-			if(io5_val == 0) io5.pin.fall = 1;
-			else             io5.pin.rise = 1;
-			io5.pin.value = io5_val;
-		}
-	}
-	
-	if(IO6_PCMSK & (1<<IO6_PCINT)) {
-		uint8_t io6_val  = (IO6_PIN & (1<<IO6)) >> IO6;
-		if(io6_val != io6.pin.value) {
-			if(io6_val == 0) io6.pin.fall = 1;
-			else             io6.pin.rise = 1;
-			io6.pin.value = io6_val;
-		}
-	}
-	
-
-	if(IO7_PCMSK & (1<<IO7_PCINT)) {
-		uint8_t io7_val  = (IO7_PIN & (1<<IO7)) >> IO7;
-		if(io7_val != io7.pin.value) {
-			if(io7_val == 0) io7.pin.fall = 1;
-			else             io7.pin.rise = 1;
-			io7.pin.value = io7_val;
-		}
-	}
+	sei();
+
+	return numEdges;
+}
+
+/**
+ * @brief converts a number to the corresponding gpio pin
+ * @param pinNumber number of the pin e.g. 3 for D3
+ * @return corresponding gpio pin
+ */
+gpio_pin convertNumberToGpio(uint8_t const pinNumber) {
+	if(pinNumber < 2 || pinNumber > 13) return D_ERR;
+	return (gpio_pin)(pinNumber - 2);
+}
+
+/**
+ * @brief pin change interrupt 0 ISR, D8 to D13
+ */
+ISR(PCINT0_vect) {
+	latchPortEdges(IO8_PIN, IO8_PCMSK, 8 - IO8);
+}
+
+/**
+ * @brief pin change interrupt 2 ISR, D2 to D7
+ */
+ISR(PCINT2_vect) {
+	latchPortEdges(IO2_PIN, IO2_PCMSK, 2 - IO2);
 }
@@ -35,6 +35,9 @@
 typedef enum {D2, D3, D4, D5, D6, D7, D8, D9, D10, D11, D12, D13, D_ERR} gpio_pin;
 typedef enum {Input, Output} gpio_dir;
 
+#define GPIO_EDGE_RECORD_SIZE	(5) // bytes per edge returned by fetchGpioEdges
+#define GPIO_SAMPLE_PERIOD_MS	(1) // period of sampleGpio
+
 typedef union {
   struct {
     uint8_t value : 1;	// value of the pin
@@ -57,6 +60,20 @@ void initGpio();
  */
 void configGpio(gpio_pin const pin, gpio_dir const dir, uint8_t const value, uint8_t const pullUpEnabled);
 
+/**
+ * @brief sets the debounce time of a gpio input pin, the pin is sampled by sampleGpio instead of
+ * triggering the pin change interrupt and a new value counts as edge once it has been stable.
+ * configGpio disables the debouncing.
+ * @param pin pin to debounce
+ * @param debounce_ms debounce time in ms, 0 = edges are latched by the pin change interrupt at once
+ */
+void debounceGpio(gpio_pin const pin, uint8_t const debounce_ms);
+
+/**
+ * @brief samples the debounced input pins, called every GPIO_SAMPLE_PERIOD_MS by the timer 0 ISR
+ */
+void sampleGpio();
+
 /**
  * @brief reads the status of a gpio input pin
  * @param pin pin to read 
@@ -66,6 +83,18 @@ void configGpio(gpio_pin const pin, gpio_dir const dir, uint8_t const value, uin
  */
 void readGpio(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall);
 
+/**
+ * @brief reads the status of a gpio input pin like readGpio together with the number of its edges, the
+ * pin change interrupts count every edge of an input pin until the counts are read
+ * @param pin pin to read
+ * @param value current value of the pin
+ * @param rise signals that a rising edge has occured
+ * @param fall signals that a falling edge has occured
+ * @param rises rising edges since the last readout of the counts, modulo 65536
+ * @param falls falling edges since the last readout of the counts, modulo 65536
+ */
+void readGpioCounts(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall, uint16_t *rises, uint16_t *falls);
+
 /**
  * @brief writes a value to a port 
  * @param pin pin for writing
@@ -73,6 +102,65 @@ void readGpio(gpio_pin const pin, uint8_t *value, uint8_t *rise, uint8_t *fall);
  */
 void writeGpio(gpio_pin const pin, uint8_t const value);
 
+/**
+ * @brief reads the status of all configured gpio input pins selected by a mask, bit per pin number,
+ * the edges of the pins are cleared like by readGpio
+ * @param mask pins to read
+ * @param inputs configured input pins which have been read
+ * @param value current values of the pins
+ * @param rise pins with a rising edge since their last readout
+ * @param fall pins with a falling edge since their last readout
+ */
+void readGpioPort(uint16_t const mask, uint16_t *inputs, uint16_t *value, uint16_t *rise, uint16_t *fall);
+
+/**
+ * @brief writes the values of all configured gpio output pins selected by a mask, bit per pin number
+ * @param mask pins to write
+ * @param value values to be written
+ * @return configured output pins which have been written
+ */
+uint16_t writeGpioPort(uint16_t const mask, uint16_t const value);
+
+/**
+ * @brief enables or disables the events of a gpio input pin, the pin change interrupts latch the
+ * edges of a subscribed pin until they are fetched by fetchGpioEvent
+ * @param pin pin to subscribe
+ * @param isSubscribed 1 = events are latched, 0 = events are discarded
+ */
+void subscribeGpio(gpio_pin const pin, uint8_t const isSubscribed);
+
+/**
+ * @brief returns the pins with a pending event, bit per pin number
+ */
+uint16_t getGpioEvents();
+
+/**
+ * @brief fetches the pending event of a subscribed pin, the edges of a pin are combined until its
+ * event is fetched
+ * @param pinNumber number of the pin e.g. 3 for D3
+ * @param flags value, rising and falling edge at bit 0, 1 and 2 like the reply to a gpio read
+ * @return 1 if an event has been fetched, 0 if no event is pending
+ */
+uint8_t fetchGpioEvent(uint8_t const pinNumber, uint8_t *flags);
+
+/**
+ * @brief enables or disables the recording of the edges of a gpio input pin, the pin change interrupts
+ * queue every edge of a recorded pin with its time until it is fetched by fetchGpioEdges
+ * @param pin pin to record
+ * @param isRecorded 1 = edges are queued, 0 = edges are not queued
+ */
+void recordGpioEdges(gpio_pin const pin, uint8_t const isRecorded);
+
+/**
+ * @brief fetches the oldest queued edges
+ * @param records buffer receiving GPIO_EDGE_RECORD_SIZE bytes per edge: pin number with bit 7 set for a
+ * rising edge, time in us with the low byte first
+ * @param maxEdges maximum number of edges to fetch
+ * @param lost number of edges dropped since the start of the board as the queue was full
+ * @return number of edges fetched
+ */
+uint8_t fetchGpioEdges(uint8_t *records, uint8_t const maxEdges, uint16_t *lost);
+
 /**
  * @brief converts a number to the corresponding gpio pin
  * @param pinNumber number of the pin e.g. 3 for D3
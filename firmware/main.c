@@ -54,6 +54,8 @@ int main() {
 			parse(data);
 		}
 
+		sendEvents();
+
 	}
 
 	return 0;
@@ -74,5 +76,7 @@ void initApplication() {
 
 	initUart();
 
+	initParser();
+
 	sei(); // enable globally interrupts
 }
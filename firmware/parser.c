@@ -27,8 +27,9 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <avr/wdt.h>
 #include "parser.h"
+#include <util/crc16.h>
+#include "uart.h"
 #include "gpio.h"
 #include "analog.h"
 #include "uart.h"
@@ -37,14 +38,24 @@
 #include "i2c.h"
 #include "servo.h"
 #include "counter.h"
+#include "reset.h"
 
 // prototype section
+void parse_tag(uint8_t const data);
+void parse_frame(uint8_t const data);
+void send_reply(uint8_t *reply, uint8_t const size);
+void send_frame(uint8_t const sequence, uint8_t *payload, uint8_t const length);
+void countUnacknowledged(uint8_t const isExecuted);
+void resetParser();
 void parse_misc(uint8_t const data);
 void parse_gpio(uint8_t const data);
 void parse_analog(uint8_t const data);
 void parse_i2c(uint8_t const data);
 void parse_servo(uint8_t const data);
 void parse_counter(uint8_t const data);
+void parse_batch(uint8_t const data);
+uint8_t batch_request_size(uint8_t const class_tag, uint8_t const data_tag);
+uint8_t batch_is_valid(uint8_t const *data, uint8_t const length);
 
 // states of the parser
 #define S_CLASS_TAG			(0)
@@ -54,6 +65,7 @@ void parse_counter(uint8_t const data);
 #define S_PARSE_I2C			(4)
 #define S_PARSE_SERVO		(5)
 #define S_PARSE_COUNTER		(6)
+#define S_PARSE_BATCH		(7)
 
 #define CT_MISC				(0x01)
 #define CT_GPIO 			(0x02)
@@ -61,14 +73,216 @@ void parse_counter(uint8_t const data);
 #define CT_I2C				(0x04)
 #define CT_SERVO			(0x05)
 #define CT_COUNTER			(0x06)
+#define CT_BATCH			(0x07)
 
 static volatile uint8_t parse_state = S_CLASS_TAG;
 
+// the replies of the sub requests of a batch are collected instead of being sent
+#define BATCH_MAX_REQUEST_SIZE	(56) // sub requests of one batch
+#define BATCH_MAX_REPLY_SIZE	(96) // sub replies of one batch
+
+static uint8_t batch_active = 0;
+static uint8_t batch_error = 0;
+static uint8_t batch_reply[BATCH_MAX_REPLY_SIZE + 4];
+static uint8_t batch_reply_size = 0;
+
+#define I2C_MAX_WRITE_SIZE	(8) // data bytes of one i2c write request
+
+// capability record returned by DT_MISC_CAPABILITIES, the pin bitmaps are indexed by the pin number
+#define CAP_RECORD_SIZE		(17)
+#define CAP_CLASSES			((1<<CT_MISC) | (1<<CT_GPIO) | (1<<CT_ANALOG) | (1<<CT_I2C) | (1<<CT_SERVO) | (1<<CT_COUNTER) | (1<<CT_BATCH))
+#define CAP_GPIO_PINS		(0x3FFC) // D2 - D13
+#define CAP_ANALOG_PINS		(0x3F) // A0 - A5
+#define CAP_SERVO_PINS		(0x06FC) // D2 - D7 software, D9 and D10 hardware generated
+#define CAP_COUNTER_PINS	(0x000C) // D2 and D3
+
+static uint8_t has_restarted = 1; // the board has started since the host asked the last time
+
+// protocol versions
+#define PROTOCOL_V1			(1) // [class tag, descriptor tag, arguments, additive checksum]
+#define PROTOCOL_V2			(2) // [start byte, length, sequence id, class tag, descriptor tag, arguments, crc-16]
+
+static uint8_t protocol_version = PROTOCOL_V1;
+
+// states of the v2 frame parser
+#define S_FRAME_START		(0)
+#define S_FRAME_LENGTH		(1)
+#define S_FRAME_SEQUENCE	(2)
+#define S_FRAME_PAYLOAD		(3)
+#define S_FRAME_CRC_LOW		(4)
+#define S_FRAME_CRC_HIGH	(5)
+
+#define FRAME_START			(0xA5)
+#define FRAME_MAX_PAYLOAD	(64)
+#define FRAME_EVENT_SEQUENCE	(0xFF) // sequence id of the unsolicited event frames, never used by a request
+
+static uint8_t frame_state = S_FRAME_START;
+static uint8_t frame_length = 0;
+static uint8_t frame_sequence = 0; // also the sequence id of the reply
+static uint8_t frame_count = 0;
+static uint8_t frame_payload[FRAME_MAX_PAYLOAD];
+static uint16_t frame_crc = 0;
+
+// cumulative error counters returned by DT_MISC_ERRORS, they wrap around and restart with the board
+static uint16_t frames_dropped = 0; // v2 frames with a wrong length or crc, or an incomplete payload
+static uint16_t noack_failed = 0; // unacknowledged requests with a wrong checksum or argument
+static uint16_t noack_executed = 0; // unacknowledged requests which have been executed
+
 /**
  * @brief parses the incoming uart data according to the agreed protocol
  * @param data uart data to be parsed
  */
 void parse(uint8_t const data) {
+	if(protocol_version == PROTOCOL_V2) {
+		parse_frame(data);
+	}
+	else {
+		parse_tag(data);
+	}
+}
+
+/**
+ * @brief parses the incoming v2 frames, the payload of a valid frame is passed to the v1 parser
+ * together with its additive checksum. Frames with a wrong crc are dropped, the host detects
+ * the gap in the sequence ids.
+ * @param data uart data to be parsed
+ */
+void parse_frame(uint8_t const data) {
+
+	switch(frame_state) {
+
+		case S_FRAME_START: {
+			if(data == FRAME_START) {
+				frame_crc = 0xFFFF;
+				frame_state = S_FRAME_LENGTH;
+			}
+		} break;
+
+		case S_FRAME_LENGTH: {
+			frame_crc = _crc_xmodem_update(frame_crc, data);
+			frame_length = data;
+			frame_count = 0;
+			if(frame_length >= 2 && frame_length <= FRAME_MAX_PAYLOAD) {
+				frame_state = S_FRAME_SEQUENCE;
+			}
+			else {
+				frames_dropped++;
+				frame_state = S_FRAME_START;
+			}
+		} break;
+
+		case S_FRAME_SEQUENCE: {
+			frame_crc = _crc_xmodem_update(frame_crc, data);
+			frame_sequence = data;
+			frame_state = S_FRAME_PAYLOAD;
+		} break;
+
+		case S_FRAME_PAYLOAD: {
+			frame_crc = _crc_xmodem_update(frame_crc, data);
+			frame_payload[frame_count] = data;
+			frame_count++;
+			if(frame_count == frame_length) {
+				frame_state = S_FRAME_CRC_LOW;
+			}
+		} break;
+
+		case S_FRAME_CRC_LOW: {
+			frame_crc ^= data;
+			frame_state = S_FRAME_CRC_HIGH;
+		} break;
+
+		case S_FRAME_CRC_HIGH: {
+			frame_crc ^= ((uint16_t)data) << 8;
+			frame_state = S_FRAME_START;
+			if(frame_crc == 0) {
+				uint8_t cs = 0;
+				for(uint8_t i=0; i<frame_length; i++) {
+					cs += frame_payload[i];
+					parse_tag(frame_payload[i]);
+				}
+				parse_tag(cs);
+				if(parse_state != S_CLASS_TAG) { // the payload has been too short
+					frames_dropped++;
+					resetParser();
+				}
+			}
+			else {
+				frames_dropped++;
+			}
+		} break;
+
+		default: {
+			frame_state = S_FRAME_START;
+		} break;
+	}
+}
+
+/**
+ * @brief sends a reply built by the v1 parsers, in v2 the additive checksum is replaced by the frame
+ * @param reply complete v1 reply including the additive checksum
+ * @param size number of bytes of the reply
+ */
+void send_reply(uint8_t *reply, uint8_t const size) {
+	if(batch_active) {
+		if(batch_reply_size + size > BATCH_MAX_REPLY_SIZE + 3) {
+			batch_error = 1;
+			return;
+		}
+		for(uint8_t i=0; i<size; i++) {
+			batch_reply[batch_reply_size] = reply[i];
+			batch_reply_size++;
+		}
+		return;
+	}
+
+	if(protocol_version != PROTOCOL_V2) {
+		sendByteArray(reply, size);
+		return;
+	}
+
+	send_frame(frame_sequence, reply, size - 1);
+}
+
+/**
+ * @brief counts an unacknowledged request, the host compares the counters with the requests it has sent
+ * @param isExecuted 1 if the request has been executed, 0 if it has been rejected
+ */
+void countUnacknowledged(uint8_t const isExecuted) {
+	if(isExecuted) {
+		noack_executed++;
+	}
+	else {
+		noack_failed++;
+	}
+}
+
+/**
+ * @brief sends a v2 frame
+ * @param sequence sequence id of the frame
+ * @param payload class tag, descriptor tag and data
+ * @param length number of bytes of the payload
+ */
+void send_frame(uint8_t const sequence, uint8_t *payload, uint8_t const length) {
+	uint16_t crc = 0xFFFF;
+	crc = _crc_xmodem_update(crc, length);
+	crc = _crc_xmodem_update(crc, sequence);
+	for(uint8_t i=0; i<length; i++) {
+		crc = _crc_xmodem_update(crc, payload[i]);
+	}
+
+	sendByte(FRAME_START);
+	sendByte(length);
+	sendByte(sequence);
+	sendByteArray(payload, length);
+	sendByte((uint8_t)(crc & 0xFF));
+	sendByte((uint8_t)((crc >> 8) & 0xFF));
+}
+
+/**
+ * @brief parses the v1 requests, i.e. the class and descriptor tags
+ * @param data uart data to be parsed
+ */
+void parse_tag(uint8_t const data) {
 	
 	switch(parse_state) {
 
@@ -90,7 +304,13 @@ void parse(uint8_t const data) {
 			}
 			else if(data == CT_COUNTER) {
 				parse_state = S_PARSE_COUNTER;
-			}		
+			}
+			else if(data == CT_BATCH && !batch_active) {
+				parse_state = S_PARSE_BATCH;
+			}
+			else if(batch_active) {
+				batch_error = 1; // the sub requests are not aligned
+			}
 		} break;
 
 		case S_PARSE_MISC: {
@@ -117,6 +337,10 @@ void parse(uint8_t const data) {
 			parse_counter(data);
 		} break;
 
+		case S_PARSE_BATCH: {
+			parse_batch(data);
+		} break;
+
 		default: {
 		} break;
 	}
@@ -127,10 +351,24 @@ void parse(uint8_t const data) {
 #define S_MISC_RESET		(1)
 #define S_MISC_ID			(2)
 #define S_MISC_TEMP			(3)
+#define S_MISC_BAUD_1		(4)
+#define S_MISC_BAUD_2		(5)
+#define S_MISC_BAUD_CONFIRM	(6)
+#define S_MISC_RESTARTED	(7)
+#define S_MISC_PROTOCOL_1	(8)
+#define S_MISC_PROTOCOL_2	(9)
+#define S_MISC_CAPABILITIES	(10)
+#define S_MISC_ERRORS		(11)
 
 #define DT_MISC_RESET		(0x01)
 #define DT_MISC_ID			(0x02)
 #define DT_MISC_TEMP		(0x03)
+#define DT_MISC_BAUD		(0x04)
+#define DT_MISC_BAUD_CONFIRM	(0x05)
+#define DT_MISC_RESTARTED	(0x06)
+#define DT_MISC_PROTOCOL	(0x07)
+#define DT_MISC_CAPABILITIES	(0x08)
+#define DT_MISC_ERRORS		(0x09)
 
 static volatile uint8_t misc_parse_state = S_MISC_DT;
 
@@ -142,6 +380,8 @@ static volatile uint8_t misc_parse_state = S_MISC_DT;
 #define MISC_ID_NOK			(MISC_NOK)
 #define MISC_TEMP_OK		(MISC_OK)
 #define MISC_TEMP_NOK		(MISC_NOK)
+#define MISC_BAUD_OK		(MISC_OK)
+#define MISC_BAUD_NOK		(MISC_NOK)
 
 #include <util/delay.h>
 
@@ -151,6 +391,9 @@ static volatile uint8_t misc_parse_state = S_MISC_DT;
  */
 void parse_misc(uint8_t const data) {
 
+	static uint8_t baudRate = 0;
+	static uint8_t version = 0;
+
 	switch(misc_parse_state) {
 
 		case S_MISC_DT: {
@@ -163,6 +406,24 @@ void parse_misc(uint8_t const data) {
 			else if(data == DT_MISC_TEMP) {
 				misc_parse_state = S_MISC_TEMP;
 			}
+			else if(data == DT_MISC_BAUD) {
+				misc_parse_state = S_MISC_BAUD_1;
+			}
+			else if(data == DT_MISC_BAUD_CONFIRM) {
+				misc_parse_state = S_MISC_BAUD_CONFIRM;
+			}
+			else if(data == DT_MISC_RESTARTED) {
+				misc_parse_state = S_MISC_RESTARTED;
+			}
+			else if(data == DT_MISC_PROTOCOL) {
+				misc_parse_state = S_MISC_PROTOCOL_1;
+			}
+			else if(data == DT_MISC_CAPABILITIES) {
+				misc_parse_state = S_MISC_CAPABILITIES;
+			}
+			else if(data == DT_MISC_ERRORS) {
+				misc_parse_state = S_MISC_ERRORS;
+			}
 
 		} break;
 
@@ -177,11 +438,11 @@ void parse_misc(uint8_t const data) {
 				reply[2] = MISC_RESET_NOK;
 			}
 			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			send_reply(reply, 4);
 			misc_parse_state = S_MISC_DT;
 			parse_state = S_CLASS_TAG;
-			if(cs == data) { // trigger reset after 1 s (watchdog)
-   				while(1) { }
+			if(cs == data) { // trigger reset after 0.5 s (watchdog)
+				triggerReset();
 			}
 		} break;
 
@@ -200,7 +461,7 @@ void parse_misc(uint8_t const data) {
 			}
 			reply[5] = reply[0] + reply[1] + reply[2] + reply[3] + reply[4];
 			//_delay_ms(1);
-			sendByteArray(reply, 6);
+			send_reply(reply, 6);
 			misc_parse_state = S_MISC_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -219,7 +480,157 @@ void parse_misc(uint8_t const data) {
 				reply[2] = MISC_TEMP_NOK;
 			}
 			reply[5] = reply[0] + reply[1] + reply[2] + reply[3] + reply[4];
-			sendByteArray(reply, 6);
+			send_reply(reply, 6);
+			misc_parse_state = S_MISC_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// MISC BAUD
+		case S_MISC_BAUD_1: {
+			baudRate = data;
+			misc_parse_state = S_MISC_BAUD_2;
+		} break;
+
+		case S_MISC_BAUD_2: {
+			uint8_t cs = CT_MISC + DT_MISC_BAUD + baudRate;
+			uint8_t reply[4] = {CT_MISC, DT_MISC_BAUD, 0, 0};
+			uint8_t const isOk = (cs == data) && (baudRate <= UART_BAUD_1000000);
+			if(isOk) {
+				reply[2] = MISC_BAUD_OK;
+			}
+			else {
+				reply[2] = MISC_BAUD_NOK;
+			}
+			reply[3] = reply[0] + reply[1] + reply[2];
+			send_reply(reply, 4);
+			misc_parse_state = S_MISC_DT;
+			parse_state = S_CLASS_TAG;
+			if(isOk) { // the host confirms the new rate with DT_MISC_BAUD_CONFIRM within 0.5 s
+				switchUartBaudRate(baudRate);
+			}
+		} break;
+
+		// MISC BAUD CONFIRM
+		case S_MISC_BAUD_CONFIRM: {
+			uint8_t cs = CT_MISC + DT_MISC_BAUD_CONFIRM;
+			uint8_t reply[4] = {CT_MISC, DT_MISC_BAUD_CONFIRM, 0, 0};
+			if(cs == data) {
+				confirmUartBaudRate();
+				reply[2] = MISC_BAUD_OK;
+			}
+			else {
+				reply[2] = MISC_BAUD_NOK;
+			}
+			reply[3] = reply[0] + reply[1] + reply[2];
+			send_reply(reply, 4);
+			misc_parse_state = S_MISC_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// MISC RESTARTED
+		case S_MISC_RESTARTED: {
+			uint8_t cs = CT_MISC + DT_MISC_RESTARTED;
+			uint8_t reply[5] = {CT_MISC, DT_MISC_RESTARTED, 0, 0, 0};
+			if(cs == data) {
+				reply[2] = MISC_OK;
+				reply[3] = has_restarted;
+				has_restarted = 0;
+			}
+			else {
+				reply[2] = MISC_NOK;
+			}
+			reply[4] = reply[0] + reply[1] + reply[2] + reply[3];
+			send_reply(reply, 5);
+			misc_parse_state = S_MISC_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// MISC PROTOCOL
+		case S_MISC_PROTOCOL_1: {
+			version = data;
+			misc_parse_state = S_MISC_PROTOCOL_2;
+		} break;
+
+		case S_MISC_PROTOCOL_2: {
+			uint8_t cs = CT_MISC + DT_MISC_PROTOCOL + version;
+			uint8_t reply[5] = {CT_MISC, DT_MISC_PROTOCOL, 0, 0, 0};
+			uint8_t const isOk = (cs == data) && (version >= PROTOCOL_V1);
+			if(isOk) {
+				if(version > PROTOCOL_V2) {
+					version = PROTOCOL_V2; // the host falls back to the highest version supported
+				}
+				reply[2] = MISC_OK;
+				reply[3] = version;
+			}
+			else {
+				reply[2] = MISC_NOK;
+			}
+			reply[4] = reply[0] + reply[1] + reply[2] + reply[3];
+			send_reply(reply, 5); // still with the previous version
+			misc_parse_state = S_MISC_DT;
+			parse_state = S_CLASS_TAG;
+			if(isOk) {
+				protocol_version = version;
+				frame_state = S_FRAME_START;
+			}
+		} break;
+
+		// MISC CAPABILITIES
+		case S_MISC_CAPABILITIES: {
+			uint8_t cs = CT_MISC + DT_MISC_CAPABILITIES;
+			uint8_t reply[CAP_RECORD_SIZE + 4] = {CT_MISC, DT_MISC_CAPABILITIES, 0};
+			if(cs == data) {
+				reply[2] = MISC_OK;
+				reply[3] = PROTOCOL_V2;
+				reply[4] = (uint8_t)(UART_BUF_SIZE & 0xFF);
+				reply[5] = (uint8_t)((UART_BUF_SIZE >> 8) & 0xFF);
+				reply[6] = (uint8_t)(UART_BUF_SIZE & 0xFF); // transmit buffer
+				reply[7] = (uint8_t)((UART_BUF_SIZE >> 8) & 0xFF);
+				reply[8] = FRAME_MAX_PAYLOAD;
+				reply[9] = BATCH_MAX_REQUEST_SIZE;
+				reply[10] = BATCH_MAX_REPLY_SIZE;
+				reply[11] = I2C_MAX_WRITE_SIZE;
+				reply[12] = CAP_CLASSES;
+				reply[13] = (uint8_t)(CAP_GPIO_PINS & 0xFF);
+				reply[14] = (uint8_t)((CAP_GPIO_PINS >> 8) & 0xFF);
+				reply[15] = CAP_ANALOG_PINS;
+				reply[16] = (uint8_t)(CAP_SERVO_PINS & 0xFF);
+				reply[17] = (uint8_t)((CAP_SERVO_PINS >> 8) & 0xFF);
+				reply[18] = (uint8_t)(CAP_COUNTER_PINS & 0xFF);
+				reply[19] = (uint8_t)((CAP_COUNTER_PINS >> 8) & 0xFF);
+			}
+			else {
+				reply[2] = MISC_NOK;
+			}
+			reply[CAP_RECORD_SIZE + 3] = 0;
+			for(uint8_t i=0; i<CAP_RECORD_SIZE + 3; i++) {
+				reply[CAP_RECORD_SIZE + 3] += reply[i];
+			}
+			send_reply(reply, CAP_RECORD_SIZE + 4);
+			misc_parse_state = S_MISC_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// MISC ERRORS
+		case S_MISC_ERRORS: {
+			uint8_t cs = CT_MISC + DT_MISC_ERRORS;
+			uint8_t reply[10] = {CT_MISC, DT_MISC_ERRORS, 0, 0, 0, 0, 0, 0, 0, 0};
+			if(cs == data) {
+				reply[2] = MISC_OK;
+				reply[3] = (uint8_t)(frames_dropped & 0xFF);
+				reply[4] = (uint8_t)((frames_dropped >> 8) & 0xFF);
+				reply[5] = (uint8_t)(noack_failed & 0xFF);
+				reply[6] = (uint8_t)((noack_failed >> 8) & 0xFF);
+				reply[7] = (uint8_t)(noack_executed & 0xFF);
+				reply[8] = (uint8_t)((noack_executed >> 8) & 0xFF);
+			}
+			else {
+				reply[2] = MISC_NOK;
+			}
+			for(uint8_t i=0; i<9; i++) {
+				reply[9] += reply[i];
+			}
+			send_reply(reply, 10);
 			misc_parse_state = S_MISC_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -239,16 +650,41 @@ void parse_misc(uint8_t const data) {
 #define S_GPIO_WRITE_1		(6)
 #define S_GPIO_WRITE_2		(7)
 #define S_GPIO_WRITE_3		(8)
-
-#define DT_GPIO_CONFIG 		(0x01)
+#define S_GPIO_SUBSCRIBE_1	(9)
+#define S_GPIO_SUBSCRIBE_2	(10)
+#define S_GPIO_SUBSCRIBE_3	(11)
+#define S_GPIO_READ_PORT_1	(12)
+#define S_GPIO_READ_PORT_2	(13)
+#define S_GPIO_READ_PORT_3	(14)
+#define S_GPIO_WRITE_PORT_1	(15)
+#define S_GPIO_WRITE_PORT_2	(16)
+#define S_GPIO_WRITE_PORT_3	(17)
+#define S_GPIO_WRITE_PORT_4	(18)
+#define S_GPIO_WRITE_PORT_5	(19)
+#define S_GPIO_READ_EDGES	(20)
+#define S_GPIO_CONFIG_DEBOUNCE	(21)
+
+#define DT_GPIO_CONFIG 		(0x01) // [pin, options, debounce time in ms if GPIO_CONFIG_OPTIONS_DEBOUNCE]
 #define DT_GPIO_READ 		(0x02)
 #define DT_GPIO_WRITE 		(0x03)
+#define DT_GPIO_SUBSCRIBE	(0x04) // [pin, events | edge recording << 1]
+#define DT_GPIO_EVENT		(0x05) // unsolicited, [CT_GPIO, DT_GPIO_EVENT, pin number, value | rise << 1 | fall << 2]
+#define DT_GPIO_WRITE_NOACK	(0x06) // like DT_GPIO_WRITE without a reply, counted by DT_MISC_ERRORS
+#define DT_GPIO_READ_PORT	(0x07) // [mask lo, mask hi], reply [inputs, values, rises, falls], 16 bit each
+#define DT_GPIO_WRITE_PORT	(0x08) // [mask lo, mask hi, values lo, values hi], reply [outputs lo, outputs hi]
+#define DT_GPIO_READ_EDGES	(0x09) // reply [lost lo, lost hi, count, GPIO_EDGE_RECORDS records of the recorded edges]
+#define DT_GPIO_READ_COUNTS	(0x0A) // [pin], reply [value | rise << 1 | fall << 2, rises lo, rises hi, falls lo, falls hi]
+
+#define GPIO_SUBSCRIBE_EVENTS		(0x01)
+#define GPIO_SUBSCRIBE_EDGES		(0x02)
+#define GPIO_EDGE_RECORDS			(8) // records of every DT_GPIO_READ_EDGES reply, unused ones are zero
 
 static volatile uint8_t gpio_parse_state = S_GPIO_DT;
 
 #define GPIO_CONFIG_OPTIONS_DIR		(0x01)
 #define GPIO_CONFIG_OPTIONS_VALUE   (0x02)
 #define GPIO_CONFIG_OPTIONS_PULLUP	(0x04)
+#define GPIO_CONFIG_OPTIONS_DEBOUNCE	(0x08) // the debounce time of an input in ms follows the options
 
 #define GPIO_NOK					(0)
 #define GPIO_OK						(1)
@@ -258,6 +694,8 @@ static volatile uint8_t gpio_parse_state = S_GPIO_DT;
 #define GPIO_READ_OK				(GPIO_OK)
 #define GPIO_WRITE_NOK				(GPIO_NOK)
 #define GPIO_WRITE_OK				(GPIO_OK)
+#define GPIO_SUBSCRIBE_NOK			(GPIO_NOK)
+#define GPIO_SUBSCRIBE_OK			(GPIO_OK)
 
 /**
  * @brief parses the incoming uart data for gpio actions
@@ -267,7 +705,11 @@ void parse_gpio(uint8_t const data) {
 
 	static uint8_t pinNumber = 0;
 	static uint8_t configOptions = 0;
+	static uint8_t debounceTime = 0;
 	static uint8_t pinValue = 0;
+	static uint8_t readTag = DT_GPIO_READ;
+	static uint8_t writeTag = DT_GPIO_WRITE;
+	static uint8_t portArgs[4]; // mask and values of the port requests, low byte first
 	
 	switch(gpio_parse_state) {
 	
@@ -275,12 +717,26 @@ void parse_gpio(uint8_t const data) {
 			if(data == DT_GPIO_CONFIG) {
 				gpio_parse_state = S_GPIO_CONFIG_1;
 			}
-			else if(data == DT_GPIO_READ) {
+			else if(data == DT_GPIO_READ || data == DT_GPIO_READ_COUNTS) {
+				readTag = data;
 				gpio_parse_state = S_GPIO_READ_1;
 			}
-			else if(data == DT_GPIO_WRITE) {
+			else if(data == DT_GPIO_WRITE || data == DT_GPIO_WRITE_NOACK) {
+				writeTag = data;
 				gpio_parse_state = S_GPIO_WRITE_1;
 			}
+			else if(data == DT_GPIO_SUBSCRIBE) {
+				gpio_parse_state = S_GPIO_SUBSCRIBE_1;
+			}
+			else if(data == DT_GPIO_READ_PORT) {
+				gpio_parse_state = S_GPIO_READ_PORT_1;
+			}
+			else if(data == DT_GPIO_WRITE_PORT) {
+				gpio_parse_state = S_GPIO_WRITE_PORT_1;
+			}
+			else if(data == DT_GPIO_READ_EDGES) {
+				gpio_parse_state = S_GPIO_READ_EDGES;
+			}
 		} break;
 
 		// GPIO CONFIG
@@ -291,11 +747,18 @@ void parse_gpio(uint8_t const data) {
 
 		case S_GPIO_CONFIG_2: {
 			configOptions = data;
+			debounceTime = 0;
+			if(configOptions & GPIO_CONFIG_OPTIONS_DEBOUNCE) gpio_parse_state = S_GPIO_CONFIG_DEBOUNCE;
+			else gpio_parse_state = S_GPIO_CONFIG_3;
+		} break;
+
+		case S_GPIO_CONFIG_DEBOUNCE: {
+			debounceTime = data;
 			gpio_parse_state = S_GPIO_CONFIG_3;
 		} break;
 
 		case S_GPIO_CONFIG_3: {
-			uint8_t cs = CT_GPIO + DT_GPIO_CONFIG + pinNumber + configOptions;
+			uint8_t cs = CT_GPIO + DT_GPIO_CONFIG + pinNumber + configOptions + debounceTime;
 			uint8_t reply[4] = {CT_GPIO, DT_GPIO_CONFIG, 0, 0};
 			if(cs == data && (pinNumber >= 2 && pinNumber <= 13)) { // check if the checksum is correct
 				// perform config operation and send answer
@@ -305,13 +768,14 @@ void parse_gpio(uint8_t const data) {
 				uint8_t const val = ((configOptions & GPIO_CONFIG_OPTIONS_VALUE) >> 1);
 				uint8_t const pullUpEnabled = ((configOptions & GPIO_CONFIG_OPTIONS_PULLUP) >> 2);
 				configGpio(convertNumberToGpio(pinNumber), dir, val, pullUpEnabled);
+				if(dir == Input && debounceTime > 0) debounceGpio(convertNumberToGpio(pinNumber), debounceTime);
 				reply[2] = GPIO_CONFIG_OK;
 			}
 			else {
 				reply[2] = GPIO_CONFIG_NOK;
 			}
 			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			send_reply(reply, 4);
 			gpio_parse_state = S_GPIO_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -323,19 +787,32 @@ void parse_gpio(uint8_t const data) {
 		} break;
 
 		case S_GPIO_READ_2: {
-			uint8_t cs = CT_GPIO + DT_GPIO_READ + pinNumber;
-			uint8_t reply[5] = {CT_GPIO, DT_GPIO_READ, 0, 0, 0};
+			uint8_t cs = CT_GPIO + readTag + pinNumber;
+			uint8_t reply[9] = {CT_GPIO, readTag, 0, 0, 0, 0, 0, 0, 0};
+			uint8_t const size = (readTag == DT_GPIO_READ_COUNTS) ? 9 : 5;
 			if(cs == data  && (pinNumber >= 2 && pinNumber <= 13)) {
 				uint8_t val=0, rise=0, fall=0;
-				readGpio(convertNumberToGpio(pinNumber), &val, &rise, &fall);
+				if(readTag == DT_GPIO_READ_COUNTS) {
+					uint16_t rises = 0, falls = 0;
+					readGpioCounts(convertNumberToGpio(pinNumber), &val, &rise, &fall, &rises, &falls);
+					reply[4] = (uint8_t)(rises & 0xFF);
+					reply[5] = (uint8_t)((rises >> 8) & 0xFF);
+					reply[6] = (uint8_t)(falls & 0xFF);
+					reply[7] = (uint8_t)((falls >> 8) & 0xFF);
+				}
+				else {
+					readGpio(convertNumberToGpio(pinNumber), &val, &rise, &fall);
+				}
 				reply[2] = GPIO_READ_OK;
 				reply[3] = (val) | (rise<<1) | (fall<<2);
 			}
 			else {
 				reply[2] = GPIO_READ_NOK;
 			}
-			reply[4] = reply[0] + reply[1] + reply[2] + reply[3];
-			sendByteArray(reply, 5);
+			for(uint8_t i=0; i<size - 1; i++) {
+				reply[size - 1] += reply[i];
+			}
+			send_reply(reply, size);
 			gpio_parse_state = S_GPIO_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -352,7 +829,7 @@ void parse_gpio(uint8_t const data) {
 		} break;
 
 		case S_GPIO_WRITE_3: {
-			uint8_t cs = CT_GPIO + DT_GPIO_WRITE + pinNumber + pinValue;
+			uint8_t cs = CT_GPIO + writeTag + pinNumber + pinValue;
 			uint8_t reply[4] = {CT_GPIO, DT_GPIO_WRITE, 0, 0};
 			if(cs == data  && (pinNumber >= 2 && pinNumber <= 13)) {
 				writeGpio(convertNumberToGpio(pinNumber), pinValue);
@@ -361,8 +838,133 @@ void parse_gpio(uint8_t const data) {
 			else {
 				reply[2] = GPIO_WRITE_NOK;
 			}
+			if(writeTag == DT_GPIO_WRITE_NOACK) {
+				countUnacknowledged(reply[2] == GPIO_WRITE_OK);
+			}
+			else {
+				reply[3] = reply[0] + reply[1] + reply[2];
+				send_reply(reply, 4);
+			}
+			gpio_parse_state = S_GPIO_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// GPIO SUBSCRIBE
+		case S_GPIO_SUBSCRIBE_1: {
+			pinNumber = data;
+			gpio_parse_state = S_GPIO_SUBSCRIBE_2;
+		} break;
+
+		case S_GPIO_SUBSCRIBE_2: {
+			pinValue = data; // GPIO_SUBSCRIBE_EVENTS and GPIO_SUBSCRIBE_EDGES, 0 = unsubscribe
+			gpio_parse_state = S_GPIO_SUBSCRIBE_3;
+		} break;
+
+		case S_GPIO_SUBSCRIBE_3: {
+			uint8_t cs = CT_GPIO + DT_GPIO_SUBSCRIBE + pinNumber + pinValue;
+			uint8_t reply[4] = {CT_GPIO, DT_GPIO_SUBSCRIBE, 0, 0};
+			// the events would break the v1 replies, only the v2 frames can be told apart
+			if(cs == data && (pinNumber >= 2 && pinNumber <= 13)
+					&& (pinValue <= (GPIO_SUBSCRIBE_EVENTS | GPIO_SUBSCRIBE_EDGES))
+					&& (protocol_version == PROTOCOL_V2 || (pinValue & GPIO_SUBSCRIBE_EVENTS) == 0)) {
+				subscribeGpio(convertNumberToGpio(pinNumber), (pinValue & GPIO_SUBSCRIBE_EVENTS) ? 1 : 0);
+				recordGpioEdges(convertNumberToGpio(pinNumber), (pinValue & GPIO_SUBSCRIBE_EDGES) ? 1 : 0);
+				reply[2] = GPIO_SUBSCRIBE_OK;
+			}
+			else {
+				reply[2] = GPIO_SUBSCRIBE_NOK;
+			}
 			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			send_reply(reply, 4);
+			gpio_parse_state = S_GPIO_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// GPIO READ PORT
+		case S_GPIO_READ_PORT_1: {
+			portArgs[0] = data;
+			gpio_parse_state = S_GPIO_READ_PORT_2;
+		} break;
+
+		case S_GPIO_READ_PORT_2: {
+			portArgs[1] = data;
+			gpio_parse_state = S_GPIO_READ_PORT_3;
+		} break;
+
+		case S_GPIO_READ_PORT_3: {
+			uint8_t cs = CT_GPIO + DT_GPIO_READ_PORT + portArgs[0] + portArgs[1];
+			uint8_t reply[12] = {CT_GPIO, DT_GPIO_READ_PORT, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+			if(cs == data) {
+				uint16_t inputs = 0, value = 0, rise = 0, fall = 0;
+				readGpioPort((((uint16_t)portArgs[1]) << 8) | portArgs[0], &inputs, &value, &rise, &fall);
+				reply[2] = GPIO_READ_OK;
+				reply[3] = (uint8_t)(inputs & 0xFF);
+				reply[4] = (uint8_t)((inputs >> 8) & 0xFF);
+				reply[5] = (uint8_t)(value & 0xFF);
+				reply[6] = (uint8_t)((value >> 8) & 0xFF);
+				reply[7] = (uint8_t)(rise & 0xFF);
+				reply[8] = (uint8_t)((rise >> 8) & 0xFF);
+				reply[9] = (uint8_t)(fall & 0xFF);
+				reply[10] = (uint8_t)((fall >> 8) & 0xFF);
+			}
+			else {
+				reply[2] = GPIO_READ_NOK;
+			}
+			for(uint8_t i=0; i<11; i++) {
+				reply[11] += reply[i];
+			}
+			send_reply(reply, 12);
+			gpio_parse_state = S_GPIO_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// GPIO READ EDGES
+		case S_GPIO_READ_EDGES: {
+			uint8_t cs = CT_GPIO + DT_GPIO_READ_EDGES;
+			uint8_t reply[GPIO_EDGE_RECORDS * GPIO_EDGE_RECORD_SIZE + 7] = {CT_GPIO, DT_GPIO_READ_EDGES, 0};
+			if(cs == data) {
+				uint16_t lost = 0;
+				reply[5] = fetchGpioEdges(reply + 6, GPIO_EDGE_RECORDS, &lost);
+				reply[2] = GPIO_READ_OK;
+				reply[3] = (uint8_t)(lost & 0xFF);
+				reply[4] = (uint8_t)((lost >> 8) & 0xFF);
+			}
+			else {
+				reply[2] = GPIO_READ_NOK;
+			}
+			uint8_t const size = GPIO_EDGE_RECORDS * GPIO_EDGE_RECORD_SIZE + 7;
+			for(uint8_t i=0; i<size - 1; i++) {
+				reply[size - 1] += reply[i];
+			}
+			send_reply(reply, size);
+			gpio_parse_state = S_GPIO_DT;
+			parse_state = S_CLASS_TAG;
+		} break;
+
+		// GPIO WRITE PORT
+		case S_GPIO_WRITE_PORT_1:
+		case S_GPIO_WRITE_PORT_2:
+		case S_GPIO_WRITE_PORT_3:
+		case S_GPIO_WRITE_PORT_4: {
+			portArgs[gpio_parse_state - S_GPIO_WRITE_PORT_1] = data;
+			gpio_parse_state++;
+		} break;
+
+		case S_GPIO_WRITE_PORT_5: {
+			uint8_t cs = CT_GPIO + DT_GPIO_WRITE_PORT + portArgs[0] + portArgs[1] + portArgs[2] + portArgs[3];
+			uint8_t reply[6] = {CT_GPIO, DT_GPIO_WRITE_PORT, 0, 0, 0, 0};
+			if(cs == data) {
+				uint16_t const outputs = writeGpioPort((((uint16_t)portArgs[1]) << 8) | portArgs[0],
+						(((uint16_t)portArgs[3]) << 8) | portArgs[2]);
+				reply[2] = GPIO_WRITE_OK;
+				reply[3] = (uint8_t)(outputs & 0xFF);
+				reply[4] = (uint8_t)((outputs >> 8) & 0xFF);
+			}
+			else {
+				reply[2] = GPIO_WRITE_NOK;
+			}
+			reply[5] = reply[0] + reply[1] + reply[2] + reply[3] + reply[4];
+			send_reply(reply, 6);
 			gpio_parse_state = S_GPIO_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -372,6 +974,35 @@ void parse_gpio(uint8_t const data) {
 	}
 }
 
+/**
+ * @brief sends the pending event of one subscribed gpio pin in a frame with the sequence id
+ * FRAME_EVENT_SEQUENCE, the pins take turns. The frame is sent between two requests and only while the
+ * uart has transmitted all replies, so it never splits a reply. At most one event frame shares the tx
+ * buffer with the replies of the requests in flight, the host keeps room for it in its budget.
+ * @return 1 if an event has been sent, 0 otherwise
+ */
+uint8_t sendEvents() {
+	static uint8_t lastPinNumber = 13;
+
+	if(protocol_version != PROTOCOL_V2 || !uartTxBufferEmpty()) return 0;
+
+	uint16_t const pending = getGpioEvents();
+	if(pending == 0) return 0;
+
+	uint8_t pinNumber = lastPinNumber;
+	for(uint8_t i = 2; i <= 13; i++) {
+		pinNumber = (pinNumber == 13) ? 2 : pinNumber + 1;
+		uint8_t flags = 0;
+		if((pending & (((uint16_t)1) << pinNumber)) && fetchGpioEvent(pinNumber, &flags)) {
+			uint8_t event[4] = {CT_GPIO, DT_GPIO_EVENT, pinNumber, flags};
+			send_frame(FRAME_EVENT_SEQUENCE, event, 4);
+			lastPinNumber = pinNumber;
+			return 1;
+		}
+	}
+	return 0;
+}
+
 // states of the analog parser
 #define S_ANALOG_DT			(0)
 #define S_ANALOG_READ_1		(1)
@@ -427,7 +1058,7 @@ void parse_analog(uint8_t const data) {
 				reply[2] = ANALOG_READ_NOK;
 			}
 			reply[5] = reply[0] + reply[1] + reply[2] + reply[3] + reply[4];
-			sendByteArray(reply, 6);
+			send_reply(reply, 6);
 			analog_parse_state = S_ANALOG_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -458,7 +1089,7 @@ void parse_analog(uint8_t const data) {
 					reply[15] += reply[i];
 				}
 			}
-			sendByteArray(reply, 16);
+			send_reply(reply, 16);
 			analog_parse_state = S_ANALOG_DT;
 			parse_state = S_CLASS_TAG;			
 		} break;
@@ -507,7 +1138,7 @@ void parse_i2c(uint8_t const data) {
 	static uint8_t adr = 0;
 	static uint8_t offset = 0;
 	static uint8_t length = 0;
-	static uint8_t data_arr[8];
+	static uint8_t data_arr[I2C_MAX_WRITE_SIZE];
 	static uint8_t data_cnt = 0;
 
 	switch(i2c_parse_state) {
@@ -542,7 +1173,7 @@ void parse_i2c(uint8_t const data) {
 				reply[2] = I2C_CONFIG_NOK;
 			}
 			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			send_reply(reply, 4);
 			i2c_parse_state = S_I2C_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -581,7 +1212,7 @@ void parse_i2c(uint8_t const data) {
 			for(uint8_t i=0; i<length+3; i++) {
 				reply[length+3] += reply[i];
 			}
-			sendByteArray(reply, length+4);
+			send_reply(reply, length+4);
 			i2c_parse_state = S_I2C_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -604,7 +1235,9 @@ void parse_i2c(uint8_t const data) {
 		} break;
 
 		case S_I2C_WRITE_4: {
-			data_arr[data_cnt] = data;
+			if(data_cnt < I2C_MAX_WRITE_SIZE) {
+				data_arr[data_cnt] = data;
+			}
 			data_cnt++;
 			if(data_cnt == length) i2c_parse_state = S_I2C_WRITE_5;
 		} break;
@@ -612,10 +1245,10 @@ void parse_i2c(uint8_t const data) {
 		case S_I2C_WRITE_5: {
 			uint8_t cs = CT_I2C + DT_I2C_WRITE + adr + offset + length;
 			uint8_t reply[4] = {CT_I2C, DT_I2C_WRITE, 0, 0};
-			for(uint8_t i=0; i<length; i++) {
+			for(uint8_t i=0; i<length && i<I2C_MAX_WRITE_SIZE; i++) {
 				cs += data_arr[i];
 			}
-			if(cs == data) {
+			if(cs == data && length <= I2C_MAX_WRITE_SIZE) {
 				if(i2c_write(adr, offset, data_arr, length)) reply[2] = I2C_WRITE_OK;
 				else reply[2] = I2C_WRITE_NOK;
 				//reply[2] = i2c_write(adr, offset, data_arr, length);
@@ -624,7 +1257,7 @@ void parse_i2c(uint8_t const data) {
 				reply[2] = I2C_WRITE_NOK;
 			}
 			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			send_reply(reply, 4);
 			i2c_parse_state = S_I2C_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -650,6 +1283,7 @@ static volatile uint8_t servo_parse_state = S_SERVO_DT;
 
 #define DT_SERVO_CONFIG		(0x01)
 #define DT_SERVO_SET 		(0x02)
+#define DT_SERVO_SET_NOACK	(0x03) // like DT_SERVO_SET without a reply, counted by DT_MISC_ERRORS
 
 #define SERVO_OK			(1)
 #define SERVO_NOK			(0)
@@ -666,6 +1300,7 @@ void parse_servo(uint8_t const data) {
 	static uint8_t servoPin = 0;
 	static uint8_t pwmLowByte = 0;
 	static uint8_t pwmHighByte = 0;
+	static uint8_t setTag = DT_SERVO_SET;
 
 	switch(servo_parse_state) {
 
@@ -673,7 +1308,8 @@ void parse_servo(uint8_t const data) {
 			if(data == DT_SERVO_CONFIG) {
 				servo_parse_state = S_SERVO_CONFIG_1;
 			}
-			else if(data == DT_SERVO_SET) {
+			else if(data == DT_SERVO_SET || data == DT_SERVO_SET_NOACK) {
+				setTag = data;
 				servo_parse_state = S_SERVO_SET_1;
 			}
 		} break;
@@ -729,7 +1365,7 @@ void parse_servo(uint8_t const data) {
 				reply[2] = SERVO_CONFIG_NOK;
 			}
 			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			send_reply(reply, 4);
 			servo_parse_state = S_SERVO_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -751,7 +1387,7 @@ void parse_servo(uint8_t const data) {
 		} break;
 
 		case S_SERVO_SET_4: {
-			uint8_t cs = CT_SERVO + DT_SERVO_SET + servoPin + pwmLowByte + pwmHighByte;
+			uint8_t cs = CT_SERVO + setTag + servoPin + pwmLowByte + pwmHighByte;
 			uint8_t reply[4] = {CT_SERVO, DT_SERVO_SET, 0, 0};
 			if(cs == data && (servoPin == 9 || servoPin == 10 || servoPin == 2  || servoPin == 3 || servoPin == 4 || servoPin == 5 || servoPin == 6 || servoPin == 7)) {
 				uint16_t pwm = (((uint16_t)(pwmHighByte)) << 8) + ((uint16_t)(pwmLowByte));
@@ -784,8 +1420,13 @@ void parse_servo(uint8_t const data) {
 			else {
 				reply[2] = SERVO_SET_NOK;
 			}
-			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			if(setTag == DT_SERVO_SET_NOACK) {
+				countUnacknowledged(reply[2] == SERVO_SET_OK);
+			}
+			else {
+				reply[3] = reply[0] + reply[1] + reply[2];
+				send_reply(reply, 4);
+			}
 			servo_parse_state = S_SERVO_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -866,7 +1507,7 @@ void parse_counter(uint8_t const data) {
 				reply[2] = COUNTER_CONFIG_NOK;
 			}
 			reply[3] = reply[0] + reply[1] + reply[2];
-			sendByteArray(reply, 4);
+			send_reply(reply, 4);
 			counter_parse_state = S_COUNTER_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -893,7 +1534,7 @@ void parse_counter(uint8_t const data) {
 				reply[2] = COUNTER_READ_NOK;
 			}
 			reply[4] = reply[0] + reply[1] + reply[2] + reply[3];
-			sendByteArray(reply, 5);
+			send_reply(reply, 5);
 			counter_parse_state = S_COUNTER_DT;
 			parse_state = S_CLASS_TAG;
 		} break;
@@ -903,3 +1544,165 @@ void parse_counter(uint8_t const data) {
 
 	}
 }
+
+// states of the batch parser
+#define S_BATCH_DT			(0)
+#define S_BATCH_EXECUTE_1	(1)
+#define S_BATCH_EXECUTE_2	(2)
+#define S_BATCH_EXECUTE_3	(3)
+
+static volatile uint8_t batch_parse_state = S_BATCH_DT;
+
+#define DT_BATCH_EXECUTE	(0x01)
+
+#define BATCH_OK			(1)
+#define BATCH_NOK			(0)
+
+/**
+ * @brief returns the size of a request which may be part of a batch, 0 if the request is not allowed,
+ * a batch only reads and writes pins and never changes the state of the link or the board
+ */
+uint8_t batch_request_size(uint8_t const class_tag, uint8_t const data_tag) {
+	switch(class_tag) {
+		case CT_GPIO: {
+			if(data_tag == DT_GPIO_READ || data_tag == DT_GPIO_READ_COUNTS) return 4;
+			if(data_tag == DT_GPIO_WRITE) return 5;
+		} break;
+		case CT_ANALOG: {
+			if(data_tag == DT_ANALOG_READ) return 4;
+		} break;
+		case CT_COUNTER: {
+			if(data_tag == DT_COUNTER_READ) return 4;
+		} break;
+		case CT_SERVO: {
+			if(data_tag == DT_SERVO_SET) return 6;
+		} break;
+		default: {
+		} break;
+	}
+	return 0;
+}
+
+/**
+ * @brief checks that the sub requests of a batch are allowed and aligned before any of them is executed
+ * @return 1 if the batch may be executed, 0 otherwise
+ */
+uint8_t batch_is_valid(uint8_t const *data, uint8_t const length) {
+	uint8_t i = 0;
+	while(i < length) {
+		if(length - i < 2) return 0;
+		uint8_t const size = batch_request_size(data[i], data[i + 1]);
+		if(size == 0 || size > length - i) return 0;
+		i += size;
+	}
+	return 1;
+}
+
+/**
+ * @brief parses incoming data for batches, a batch carries complete gpio read/write, analog read, counter
+ * read and servo set requests which are executed in order and answered with one reply containing all
+ * their replies
+ */
+void parse_batch(uint8_t const data) {
+
+	static uint8_t length = 0;
+	static uint8_t data_cnt = 0;
+	static uint8_t cs = 0;
+	static uint8_t data_arr[BATCH_MAX_REQUEST_SIZE];
+
+	switch(batch_parse_state) {
+
+		case S_BATCH_DT: {
+			if(data == DT_BATCH_EXECUTE) {
+				batch_parse_state = S_BATCH_EXECUTE_1;
+			}
+		} break;
+
+		// BATCH EXECUTE
+		case S_BATCH_EXECUTE_1: {
+			length = data;
+			data_cnt = 0;
+			cs = CT_BATCH + DT_BATCH_EXECUTE + length;
+			if(length == 0) batch_parse_state = S_BATCH_EXECUTE_3;
+			else			batch_parse_state = S_BATCH_EXECUTE_2;
+		} break;
+
+		case S_BATCH_EXECUTE_2: {
+			if(data_cnt < BATCH_MAX_REQUEST_SIZE) {
+				data_arr[data_cnt] = data;
+			}
+			cs += data;
+			data_cnt++;
+			if(data_cnt == length) batch_parse_state = S_BATCH_EXECUTE_3;
+		} break;
+
+		case S_BATCH_EXECUTE_3: {
+			batch_parse_state = S_BATCH_DT;
+			parse_state = S_CLASS_TAG;
+
+			batch_reply[0] = CT_BATCH;
+			batch_reply[1] = DT_BATCH_EXECUTE;
+			batch_reply_size = 3;
+			batch_error = 0;
+			if(cs == data && length <= BATCH_MAX_REQUEST_SIZE && batch_is_valid(data_arr, length)) {
+				batch_active = 1;
+				for(uint8_t i=0; i<length; i++) {
+					parse_tag(data_arr[i]);
+				}
+				batch_active = 0;
+				if(parse_state != S_CLASS_TAG) { // the last sub request is incomplete
+					resetParser();
+					batch_error = 1;
+				}
+			}
+			else {
+				batch_error = 1;
+			}
+
+			if(batch_error) {
+				// the host cannot assign partial replies
+				batch_reply_size = 3;
+				batch_reply[2] = BATCH_NOK;
+			}
+			else {
+				batch_reply[2] = BATCH_OK;
+			}
+			uint8_t reply_cs = 0;
+			for(uint8_t i=0; i<batch_reply_size; i++) {
+				reply_cs += batch_reply[i];
+			}
+			batch_reply[batch_reply_size] = reply_cs;
+			send_reply(batch_reply, batch_reply_size + 1);
+		} break;
+
+		default: {
+		} break;
+	}
+}
+
+/**
+ * @brief initialises the parser after the board has started, the host learns about the start with DT_MISC_RESTARTED
+ */
+void initParser() {
+	resetParser();
+	protocol_version = PROTOCOL_V1;
+	frame_state = S_FRAME_START;
+	has_restarted = 1;
+	frames_dropped = 0;
+	noack_failed = 0;
+	noack_executed = 0;
+}
+
+/**
+ * @brief returns all v1 parsers to the start of a request
+ */
+void resetParser() {
+	parse_state = S_CLASS_TAG;
+	misc_parse_state = S_MISC_DT;
+	gpio_parse_state = S_GPIO_DT;
+	analog_parse_state = S_ANALOG_DT;
+	i2c_parse_state = S_I2C_DT;
+	servo_parse_state = S_SERVO_DT;
+	counter_parse_state = S_COUNTER_DT;
+	batch_parse_state = S_BATCH_DT;
+}
@@ -38,4 +38,15 @@
  */
 void parse(uint8_t const data);
 
+/**
+ * @brief sends the pending event of one subscribed gpio pin, called by the main loop between the requests
+ * @return 1 if an event has been sent, 0 otherwise
+ */
+uint8_t sendEvents();
+
+/**
+ * @brief initialises the parser after the board has started, the host learns about the start with DT_MISC_RESTARTED
+ */
+void initParser();
+
 #endif
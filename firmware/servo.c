@@ -28,6 +28,7 @@
  */
 
 #include "servo.h"
+#include "gpio.h"
 #include "hal.h"
 #include "project.h"
 #include <avr/io.h>
@@ -52,7 +53,8 @@ typedef union {
 
 static volatile s_servo_bitmap servo_bitmap;
 
-static uint8_t const timer0_reload = (255-200); // for generating 100 us timer intervals
+static uint8_t const timer0_top = (200-1); // for generating 100 us timer intervals in ctc mode
+static volatile uint32_t timer0_time_us = 0; // time at the last timer 0 interrupt
 static uint8_t timer0_pwm_value_D2 = 15;
 static uint8_t timer0_pwm_value_D3 = 15;
 static uint8_t timer0_pwm_value_D4 = 15;
@@ -76,9 +78,14 @@ void initServo() {
 	OCR1A = pwm_middle;
 	OCR1B = pwm_middle;
 
-	// software pwm
+	// software pwm, timer 0 runs from the start as it is the time base of getTime_us as well. The ctc mode
+	// avoids the drift of reloading the counter in the interrupt.
+	timer0_time_us = 0;
 	TCNT0 = 0;
-	TIMSK0 = (1<<TOIE0); // enable timer 0 overflow interrupt
+	OCR0A = timer0_top;
+	TCCR0A = (1<<WGM01); // ctc mode
+	TIMSK0 = (1<<OCIE0A); // enable timer 0 compare match interrupt
+	TCCR0B |= (1<<CS01); // Prescale = 8, 16 MHz / 8 = 2 MHz, T = 0.5 us
 }
 
 /**
@@ -211,21 +218,42 @@ void setServoPwm(servo_pin const p, uint16_t const pwm_value) {
 }
 
 /**
- * @brief Timer 0 Overflow Interrupt, happens every 100 us
+ * @brief returns the time since the start of the board, timer 0 of the software pwm serves as time base
+ * @return time in us, wraps around after about 71 minutes
+ */
+uint32_t getTime_us() {
+	uint8_t const sreg = SREG;
+	cli();
+
+	uint32_t time_us = timer0_time_us;
+	uint8_t const cnt = TCNT0;
+	if((TIFR0 & (1<<OCF0A)) && cnt < (timer0_top / 2)) {
+		time_us += 100; // the counter has restarted, its interrupt is still pending
+	}
+
+	SREG = sreg;
+
+	return time_us + (cnt >> 1);
+}
+
+/**
+ * @brief Timer 0 Compare Match Interrupt, happens every 100 us
  */
 static uint8_t timer0_100us_cnt_1 = 0;
 static uint8_t timer0_100us_cnt_2 = 0;
+static uint8_t timer0_100us_cnt_3 = 0;
 #define S_TIMER0_SETPIN (0)
 #define S_TIMER0_CLRPIN (1)
 static uint8_t timer0_state = 0;
 
 
-ISR(TIMER0_OVF_vect) {
+ISR(TIMER0_COMPA_vect) {
 
 	uint8_t const c_20_ms = 200;
 	uint8_t const c_10_ms = 100;
+	uint8_t const c_sample = GPIO_SAMPLE_PERIOD_MS * 10;
 
-	TCNT0 = timer0_reload;
+	timer0_time_us += 100;
 
 	timer0_100us_cnt_1++; // counter for 20 ms period
 	timer0_100us_cnt_2++; // counter for impulse length
@@ -256,6 +284,13 @@ ISR(TIMER0_OVF_vect) {
 			timer0_state = S_TIMER0_SETPIN;
 		}
 	}
+
+	// the debounced gpio pins are sampled after the servo pins have been switched
+	timer0_100us_cnt_3++;
+	if(timer0_100us_cnt_3 == c_sample) {
+		timer0_100us_cnt_3 = 0;
+		sampleGpio();
+	}
 	
  }
 
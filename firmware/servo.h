@@ -53,4 +53,10 @@ void configServo(servo_pin const p, uint16_t const pwm_value);
  */
 void setServoPwm(servo_pin const p, uint16_t const pwm_value);
 
+/**
+ * @brief returns the time since the start of the board, timer 0 of the software pwm serves as time base
+ * @return time in us, wraps around after about 71 minutes
+ */
+uint32_t getTime_us();
+
 #endif
@@ -31,7 +31,7 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
-#define BUF_SIZE (256)
+#define BUF_SIZE (UART_BUF_SIZE)
 
 static volatile uint8_t rx_rd_ptr = 0, rx_wr_ptr = 0, rx_cnt = 0;
 static volatile uint8_t rx_buf[BUF_SIZE];
@@ -39,18 +39,82 @@ static volatile uint8_t rx_buf[BUF_SIZE];
 static volatile uint8_t tx_rd_ptr = 0, tx_wr_ptr = 0, tx_cnt = 0;
 static volatile uint8_t tx_buf[BUF_SIZE];
 
+#define BAUD_REVERT_TICKS (50) // 50 * 10 ms
+
+static volatile uint8_t baud_revert_ticks = 0;
+static volatile uint8_t baud_rate = UART_BAUD_230400, baud_rate_previous = UART_BAUD_230400;
+
+/**
+ * @brief sets the baud rate register, U2X0 is always set
+ * @param rate one of UART_BAUD_x
+ */
+static void setBaudRateRegister(uint8_t const rate) {
+	switch(rate) {
+		case UART_BAUD_250000: UBRR0 = 7; break;
+		case UART_BAUD_500000: UBRR0 = 3; break;
+		case UART_BAUD_1000000: UBRR0 = 1; break;
+		default: UBRR0 = 8; break;
+	}
+}
+
 /**
  * @brief init uart interface to 115200, 8, N, 1
  */
 void initUart() {
 	// baudrate = 230400, error = -3.5 %
-	UBRR0 = 8;
+	baud_rate = baud_rate_previous = UART_BAUD_230400;
+	setBaudRateRegister(baud_rate);
 	UCSR0A = (1<<U2X0);
 	// enable rx complete interrupt and
 	// enable reseiver and transmitter
 	UCSR0B = (1<<RXCIE0) | (1<<RXEN0) | (1<<TXEN0); 
 }
 
+/**
+ * @brief switches the uart to another baud rate once all pending bytes have been transmitted,
+ * the uart reverts to the previous rate unless confirmUartBaudRate is called within 0.5 s
+ * @param rate one of UART_BAUD_x
+ * @return 1 if the baud rate has been switched, 0 if the rate is not supported
+ */
+uint8_t switchUartBaudRate(uint8_t const rate) {
+	if(rate > UART_BAUD_1000000) return 0;
+
+	// the reply to the switch request is still transmitted with the old rate
+	while(tx_cnt > 0) { }
+	while(!(UCSR0A & (1<<TXC0))) { }
+
+	cli();
+	confirmUartBaudRate(); // a switch which has not been confirmed yet is kept
+	baud_rate_previous = baud_rate;
+	baud_rate = rate;
+	setBaudRateRegister(rate);
+	rx_rd_ptr = rx_wr_ptr = rx_cnt = 0; // bytes received during the switch are garbled
+	if(rate != baud_rate_previous) {
+		// timer 2 counts the confirmation window, 16 MHz / 1024 / 156 = 100 Hz
+		baud_revert_ticks = BAUD_REVERT_TICKS;
+		TCCR2A = (1<<WGM21); // ctc mode
+		OCR2A = 155;
+		TCNT2 = 0;
+		TIMSK2 = (1<<OCIE2A);
+		TCCR2B = (1<<CS22) | (1<<CS21) | (1<<CS20);
+	}
+	sei();
+
+	return 1;
+}
+
+/**
+ * @brief keeps the baud rate selected by switchUartBaudRate
+ */
+void confirmUartBaudRate() {
+	uint8_t const sreg = SREG;
+	cli();
+	baud_revert_ticks = 0;
+	TCCR2B = 0; // stop timer 2
+	TIMSK2 = 0;
+	SREG = sreg;
+}
+
 /**
  * @brief put data into the tx ringbuffer
  * @param data data to put in the tx buffer
@@ -109,6 +173,20 @@ uint8_t uartDataAvailable() {
 	return tmp;
 }
 
+/**
+ * @brief checks if all data in the tx ringbuffer has been handed to the uart
+ * @return 1 if the tx ringbuffer is empty, 0 otherwise
+ */
+uint8_t uartTxBufferEmpty() {
+	cli();
+
+	uint8_t tmp = (tx_cnt == 0);
+
+	sei();
+
+	return tmp;
+}
+
 /**
  * @brief uart receive complete ISR
  */
@@ -125,9 +203,26 @@ ISR(USART_RX_vect) {
  */
 ISR(USART_UDRE_vect) {
 	if(tx_cnt > 0) { // buffer not empty yet
+		UCSR0A |= (1<<TXC0); // the transmit complete flag is cleared by writing a one
 		UDR0 = tx_buf[tx_rd_ptr];
 		tx_rd_ptr = (tx_rd_ptr + 1) & (BUF_SIZE-1);
 		tx_cnt--;
 		if(tx_cnt == 0) UCSR0B &= ~(1<<UDRIE0); // deactivate that interrupt
 	}
 }
+
+/**
+ * @brief timer 2 compare ISR, reverts an unconfirmed baud rate switch
+ */
+ISR(TIMER2_COMPA_vect) {
+	if(baud_revert_ticks > 0) {
+		baud_revert_ticks--;
+		if(baud_revert_ticks == 0) {
+			baud_rate = baud_rate_previous;
+			setBaudRateRegister(baud_rate);
+			rx_rd_ptr = rx_wr_ptr = rx_cnt = 0;
+			TCCR2B = 0;
+			TIMSK2 = 0;
+		}
+	}
+}
@@ -32,11 +32,33 @@
 
 #include <stdint.h>
 
+// baud rates selectable by switchUartBaudRate, the error refers to a 16 MHz clock
+#define UART_BAUD_230400	(0) // error -3.5 %, rate after reset
+#define UART_BAUD_250000	(1) // error 0 %
+#define UART_BAUD_500000	(2) // error 0 %
+#define UART_BAUD_1000000	(3) // error 0 %
+
+// size of the receive and the transmit ring buffer, a power of two
+#define UART_BUF_SIZE		(256)
+
 /**
  * @brief init uart interface to 230400, 8, N, 1
  */
 void initUart();
 
+/**
+ * @brief switches the uart to another baud rate once all pending bytes have been transmitted,
+ * the uart reverts to the previous rate unless confirmUartBaudRate is called within 0.5 s
+ * @param rate one of UART_BAUD_x
+ * @return 1 if the baud rate has been switched, 0 if the rate is not supported
+ */
+uint8_t switchUartBaudRate(uint8_t const rate);
+
+/**
+ * @brief keeps the baud rate selected by switchUartBaudRate
+ */
+void confirmUartBaudRate();
+
 /**
  * @brief put data into the tx ringbuffer
  * @param data data to put in the tx buffer
@@ -50,6 +72,12 @@ void sendByte(uint8_t const data);
  */
 void sendByteArray(uint8_t *data, uint8_t const size);
 
+/**
+ * @brief checks if all data in the tx ringbuffer has been handed to the uart
+ * @return 1 if the tx ringbuffer is empty, 0 otherwise
+ */
+uint8_t uartTxBufferEmpty();
+
 /**
  * @brief reads a data byte from the uart
  * @param data pointer where to save the read data
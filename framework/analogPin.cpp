@@ -32,6 +32,7 @@
 #include <assert.h>
 #include <iostream>
 #include <cstring>
+#include <boost/bind/bind.hpp>
 
 namespace arduinoio {
 
@@ -53,12 +54,11 @@ analogPin::~analogPin() {
 }
 
 /**
- * @brief configures the ea hardware depending on the specific needs of the derived ioentity
- * @return true in case of success, false in case of failure
+ * @brief the analog pins need no configuration
+ * @return 0, no request is sent
  */
-bool analogPin::config() { // needs no configuration
-	setIsConfiguredFlag();
-	return true;
+unsigned int analogPin::buildConfigRequest(unsigned char *) const {
+	return 0;
 }
 
 /**
@@ -76,29 +76,74 @@ bool analogPin::getPinVoltage(float &voltage) {
 	int const msgSize = 4;
 	unsigned char msg[msgSize] = { CT_ANALOG, DT_ANALOG_READ, pinNumber,
 			CT_ANALOG + DT_ANALOG_READ + pinNumber };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 6;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
-	if (reply.get()[0] != CT_ANALOG || reply.get()[1] != DT_ANALOG_READ) {
-		std::cerr << __FILE__ << ":" << __LINE__
-		<< " Error in request reply message." << std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
+
+	return evaluatePinVoltage(reply, voltage);
+}
+
+/**
+ *  @brief requests the voltage measured at the ADC Pin without waiting for the reply
+ *  @param handler handler invoked with the voltage in V once the reply has been received
+ */
+void analogPin::getPinVoltage(voltageHandler const &handler) {
+
+	if (!isConfigured()) {
+		handler(false, 0.0);
+		return;
+	}
+
+	// queue request string
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	int const msgSize = 4;
+	unsigned char msg[msgSize] = { CT_ANALOG, DT_ANALOG_READ, pinNumber,
+			(unsigned char) (CT_ANALOG + DT_ANALOG_READ + pinNumber) };
+	int const replySize = 6;
+	m_serial->asyncRequest(msg, msgSize, replySize,
+			boost::bind(&analogPin::onPinVoltage, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ *  @brief appends the request for the voltage measured at the ADC Pin to a batch
+ *  @param b batch of the board the pin belongs to
+ *  @param handler handler invoked with the voltage in V once the batch has been executed
+ */
+void analogPin::getPinVoltage(batch &b, voltageHandler const &handler) {
+
+	if (!isConfigured()) {
+		handler(false, 0.0);
+		return;
 	}
-	if (reply.get()[2] == ANALOG_NOK) {
+
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	int const msgSize = 4;
+	unsigned char msg[msgSize] = { CT_ANALOG, DT_ANALOG_READ, pinNumber,
+			(unsigned char) (CT_ANALOG + DT_ANALOG_READ + pinNumber) };
+	int const replySize = 6;
+	b.add(msg, msgSize, replySize,
+			boost::bind(&analogPin::onPinVoltage, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief evaluates the reply to an analog read request
+ */
+bool analogPin::evaluatePinVoltage(unsigned char const *reply, float &voltage) {
+	if (reply[2] == ANALOG_NOK) {
 		return false;
 	}
 
 	// write id into the the result variable
 	unsigned int tmp = 0;
-	unsigned char const tmpArray[2] = { reply.get()[4], reply.get()[3] };
+	unsigned char const tmpArray[2] = { reply[4], reply[3] };
 	memcpy(&tmp, tmpArray, 2);
 	// voltage measured at the adc pin
 	voltage = ((float) (tmp)) * lsb;
@@ -106,4 +151,11 @@ bool analogPin::getPinVoltage(float &voltage) {
 	return true;
 }
 
+void analogPin::onPinVoltage(voltageHandler const &handler, bool const ok,
+		unsigned char const *reply, unsigned int const size) {
+	float voltage = 0.0;
+	bool const success = ok && size >= 6 && evaluatePinVoltage(reply, voltage);
+	handler(success, voltage);
+}
+
 } // end of namespace arduinoio
@@ -32,6 +32,7 @@
 
 #include "ioentity.h"
 #include "pin.h"
+#include <boost/function.hpp>
 
 namespace arduinoio {
 
@@ -44,6 +45,8 @@ static float const lsb = vref / 1024.0;
  */
 class analogPin: public ioentity {
 public:
+	typedef boost::function<void (bool const ok, float const voltage)> voltageHandler;
+
 	/**
 	 * @brief Constructor
 	 * @param pComSerial pointer to the serial com module
@@ -56,18 +59,33 @@ public:
 	 */
 	virtual ~analogPin();
 
-	/**
-	 * @brief configures the ea hardware depending on the specific needs of the derived ioentity
-	 * @return true in case of success, false in case of failure
-	 */
-	virtual bool config();
-
 	/**
 	 *  @brief returns the voltage measured at the ADC Pin in V
 	 *  @param voltage voltage at the adc pin in V
 	 *  @return true in case of success, false in case of failure
 	 */
 	bool getPinVoltage(float &voltage);
+
+	/**
+	 *  @brief requests the voltage measured at the ADC Pin without waiting for the reply
+	 *  @param handler handler invoked with the voltage in V once the reply has been received
+	 */
+	void getPinVoltage(voltageHandler const &handler);
+
+	/**
+	 *  @brief appends the request for the voltage measured at the ADC Pin to a batch
+	 *  @param b batch of the board the pin belongs to
+	 *  @param handler handler invoked with the voltage in V once the batch has been executed
+	 */
+	void getPinVoltage(batch &b, voltageHandler const &handler);
+
+protected:
+	virtual unsigned int buildConfigRequest(unsigned char *msg) const;
+
+private:
+	static bool evaluatePinVoltage(unsigned char const *reply, float &voltage);
+	static void onPinVoltage(voltageHandler const &handler, bool const ok,
+			unsigned char const *reply, unsigned int const size);
 };
 
 } // end of namespace arduinoio
@@ -0,0 +1,222 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "batch.h"
+#include "tags.h"
+#include <assert.h>
+#include <boost/bind/bind.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ * @param serial serial com module of the board executing the batch, see ioboard::createBatch
+ * @param maxRequestSize bytes of sub requests the firmware accepts within one batch request
+ * @param maxReplySize bytes of sub replies the firmware returns within one batch reply
+ */
+batch::batch(boost::shared_ptr<serial> const &serial,
+		unsigned int const maxRequestSize, unsigned int const maxReplySize) :
+		m_serial(serial), m_maxRequestSize(maxRequestSize), m_maxReplySize(
+				maxReplySize) {
+	assert(m_serial);
+}
+
+/**
+ * @brief Destructor
+ */
+batch::~batch() {
+
+}
+
+/**
+ * @brief appends a request, the io entities call it from their batch methods
+ * @param msg pointer to the complete request message including the checksum
+ * @param msgSize number of bytes of the request message
+ * @param replySize number of bytes of the expected reply
+ * @param handler handler invoked with the reply once the batch has been executed
+ */
+void batch::add(unsigned char const *msg, unsigned int const msgSize,
+		unsigned int const replySize, replyHandler const &handler) {
+	assert(msgSize <= m_maxRequestSize && replySize <= m_maxReplySize);
+
+	if (m_chunks.empty()
+			|| m_chunks.back().msg.size() + msgSize > m_maxRequestSize
+			|| m_chunks.back().replySize + replySize > m_maxReplySize) {
+		chunk c;
+		c.replySize = 0;
+		c.firstHandler = m_handlers.size();
+		m_chunks.push_back(c);
+	}
+
+	chunk &c = m_chunks.back();
+	c.msg.insert(c.msg.end(), msg, msg + msgSize);
+	c.replySizes.push_back(replySize);
+	c.replySize += replySize;
+	m_handlers.push_back(handler);
+}
+
+/**
+ * @brief executes the collected requests and waits until the handlers of all of them have been invoked,
+ * the batch is empty afterwards
+ * @return true if the board has executed all requests, false otherwise
+ */
+bool batch::execute() {
+	if (m_chunks.empty()) {
+		return true;
+	}
+
+	boost::shared_ptr<execution> pExec = takeExecution(resultHandler());
+	unsigned int const last = pExec->chunks.size() - 1;
+
+	// the chunks are transmitted with one write, the reply of the last one is awaited
+	std::vector<unsigned char> msg;
+	m_serial->holdWrites();
+	for (unsigned int i = 0; i < last; i++) {
+		buildRequest(pExec->chunks[i], msg);
+		m_serial->asyncRequest(&msg[0], msg.size(),
+				pExec->chunks[i].replySize + 4,
+				boost::bind(&batch::onChunk, pExec, i, boost::placeholders::_1,
+						boost::placeholders::_2, boost::placeholders::_3));
+	}
+
+	buildRequest(pExec->chunks[last], msg);
+	unsigned int const replySize = pExec->chunks[last].replySize + 4;
+	std::vector<unsigned char> reply(replySize);
+	bool const ok = m_serial->transfer(&msg[0], msg.size(), &reply[0],
+			replySize);
+	onChunk(pExec, last, ok, &reply[0], replySize);
+
+	return pExec->isOk;
+}
+
+/**
+ * @brief executes the collected requests without waiting for the replies, the batch is empty afterwards
+ * and can be filled for the next cycle
+ * @param handler handler invoked once the handlers of all requests have been invoked
+ */
+void batch::execute(resultHandler const &handler) {
+	if (m_chunks.empty()) {
+		if (handler) handler(true);
+		return;
+	}
+
+	boost::shared_ptr<execution> pExec = takeExecution(handler);
+
+	std::vector<unsigned char> msg;
+	m_serial->holdWrites();
+	for (unsigned int i = 0; i < pExec->chunks.size(); i++) {
+		buildRequest(pExec->chunks[i], msg);
+		m_serial->asyncRequest(&msg[0], msg.size(),
+				pExec->chunks[i].replySize + 4,
+				boost::bind(&batch::onChunk, pExec, i, boost::placeholders::_1,
+						boost::placeholders::_2, boost::placeholders::_3));
+	}
+	m_serial->flush();
+}
+
+/**
+ * @brief discards the collected requests without invoking their handlers
+ */
+void batch::clear() {
+	m_chunks.clear();
+	m_handlers.clear();
+}
+
+/**
+ * @brief moves the collected requests into an execution, so the batch can be filled again right away
+ */
+boost::shared_ptr<batch::execution> batch::takeExecution(
+		resultHandler const &handler) {
+	boost::shared_ptr<execution> pExec(new execution());
+	pExec->chunks.swap(m_chunks);
+	pExec->handlers.swap(m_handlers);
+	pExec->numCompleted = 0;
+	pExec->isOk = true;
+	pExec->handler = handler;
+
+	return pExec;
+}
+
+/**
+ * @brief builds the batch request [CT_BATCH, DT_BATCH_EXECUTE, length, sub requests, checksum]
+ */
+void batch::buildRequest(chunk const &c, std::vector<unsigned char> &msg) {
+	msg.clear();
+	msg.push_back(CT_BATCH);
+	msg.push_back(DT_BATCH_EXECUTE);
+	msg.push_back((unsigned char) c.msg.size());
+	msg.insert(msg.end(), c.msg.begin(), c.msg.end());
+
+	unsigned char cs = 0;
+	for (unsigned int i = 0; i < msg.size(); i++) {
+		cs += msg[i];
+	}
+	msg.push_back(cs);
+}
+
+/**
+ * @brief evaluates the reply to a batch request, the sub replies follow the status
+ */
+bool batch::evaluateChunk(unsigned char const *reply) {
+	return reply[2] != BATCH_NOK;
+}
+
+/**
+ * @brief hands the sub replies to the handlers of their requests
+ */
+void batch::onChunk(boost::shared_ptr<execution> const &pExec,
+		unsigned int const chunkIndex, bool const ok,
+		unsigned char const *reply, unsigned int const size) {
+	execution &exec = *pExec;
+	chunk const &c = exec.chunks[chunkIndex];
+	bool const success = ok && size >= c.replySize + 4 && evaluateChunk(reply);
+
+	unsigned int offset = 3;
+	for (unsigned int i = 0; i < c.replySizes.size(); i++) {
+		replyHandler const &handler = exec.handlers[c.firstHandler + i];
+		if (handler) {
+			if (success) {
+				handler(true, reply + offset, c.replySizes[i]);
+			} else {
+				handler(false, 0, 0);
+			}
+		}
+		offset += c.replySizes[i];
+	}
+
+	if (!success) {
+		exec.isOk = false;
+	}
+	exec.numCompleted++;
+	if (exec.numCompleted == exec.chunks.size() && exec.handler) {
+		exec.handler(exec.isOk);
+	}
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,139 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include "serial.h"
+
+namespace arduinoio {
+
+/**
+ * @class batch
+ * @brief collects requests of several io entities, e.g. the inputs and outputs of one control cycle, which
+ * the board executes with one round trip. The board answers with the replies of all requests, each of
+ * them is handed to the handler of its io entity. Requests beyond the limits of the firmware are
+ * continued in further batch requests which are transmitted with the same write.
+ */
+class batch {
+public:
+	typedef boost::function<void (bool const ok)> resultHandler;
+
+	/**
+	 * @brief Constructor
+	 * @param serial serial com module of the board executing the batch, see ioboard::createBatch
+	 * @param maxRequestSize bytes of sub requests the firmware accepts within one batch request
+	 * @param maxReplySize bytes of sub replies the firmware returns within one batch reply
+	 */
+	batch(boost::shared_ptr<serial> const &serial,
+			unsigned int const maxRequestSize, unsigned int const maxReplySize);
+
+	/**
+	 * @brief Destructor
+	 */
+	~batch();
+
+	/**
+	 * @brief appends a request, the io entities call it from their batch methods
+	 * @param msg pointer to the complete request message including the checksum
+	 * @param msgSize number of bytes of the request message
+	 * @param replySize number of bytes of the expected reply
+	 * @param handler handler invoked with the reply once the batch has been executed
+	 */
+	void add(unsigned char const *msg, unsigned int const msgSize,
+			unsigned int const replySize, replyHandler const &handler);
+
+	/**
+	 * @brief returns the number of requests collected so far
+	 */
+	inline unsigned int getRequestCount() const {
+		return m_handlers.size();
+	}
+
+	/**
+	 * @brief executes the collected requests and waits until the handlers of all of them have been invoked,
+	 * the batch is empty afterwards
+	 * @return true if the board has executed all requests, false otherwise
+	 */
+	bool execute();
+
+	/**
+	 * @brief executes the collected requests without waiting for the replies, the batch is empty afterwards
+	 * and can be filled for the next cycle
+	 * @param handler handler invoked once the handlers of all requests have been invoked
+	 */
+	void execute(resultHandler const &handler);
+
+	/**
+	 * @brief discards the collected requests without invoking their handlers
+	 */
+	void clear();
+
+private:
+	/**
+	 * @brief one batch request and the sub requests it carries
+	 */
+	struct chunk {
+		std::vector<unsigned char> msg; // sub requests
+		std::vector<unsigned int> replySizes;
+		unsigned int replySize; // sum of the sub replies
+		unsigned int firstHandler; // handler of the first sub request
+	};
+
+	/**
+	 * @brief requests of an executed batch waiting for their replies
+	 */
+	struct execution {
+		std::vector<chunk> chunks;
+		std::vector<replyHandler> handlers;
+		unsigned int numCompleted; // chunks whose reply has been received
+		bool isOk;
+		resultHandler handler;
+	};
+
+	boost::shared_ptr<serial> m_serial;
+	unsigned int m_maxRequestSize;
+	unsigned int m_maxReplySize;
+	std::vector<chunk> m_chunks;
+	std::vector<replyHandler> m_handlers;
+
+	boost::shared_ptr<execution> takeExecution(resultHandler const &handler);
+	static void buildRequest(chunk const &c, std::vector<unsigned char> &msg);
+	static bool evaluateChunk(unsigned char const *reply);
+	static void onChunk(boost::shared_ptr<execution> const &pExec,
+			unsigned int const chunkIndex, bool const ok,
+			unsigned char const *reply, unsigned int const size);
+};
+
+} // end of namespace arduinoio
+
+#endif /* BATCH_H_ */
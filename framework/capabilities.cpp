@@ -0,0 +1,96 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "capabilities.h"
+#include "tags.h"
+#include <assert.h>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor, the capabilities of the firmware preceding protocol v2
+ */
+capabilities::capabilities() :
+		m_protocolVersion(PROTOCOL_V1), m_rxBufferSize(256), m_txBufferSize(
+				256), m_maxFramePayload(0), m_batchMaxRequestSize(0), m_batchMaxReplySize(
+				0), m_i2cMaxWriteSize(8), m_classes(
+				(1 << CT_MISC) | (1 << CT_GPIO) | (1 << CT_ANALOG)
+						| (1 << CT_I2C) | (1 << CT_SERVO) | (1 << CT_COUNTER)), m_gpioPins(
+				0x3FFC), m_analogPins(0x3F), m_servoPins(0x06FC), m_counterPins(
+				0x000C) {
+
+}
+
+/**
+ * @brief takes the capabilities from the record of the DT_MISC_CAPABILITIES reply
+ * @param record capabilityRecordSize bytes following the status of the reply
+ * @return true in case of success, false if the record is inconsistent
+ */
+bool capabilities::parse(unsigned char const *record) {
+	assert(record != 0);
+
+	unsigned int const rxBufferSize = record[1] | (record[2] << 8);
+	unsigned int const txBufferSize = record[3] | (record[4] << 8);
+	if (record[0] < PROTOCOL_V1 || rxBufferSize == 0 || txBufferSize == 0) {
+		return false;
+	}
+
+	m_protocolVersion = record[0];
+	m_rxBufferSize = rxBufferSize;
+	m_txBufferSize = txBufferSize;
+	m_maxFramePayload = record[5];
+	m_batchMaxRequestSize = record[6];
+	m_batchMaxReplySize = record[7];
+	m_i2cMaxWriteSize = record[8];
+	m_classes = record[9];
+	m_gpioPins = record[10] | (record[11] << 8);
+	m_analogPins = record[12];
+	m_servoPins = record[13] | (record[14] << 8);
+	m_counterPins = record[15] | (record[16] << 8);
+
+	return true;
+}
+
+bool capabilities::isGpioPin(E_PIN const p) const {
+	return p >= D2 && ((m_gpioPins >> pin(p).getPinNumber()) & 0x01) != 0;
+}
+
+bool capabilities::isAnalogPin(E_PIN const p) const {
+	return p <= A5 && ((m_analogPins >> pin(p).getPinNumber()) & 0x01) != 0;
+}
+
+bool capabilities::isServoPin(E_PIN const p) const {
+	return p >= D2 && ((m_servoPins >> pin(p).getPinNumber()) & 0x01) != 0;
+}
+
+bool capabilities::isCounterPin(E_PIN const p) const {
+	return p >= D2 && ((m_counterPins >> pin(p).getPinNumber()) & 0x01) != 0;
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,130 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CAPABILITIES_H_
+#define CAPABILITIES_H_
+
+#include "pin.h"
+
+namespace arduinoio {
+
+/**
+ * @brief number of bytes of the capability record following the status of the DT_MISC_CAPABILITIES reply
+ */
+static unsigned int const capabilityRecordSize = 17;
+
+/**
+ * @class capabilities
+ * @brief limits and features of the firmware of an io board, reported by DT_MISC_CAPABILITIES. A firmware
+ * without protocol v2 does not report them, the values of that firmware are assumed then.
+ */
+class capabilities {
+public:
+	/**
+	 * @brief Constructor, the capabilities of the firmware preceding protocol v2
+	 */
+	capabilities();
+
+	/**
+	 * @brief takes the capabilities from the record of the DT_MISC_CAPABILITIES reply
+	 * @param record capabilityRecordSize bytes following the status of the reply
+	 * @return true in case of success, false if the record is inconsistent
+	 */
+	bool parse(unsigned char const *record);
+
+	inline unsigned int getProtocolVersion() const {
+		return m_protocolVersion;
+	}
+
+	/**
+	 * @brief returns the size of the uart receive buffer, the requests in flight must fit into it
+	 */
+	inline unsigned int getRxBufferSize() const {
+		return m_rxBufferSize;
+	}
+
+	/**
+	 * @brief returns the size of the uart transmit buffer, the replies in flight must fit into it
+	 */
+	inline unsigned int getTxBufferSize() const {
+		return m_txBufferSize;
+	}
+
+	/**
+	 * @brief returns the largest payload of a v2 frame, 0 without protocol v2
+	 */
+	inline unsigned int getMaxFramePayload() const {
+		return m_maxFramePayload;
+	}
+
+	inline unsigned int getBatchMaxRequestSize() const {
+		return m_batchMaxRequestSize;
+	}
+
+	inline unsigned int getBatchMaxReplySize() const {
+		return m_batchMaxReplySize;
+	}
+
+	/**
+	 * @brief returns the number of data bytes of one i2c write request
+	 */
+	inline unsigned int getI2cMaxWriteSize() const {
+		return m_i2cMaxWriteSize;
+	}
+
+	/**
+	 * @brief returns true if the firmware implements the class, e.g. CT_BATCH
+	 */
+	inline bool hasClass(unsigned int const classTag) const {
+		return classTag < 8 && ((m_classes >> classTag) & 0x01) != 0;
+	}
+
+	bool isGpioPin(E_PIN const p) const;
+	bool isAnalogPin(E_PIN const p) const;
+	bool isServoPin(E_PIN const p) const;
+	bool isCounterPin(E_PIN const p) const;
+
+private:
+	unsigned int m_protocolVersion;
+	unsigned int m_rxBufferSize;
+	unsigned int m_txBufferSize;
+	unsigned int m_maxFramePayload;
+	unsigned int m_batchMaxRequestSize;
+	unsigned int m_batchMaxReplySize;
+	unsigned int m_i2cMaxWriteSize;
+	unsigned int m_classes; // bit per class tag
+	unsigned int m_gpioPins; // bit per pin number
+	unsigned int m_analogPins;
+	unsigned int m_servoPins;
+	unsigned int m_counterPins;
+};
+
+} // end of namespace arduinoio
+
+#endif /* CAPABILITIES_H_ */
@@ -30,6 +30,8 @@
 #include "counterPin.h"
 #include "tags.h"
 #include <cassert>
+#include <iostream>
+#include <boost/bind/bind.hpp>
 
 namespace arduinoio {
 
@@ -55,15 +57,12 @@ counterPin::~counterPin() {
 }
 
 /**
- * @brief configures the ea hardware depending on the specific needs of the derived ioentity
- * @return true in case of success, false in case of failure
+ * @brief builds the request which configures the counter
+ * @param msg buffer receiving the request
+ * @return number of bytes of the request
  */
-bool counterPin::config() {
-
-	// send request string
+unsigned int counterPin::buildConfigRequest(unsigned char *msg) const {
 	unsigned char pinNumber = m_pinVect[0].getPinNumber();
-	int const msgSize = 5;
-
 	unsigned char options = 0x00;
 	if (m_options == RISE)
 		options = 0x01;
@@ -72,32 +71,12 @@ bool counterPin::config() {
 	else if (m_options == BOTH)
 		options = 0x04;
 
-	unsigned char msg[msgSize] = { CT_COUNTER, DT_COUNTER_CONFIG, pinNumber,
-			options, CT_COUNTER + DT_COUNTER_CONFIG + pinNumber + options };
-	m_serial->writeToSerial(msg, msgSize);
-
-	// retrieve answer and evaluate it
-	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
-
-	if (reply.get()[0] != CT_COUNTER || reply.get()[1] != DT_COUNTER_CONFIG) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in request reply message."
-				<< std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == COUNTER_NOK) {
-		return false;
-	}
-
-	setIsConfiguredFlag();
-
-	return true;
+	msg[0] = CT_COUNTER;
+	msg[1] = DT_COUNTER_CONFIG;
+	msg[2] = pinNumber;
+	msg[3] = options;
+	msg[4] = CT_COUNTER + DT_COUNTER_CONFIG + pinNumber + options;
+	return 5;
 }
 
 /**
@@ -116,30 +95,84 @@ bool counterPin::readCounter(unsigned int &val) {
 
 	unsigned char msg[msgSize] = { CT_COUNTER, DT_COUNTER_READ, pinNumber,
 			CT_COUNTER + DT_COUNTER_READ + pinNumber };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 5;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
-
-	if (reply.get()[0] != CT_COUNTER || reply.get()[1] != DT_COUNTER_READ) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in request reply message."
-				<< std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
+
+	return evaluateCounter(reply, val);
+}
+
+/**
+ * @brief requests the value of the counter without waiting for the reply
+ * @param handler handler invoked with the value of the counter once the reply has been received
+ */
+void counterPin::readCounter(counterHandler const &handler) {
+
+	if (!isConfigured()) {
+		handler(false, 0);
+		return;
 	}
-	if (reply.get()[2] == COUNTER_NOK) {
+
+	// queue request string
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	int const msgSize = 4;
+
+	unsigned char msg[msgSize] = { CT_COUNTER, DT_COUNTER_READ, pinNumber,
+			(unsigned char) (CT_COUNTER + DT_COUNTER_READ + pinNumber) };
+	int const replySize = 5;
+	m_serial->asyncRequest(msg, msgSize, replySize,
+			boost::bind(&counterPin::onCounter, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief appends the request for the value of the counter to a batch
+ * @param b batch of the board the pin belongs to
+ * @param handler handler invoked with the value of the counter once the batch has been executed
+ */
+void counterPin::readCounter(batch &b, counterHandler const &handler) {
+
+	if (!isConfigured()) {
+		handler(false, 0);
+		return;
+	}
+
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	int const msgSize = 4;
+
+	unsigned char msg[msgSize] = { CT_COUNTER, DT_COUNTER_READ, pinNumber,
+			(unsigned char) (CT_COUNTER + DT_COUNTER_READ + pinNumber) };
+	int const replySize = 5;
+	b.add(msg, msgSize, replySize,
+			boost::bind(&counterPin::onCounter, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief evaluates the reply to a counter read request
+ */
+bool counterPin::evaluateCounter(unsigned char const *reply,
+		unsigned int &val) {
+	if (reply[2] == COUNTER_NOK) {
 		return false;
 	}
 
-	val = static_cast<unsigned int>(reply.get()[3]);
+	val = static_cast<unsigned int>(reply[3]);
 
 	return true;
 }
 
+void counterPin::onCounter(counterHandler const &handler, bool const ok,
+		unsigned char const *reply, unsigned int const size) {
+	unsigned int val = 0;
+	bool const success = ok && size >= 5 && evaluateCounter(reply, val);
+	handler(success, val);
+}
+
 } // end of namespace arduinoio
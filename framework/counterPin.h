@@ -32,6 +32,7 @@
 
 #include "ioentity.h"
 #include "pin.h"
+#include <boost/function.hpp>
 
 namespace arduinoio {
 
@@ -39,6 +40,8 @@ enum E_COUNTER_OPTIONS {RISE, FALL, BOTH};
 
 class counterPin: public ioentity {
 public:
+	typedef boost::function<void (bool const ok, unsigned int const val)> counterHandler;
+
 	/**
 	 * @brief Constructor
 	 * @param pComSerial pointer to the serial com module
@@ -51,12 +54,6 @@ public:
 	 */
 	virtual ~counterPin();
 
-	/**
-	 * @brief configures the ea hardware depending on the specific needs of the derived ioentity
-	 * @return true in case of success, false in case of failure
-	 */
-	virtual bool config();
-
 	/**
 	 * @brief reads the value of the counter
 	 * @param val value of the counter
@@ -64,8 +61,28 @@ public:
 	 */
 	bool readCounter(unsigned int &val);
 
+	/**
+	 * @brief requests the value of the counter without waiting for the reply
+	 * @param handler handler invoked with the value of the counter once the reply has been received
+	 */
+	void readCounter(counterHandler const &handler);
+
+	/**
+	 * @brief appends the request for the value of the counter to a batch
+	 * @param b batch of the board the pin belongs to
+	 * @param handler handler invoked with the value of the counter once the batch has been executed
+	 */
+	void readCounter(batch &b, counterHandler const &handler);
+
+protected:
+	virtual unsigned int buildConfigRequest(unsigned char *msg) const;
+
 private:
 	E_COUNTER_OPTIONS m_options;
+
+	static bool evaluateCounter(unsigned char const *reply, unsigned int &val);
+	static void onCounter(counterHandler const &handler, bool const ok,
+			unsigned char const *reply, unsigned int const size);
 };
 
 } // end of namespace arduinoio
@@ -0,0 +1,321 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fleet.h"
+#include <iostream>
+#include <boost/bind/bind.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor, opens and identifies the boards in parallel
+ * @param devNodes device nodes of the boards
+ * @param numThreads number of threads running the io service shared by all boards
+ * @param baudRate baud rate of the boards after a reset
+ * @param lowLatency configures the serial ports for minimal latency, see serialPortTransport
+ */
+fleet::fleet(std::vector<std::string> const &devNodes,
+		unsigned int const numThreads, unsigned int const baudRate,
+		bool const lowLatency) {
+	startThreads(numThreads);
+
+	// each board waits for its initialisation, so they are opened by threads of their own
+	std::vector<boost::shared_ptr<ioboard> > boards(devNodes.size());
+	boost::thread_group openers;
+	for (unsigned int i = 0; i < devNodes.size(); i++) {
+		openers.create_thread(
+				boost::bind(&fleet::openBoard, this, devNodes[i], baudRate,
+						lowLatency, &boards[i]));
+	}
+	openers.join_all();
+
+	identifyBoards(boards);
+}
+
+/**
+ * @brief Constructor, identifies the boards behind the transports in parallel
+ * @param transports transports used for the communication with the boards, see transport_factory
+ * @param numThreads number of threads running the io service shared by all boards
+ */
+fleet::fleet(std::vector<boost::shared_ptr<transport> > const &transports,
+		unsigned int const numThreads) {
+	startThreads(numThreads);
+
+	std::vector<boost::shared_ptr<ioboard> > boards(transports.size());
+	boost::thread_group openers;
+	for (unsigned int i = 0; i < transports.size(); i++) {
+		openers.create_thread(
+				boost::bind(&fleet::createBoard, this, transports[i],
+						&boards[i]));
+	}
+	openers.join_all();
+
+	identifyBoards(boards);
+}
+
+/**
+ * @brief Destructor
+ */
+fleet::~fleet() {
+	for (unsigned int i = 0; i < m_openedBoards.size(); i++) {
+		m_openedBoards[i]->stopSupervision();
+		m_openedBoards[i]->waitForAll();
+	}
+
+	// the boards require the shared io service to be stopped before they are destroyed
+	m_work.reset();
+	m_io_service.stop();
+	m_threads.join_all();
+
+	m_polledPins.clear();
+	m_batchById.clear();
+	m_boardById.clear();
+	m_boards.clear();
+	m_openedBoards.clear();
+}
+
+std::vector<unsigned int> fleet::getIds() const {
+	return m_ids;
+}
+
+boost::shared_ptr<ioboard> fleet::getBoard(unsigned int const id) const {
+	std::map<unsigned int, boost::shared_ptr<ioboard> >::const_iterator it =
+			m_boardById.find(id);
+	if (it == m_boardById.end()) {
+		return boost::shared_ptr<ioboard>();
+	}
+	return it->second;
+}
+
+bool fleet::addAnalogPin(unsigned int const id, E_PIN const p) {
+	boost::shared_ptr<ioboard> board = getBoard(id);
+	if (!board) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, no board with id "
+				<< id << "." << std::endl;
+		return false;
+	}
+
+	polledPin pp;
+	pp.boardId = id;
+	pp.pin = p;
+	pp.type = ANALOG_SAMPLE;
+	pp.analog = board->createAnalogPin(p);
+	if (!pp.analog) {
+		return false;
+	}
+	attachBoard(pp, board);
+	m_polledPins.push_back(pp);
+	return true;
+}
+
+bool fleet::addGpioInputPin(unsigned int const id, E_PIN const p,
+		bool const pullUpEnabled) {
+	boost::shared_ptr<ioboard> board = getBoard(id);
+	if (!board) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, no board with id "
+				<< id << "." << std::endl;
+		return false;
+	}
+
+	polledPin pp;
+	pp.boardId = id;
+	pp.pin = p;
+	pp.type = GPIO_SAMPLE;
+	pp.gpio = board->createGpioInputPin(p, pullUpEnabled);
+	if (!pp.gpio) {
+		return false;
+	}
+	attachBoard(pp, board);
+	m_polledPins.push_back(pp);
+	return true;
+}
+
+bool fleet::addCounterPin(unsigned int const id, E_PIN const p,
+		E_COUNTER_OPTIONS const opt) {
+	boost::shared_ptr<ioboard> board = getBoard(id);
+	if (!board) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, no board with id "
+				<< id << "." << std::endl;
+		return false;
+	}
+
+	polledPin pp;
+	pp.boardId = id;
+	pp.pin = p;
+	pp.type = COUNTER_SAMPLE;
+	pp.counter = board->createCounterPin(p, opt);
+	if (!pp.counter) {
+		return false;
+	}
+	attachBoard(pp, board);
+	m_polledPins.push_back(pp);
+	return true;
+}
+
+/**
+ * @brief assigns the board and its batch to a polled pin
+ */
+void fleet::attachBoard(polledPin &pp,
+		boost::shared_ptr<ioboard> const &board) {
+	boost::shared_ptr<batch> &cycle = m_batchById[pp.boardId];
+	if (!cycle) {
+		cycle = board->createBatch();
+	}
+	pp.board = board;
+	pp.cycle = cycle;
+}
+
+/**
+ * @brief reads all registered pins of all boards in one cycle
+ * @param s snapshot receiving the values, it can be reused for the next cycle without reallocation
+ * @return true if all requests succeeded, false otherwise
+ */
+bool fleet::poll(snapshot &s) {
+	s.resize(m_polledPins.size());
+
+	// all requests are in flight at once, every handler fills only its own sample. The pins of a board
+	// executing batches are read with one round trip.
+	for (unsigned int i = 0; i < m_polledPins.size(); i++) {
+		polledPin const &pp = m_polledPins[i];
+		sample &smp = s[i];
+		smp.boardId = pp.boardId;
+		smp.pin = pp.pin;
+		smp.type = pp.type;
+		smp.ok = false;
+
+		bool const isBatched = pp.board->isBatchSupported();
+		switch (pp.type) {
+		case ANALOG_SAMPLE: {
+			analogPin::voltageHandler const handler = boost::bind(
+					&fleet::onVoltage, &smp, boost::placeholders::_1,
+					boost::placeholders::_2);
+			if (isBatched) pp.analog->getPinVoltage(*pp.cycle, handler);
+			else pp.analog->getPinVoltage(handler);
+			break;
+		}
+		case GPIO_SAMPLE: {
+			gpioInputPin::valueHandler const handler = boost::bind(
+					&fleet::onValue, &smp, boost::placeholders::_1,
+					boost::placeholders::_2, boost::placeholders::_3,
+					boost::placeholders::_4);
+			if (isBatched) pp.gpio->getPinValue(*pp.cycle, handler);
+			else pp.gpio->getPinValue(handler);
+			break;
+		}
+		case COUNTER_SAMPLE: {
+			counterPin::counterHandler const handler = boost::bind(
+					&fleet::onCount, &smp, boost::placeholders::_1,
+					boost::placeholders::_2);
+			if (isBatched) pp.counter->readCounter(*pp.cycle, handler);
+			else pp.counter->readCounter(handler);
+			break;
+		}
+		}
+	}
+
+	for (std::map<unsigned int, boost::shared_ptr<batch> >::iterator it =
+			m_batchById.begin(); it != m_batchById.end(); ++it) {
+		it->second->execute(batch::resultHandler());
+	}
+
+	for (unsigned int i = 0; i < m_boards.size(); i++) {
+		m_boards[i]->waitForAll();
+	}
+
+	bool ok = true;
+	for (unsigned int i = 0; i < s.size(); i++) {
+		ok = ok && s[i].ok;
+	}
+	return ok;
+}
+
+void fleet::startThreads(unsigned int const numThreads) {
+	m_work.reset(new boost::asio::io_service::work(m_io_service));
+	for (unsigned int i = 0; i < std::max(numThreads, 1u); i++) {
+		m_threads.create_thread(
+				boost::bind(&boost::asio::io_service::run, &m_io_service));
+	}
+}
+
+/**
+ * @brief keeps the boards which answer with a unique id
+ */
+void fleet::identifyBoards(
+		std::vector<boost::shared_ptr<ioboard> > const &boards) {
+	m_openedBoards = boards; // also the boards which are not used are destroyed after the io service
+	for (unsigned int i = 0; i < boards.size(); i++) {
+		unsigned int id = 0;
+		if (!boards[i]->getId(id)) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error, could not identify board " << i << "."
+					<< std::endl;
+			continue;
+		}
+		if (m_boardById.find(id) != m_boardById.end()) {
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error, board " << i
+					<< " has the same id " << id << " as another board."
+					<< std::endl;
+			continue;
+		}
+
+		m_boards.push_back(boards[i]);
+		m_ids.push_back(id);
+		m_boardById[id] = boards[i];
+	}
+}
+
+void fleet::openBoard(std::string const &devNode, unsigned int const baudRate,
+		bool const lowLatency, boost::shared_ptr<ioboard> *pBoard) {
+	pBoard->reset(new ioboard(devNode, m_io_service, baudRate, lowLatency));
+}
+
+void fleet::createBoard(boost::shared_ptr<transport> const &t,
+		boost::shared_ptr<ioboard> *pBoard) {
+	pBoard->reset(new ioboard(t, m_io_service));
+}
+
+void fleet::onVoltage(sample *pSample, bool const ok, float const voltage) {
+	pSample->ok = ok;
+	pSample->voltage = voltage;
+}
+
+void fleet::onValue(sample *pSample, bool const ok, bool const val,
+		bool const rise, bool const fall) {
+	pSample->ok = ok;
+	pSample->val = val;
+	pSample->rise = rise;
+	pSample->fall = fall;
+}
+
+void fleet::onCount(sample *pSample, bool const ok, unsigned int const val) {
+	pSample->ok = ok;
+	pSample->count = val;
+}
+
+} // end of namespace arduinoio
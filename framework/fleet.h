@@ -0,0 +1,174 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLEET_H_
+#define FLEET_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include "ioboard.h"
+
+namespace arduinoio {
+
+/**
+ * @class fleet
+ * @brief this class represents a set of io boards connected to the pc. The boards are identified by their
+ * id and share one io service run by a small pool of threads. A polling cycle issues the requests of all
+ * registered pins of all boards at once, so the cycle time stays near the one of a single board.
+ */
+class fleet {
+public:
+	enum E_SAMPLE_TYPE {ANALOG_SAMPLE, GPIO_SAMPLE, COUNTER_SAMPLE};
+
+	/**
+	 * @brief value of one registered pin within a snapshot
+	 */
+	struct sample {
+		unsigned int boardId;
+		E_PIN pin;
+		E_SAMPLE_TYPE type;
+		bool ok; // false if the request failed, the values are undefined then
+		float voltage; // analog pins
+		bool val, rise, fall; // gpio input pins
+		unsigned int count; // counter pins
+	};
+
+	/**
+	 * @brief result of one polling cycle, the samples are ordered like the pins were registered
+	 */
+	typedef std::vector<sample> snapshot;
+
+	/**
+	 * @brief Constructor, opens and identifies the boards in parallel
+	 * @param devNodes device nodes of the boards
+	 * @param numThreads number of threads running the io service shared by all boards
+	 * @param baudRate baud rate of the boards after a reset
+	 * @param lowLatency configures the serial ports for minimal latency, see serialPortTransport
+	 */
+	fleet(std::vector<std::string> const &devNodes, unsigned int const numThreads = 2,
+			unsigned int const baudRate = 230400, bool const lowLatency = false);
+
+	/**
+	 * @brief Constructor, identifies the boards behind the transports in parallel
+	 * @param transports transports used for the communication with the boards, see transport_factory
+	 * @param numThreads number of threads running the io service shared by all boards
+	 */
+	fleet(std::vector<boost::shared_ptr<transport> > const &transports,
+			unsigned int const numThreads = 2);
+
+	/**
+	 * @brief Destructor
+	 */
+	~fleet();
+
+	/**
+	 * @brief returns the number of boards which answered with their id
+	 */
+	inline unsigned int getBoardCount() const {
+		return m_boards.size();
+	}
+
+	/**
+	 * @brief returns the ids of all identified boards in the order of their device nodes or transports
+	 */
+	std::vector<unsigned int> getIds() const;
+
+	/**
+	 * @brief returns the board with the given id, a null pointer if there is none
+	 */
+	boost::shared_ptr<ioboard> getBoard(unsigned int const id) const;
+
+	/**
+	 * @brief registers an analog pin of a board for the polling cycles
+	 * @return true if successful, false if the board is unknown or the pin cannot be configured
+	 */
+	bool addAnalogPin(unsigned int const id, E_PIN const p);
+	/**
+	 * @brief registers a gpio input pin of a board for the polling cycles
+	 * @return true if successful, false if the board is unknown or the pin cannot be configured
+	 */
+	bool addGpioInputPin(unsigned int const id, E_PIN const p, bool const pullUpEnabled = true);
+	/**
+	 * @brief registers a counter pin of a board for the polling cycles
+	 * @return true if successful, false if the board is unknown or the pin cannot be configured
+	 */
+	bool addCounterPin(unsigned int const id, E_PIN const p, E_COUNTER_OPTIONS const opt);
+
+	/**
+	 * @brief reads all registered pins of all boards in one cycle
+	 * @param s snapshot receiving the values, it can be reused for the next cycle without reallocation
+	 * @return true if all requests succeeded, false otherwise
+	 */
+	bool poll(snapshot &s);
+
+private:
+	struct polledPin {
+		unsigned int boardId;
+		E_PIN pin;
+		E_SAMPLE_TYPE type;
+		boost::shared_ptr<analogPin> analog;
+		boost::shared_ptr<gpioInputPin> gpio;
+		boost::shared_ptr<counterPin> counter;
+		boost::shared_ptr<ioboard> board;
+		boost::shared_ptr<batch> cycle; // batch of the board, shared by all its pins
+	};
+
+	boost::asio::io_service m_io_service;
+	boost::scoped_ptr<boost::asio::io_service::work> m_work;
+	boost::thread_group m_threads;
+	std::vector<boost::shared_ptr<ioboard> > m_openedBoards;
+	std::vector<boost::shared_ptr<ioboard> > m_boards;
+	std::vector<unsigned int> m_ids;
+	std::map<unsigned int, boost::shared_ptr<ioboard> > m_boardById;
+	std::vector<polledPin> m_polledPins;
+	std::map<unsigned int, boost::shared_ptr<batch> > m_batchById;
+
+	void startThreads(unsigned int const numThreads);
+	void attachBoard(polledPin &pp, boost::shared_ptr<ioboard> const &board);
+	void identifyBoards(std::vector<boost::shared_ptr<ioboard> > const &boards);
+
+	void openBoard(std::string const &devNode, unsigned int const baudRate,
+			bool const lowLatency, boost::shared_ptr<ioboard> *pBoard);
+	void createBoard(boost::shared_ptr<transport> const &t,
+			boost::shared_ptr<ioboard> *pBoard);
+
+	static void onVoltage(sample *pSample, bool const ok, float const voltage);
+	static void onValue(sample *pSample, bool const ok, bool const val,
+			bool const rise, bool const fall);
+	static void onCount(sample *pSample, bool const ok, unsigned int const val);
+};
+
+} // end of namespace arduinoio
+
+#endif /* FLEET_H_ */
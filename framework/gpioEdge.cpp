@@ -0,0 +1,60 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gpioEdge.h"
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ * @param p pin the edge occurred on
+ * @param isRising true for a rising edge, false for a falling edge
+ * @param time_us time of the edge in us since the start of the board, wraps around after 2^32 us
+ */
+gpioEdge::gpioEdge(E_PIN const p, bool const isRising,
+		unsigned long const time_us) :
+		m_pin(p), m_isRising(isRising), m_time_us(time_us) {
+
+}
+
+/**
+ * @brief builds an edge from a record received from the board
+ * @param record 5 bytes, the pin number with bit 7 set for a rising edge and the time little endian
+ */
+gpioEdge gpioEdge::fromRecord(unsigned char const *record) {
+	// the pin numbers 2 to 13 of the board are the pins D2 to D13
+	E_PIN const p = (E_PIN) (D2 + (record[0] & 0x7F) - 2);
+	unsigned long const time_us = (unsigned long) record[1]
+			| ((unsigned long) record[2] << 8)
+			| ((unsigned long) record[3] << 16)
+			| ((unsigned long) record[4] << 24);
+	return gpioEdge(p, (record[0] & 0x80) != 0, time_us);
+}
+
+} // end of namespace arduinoio
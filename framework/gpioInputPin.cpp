@@ -31,6 +31,7 @@
 #include <assert.h>
 #include <iostream>
 #include "tags.h"
+#include <boost/bind/bind.hpp>
 
 namespace arduinoio {
 
@@ -42,7 +43,8 @@ namespace arduinoio {
  */
 gpioInputPin::gpioInputPin(boost::shared_ptr<serial> const &serial, E_PIN const p,
 		bool const pullUpEnabled) :
-	ioentity(serial), m_pullUpEnabled(pullUpEnabled) {
+	ioentity(serial), m_pullUpEnabled(pullUpEnabled), m_debounceTime_ms(0), m_isSubscribed(
+			false), m_isRecording(false) {
 
 	m_pinVect.push_back(p);
 }
@@ -51,7 +53,40 @@ gpioInputPin::gpioInputPin(boost::shared_ptr<serial> const &serial, E_PIN const
  * @brief Destructor
  */
 gpioInputPin::~gpioInputPin() {
+	if (!m_isSubscribed && !m_isRecording) return;
 
+	// stops the events and the recording on the board without waiting for the reply, the events sent
+	// until the request has been processed are dropped
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = buildSubscribeRequest(msg, false, false);
+	int const replySize = 4;
+	m_serial->asyncRequest(msg, msgSize, replySize, replyHandler());
+
+	if (m_isSubscribed) {
+		m_serial->setEventHandler(CT_GPIO, m_pinVect[0].getPinNumber(),
+				eventHandler());
+	}
+}
+
+/**
+ * @brief lets the board debounce the pin, a new value counts as edge once it has been stable for the
+ * debounce time
+ * @param debounce_ms debounce time in ms up to maxDebounceTime_ms, 0 disables the debouncing
+ * @return true in case of success, false in case of failure
+ */
+bool gpioInputPin::setDebounceTime(unsigned int const debounce_ms) {
+
+	if (debounce_ms > maxDebounceTime_ms) return false;
+	if (debounce_ms > 0 && m_serial->getProtocolVersion() != PROTOCOL_V2) {
+		return false; // an older firmware does not know the debounce option
+	}
+
+	unsigned int const previous = m_debounceTime_ms.exchange(debounce_ms);
+	if (!config()) {
+		m_debounceTime_ms = previous;
+		return false;
+	}
+	return true;
 }
 
 /**
@@ -70,35 +105,307 @@ bool gpioInputPin::getPinValue(bool &val, bool &rise, bool &fall) {
 	unsigned char pinNumber = m_pinVect[0].getPinNumber();
 	unsigned char msg[msgSize] = { CT_GPIO, DT_GPIO_READ, pinNumber, CT_GPIO
 			+ DT_GPIO_READ + pinNumber };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 5;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(replySize);
-	if (reply.get()[0] != CT_GPIO || reply.get()[1] != DT_GPIO_READ) {
-		std::cerr << __FILE__ << ":" << __LINE__
-				<< " Error in request gpio input pin read message."
-				<< std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+		return false;
+	}
+
+	return evaluatePinValue(reply, val, rise, fall);
+}
+
+/**
+ * @brief requests the value of the pin without waiting for the reply
+ * @param handler handler invoked with value, rise and fall flag once the reply has been received
+ */
+void gpioInputPin::getPinValue(valueHandler const &handler) {
+
+	if (!isConfigured()) {
+		handler(false, false, false, false);
+		return;
+	}
+
+	// queue request string
+	int const msgSize = 4;
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	unsigned char msg[msgSize] = { CT_GPIO, DT_GPIO_READ, pinNumber,
+			(unsigned char) (CT_GPIO + DT_GPIO_READ + pinNumber) };
+	int const replySize = 5;
+	m_serial->asyncRequest(msg, msgSize, replySize,
+			boost::bind(&gpioInputPin::onPinValue, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief appends the request for the value of the pin to a batch
+ * @param b batch of the board the pin belongs to
+ * @param handler handler invoked with value, rise and fall flag once the batch has been executed
+ */
+void gpioInputPin::getPinValue(batch &b, valueHandler const &handler) {
+
+	if (!isConfigured()) {
+		handler(false, false, false, false);
+		return;
+	}
+
+	int const msgSize = 4;
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	unsigned char msg[msgSize] = { CT_GPIO, DT_GPIO_READ, pinNumber,
+			(unsigned char) (CT_GPIO + DT_GPIO_READ + pinNumber) };
+	int const replySize = 5;
+	b.add(msg, msgSize, replySize,
+			boost::bind(&gpioInputPin::onPinValue, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief returns the value of the pin and the number of its edges counted by the board since the last
+ * call, e.g. to use the pin as an event counter. Requires protocol v2. The rise and fall flags are
+ * cleared like by getPinValue.
+ * @param val current value of the digital input pin
+ * @param rises rising edges since the last readout of the counts, modulo 65536
+ * @param falls falling edges since the last readout of the counts, modulo 65536
+ * @return true in case of success, false in case of failure
+ */
+bool gpioInputPin::getEdgeCounts(bool &val, unsigned int &rises,
+		unsigned int &falls) {
+
+	if (!isCountingSupported()) return false;
+
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = buildCountsRequest(msg);
+	int const replySize = 9;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+		return false;
+	}
+
+	return evaluateEdgeCounts(reply, val, rises, falls);
+}
+
+/**
+ * @brief requests the value of the pin and the number of its edges without waiting for the reply
+ * @param handler handler invoked with value, rising and falling edges once the reply has been received
+ */
+void gpioInputPin::getEdgeCounts(countHandler const &handler) {
+
+	if (!isCountingSupported()) {
+		handler(false, false, 0, 0);
+		return;
+	}
+
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = buildCountsRequest(msg);
+	int const replySize = 9;
+	m_serial->asyncRequest(msg, msgSize, replySize,
+			boost::bind(&gpioInputPin::onEdgeCounts, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief appends the request for the value of the pin and the number of its edges to a batch
+ * @param b batch of the board the pin belongs to
+ * @param handler handler invoked with value, rising and falling edges once the batch has been executed
+ */
+void gpioInputPin::getEdgeCounts(batch &b, countHandler const &handler) {
+
+	if (!isCountingSupported()) {
+		handler(false, false, 0, 0);
+		return;
+	}
+
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = buildCountsRequest(msg);
+	int const replySize = 9;
+	b.add(msg, msgSize, replySize,
+			boost::bind(&gpioInputPin::onEdgeCounts, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief lets the board send an event for every change of the pin instead of waiting to be read,
+ * requires protocol v2. The edges until the event has been sent are combined into it, the rise and
+ * fall flags returned by getPinValue are not affected.
+ * @param handler handler invoked by the io thread with value, rise and fall flag of every event
+ * @return true in case of success, false in case of failure
+ */
+bool gpioInputPin::subscribe(edgeHandler const &handler) {
+
+	if (!isConfigured() || !handler) return false;
+
+	// the handler is in place before the first event can arrive
+	unsigned char const pinNumber = m_pinVect[0].getPinNumber();
+	m_serial->setEventHandler(CT_GPIO, pinNumber,
+			boost::bind(&gpioInputPin::onEvent, handler,
+					boost::placeholders::_1, boost::placeholders::_2));
+
+	if (!transferSubscribeRequest(true, m_isRecording)) {
+		m_serial->setEventHandler(CT_GPIO, pinNumber, eventHandler());
+		return false;
+	}
+
+	m_isSubscribed = true;
+	return true;
+}
+
+/**
+ * @brief stops the events of the pin
+ * @return true in case of success, false in case of failure
+ */
+bool gpioInputPin::unsubscribe() {
+
+	if (!m_isSubscribed) return true;
+	m_isSubscribed = false;
+
+	bool const ok = transferSubscribeRequest(false, m_isRecording);
+
+	// events sent before the request has been processed are dropped
+	m_serial->setEventHandler(CT_GPIO, m_pinVect[0].getPinNumber(),
+			eventHandler());
+	return ok;
+}
+
+/**
+ * @brief lets the board record every edge of the pin with a timestamp in a queue shared by all pins,
+ * the edges are read by ioboard::readGpioEdges. Requires protocol v2.
+ * @param isRecorded true to start, false to stop the recording
+ * @return true in case of success, false in case of failure
+ */
+bool gpioInputPin::recordEdges(bool const isRecorded) {
+
+	if (!isConfigured()
+			|| m_serial->getProtocolVersion() != PROTOCOL_V2) return false;
+
+	if (!transferSubscribeRequest(m_isSubscribed, isRecorded)) {
 		return false;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
+
+	m_isRecording = isRecorded;
+	return true;
+}
+
+/**
+ * @brief configures the pin again after the board has restarted and renews its subscription and
+ * its edge recording
+ * @param handler handler invoked with the result once the replies have been received
+ */
+void gpioInputPin::restore(resultHandler const &handler) {
+	if (!m_isSubscribed && !m_isRecording) {
+		config(handler);
+		return;
+	}
+
+	config(boost::bind(&gpioInputPin::onRestoreConfig,
+			boost::static_pointer_cast<gpioInputPin>(shared_from_this()),
+			handler, boost::placeholders::_1));
+}
+
+/**
+ * @brief builds the request which enables or disables the events and the edge recording of the pin
+ * @param msg buffer receiving the request
+ * @return number of bytes of the request
+ */
+unsigned int gpioInputPin::buildSubscribeRequest(unsigned char *msg,
+		bool const isSubscribed, bool const isRecording) const {
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	unsigned char const enable = (isSubscribed ? GPIO_SUBSCRIBE_EVENTS : 0)
+			| (isRecording ? GPIO_SUBSCRIBE_EDGES : 0);
+
+	msg[0] = CT_GPIO;
+	msg[1] = DT_GPIO_SUBSCRIBE;
+	msg[2] = pinNumber;
+	msg[3] = enable;
+	msg[4] = CT_GPIO + DT_GPIO_SUBSCRIBE + pinNumber + enable;
+	return 5;
+}
+
+/**
+ * @brief sends the request which enables or disables the events and the edge recording of the pin
+ * @return true in case of success, false in case of failure
+ */
+bool gpioInputPin::transferSubscribeRequest(bool const isSubscribed,
+		bool const isRecording) {
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = buildSubscribeRequest(msg, isSubscribed,
+			isRecording);
+	int const replySize = 4;
+	unsigned char reply[replySize];
+	return m_serial->transfer(msg, msgSize, reply, replySize)
+			&& reply[2] != GPIO_NOK;
+}
+
+/**
+ * @brief returns true if the pin is configured and the board counts the edges, only boards using
+ * protocol v2 know the request
+ */
+bool gpioInputPin::isCountingSupported() const {
+	return isConfigured()
+			&& m_serial->getProtocolVersion() == PROTOCOL_V2;
+}
+
+/**
+ * @brief builds the request for the value of the pin and the number of its edges
+ * @param msg buffer receiving the request
+ * @return number of bytes of the request
+ */
+unsigned int gpioInputPin::buildCountsRequest(unsigned char *msg) const {
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+
+	msg[0] = CT_GPIO;
+	msg[1] = DT_GPIO_READ_COUNTS;
+	msg[2] = pinNumber;
+	msg[3] = CT_GPIO + DT_GPIO_READ_COUNTS + pinNumber;
+	return 4;
+}
+
+/**
+ * @brief evaluates the reply to a request for the edge counts
+ */
+bool gpioInputPin::evaluateEdgeCounts(unsigned char const *reply, bool &val,
+		unsigned int &rises, unsigned int &falls) {
+	if (reply[2] == GPIO_NOK) {
 		return false;
 	}
-	if (reply.get()[2] == GPIO_NOK) {
+
+	val = (reply[3] & 0x01) != 0;
+	rises = reply[4] | (reply[5] << 8);
+	falls = reply[6] | (reply[7] << 8);
+	return true;
+}
+
+void gpioInputPin::onEdgeCounts(countHandler const &handler, bool const ok,
+		unsigned char const *reply, unsigned int const size) {
+	bool val = false;
+	unsigned int rises = 0, falls = 0;
+	bool const success = ok && size >= 9
+			&& evaluateEdgeCounts(reply, val, rises, falls);
+	handler(success, val, rises, falls);
+}
+
+/**
+ * @brief evaluates the reply to a gpio read request
+ */
+bool gpioInputPin::evaluatePinValue(unsigned char const *reply, bool &val,
+		bool &rise, bool &fall) {
+	if (reply[2] == GPIO_NOK) {
 		return false;
 	}
 
-	if (reply.get()[3] & 0x01)
+	if (reply[3] & 0x01)
 		val = true;
 	else
 		val = false;
-	if (reply.get()[3] & 0x02)
+	if (reply[3] & 0x02)
 		rise = true;
 	else
 		rise = false;
-	if (reply.get()[3] & 0x04)
+	if (reply[3] & 0x04)
 		fall = true;
 	else
 		fall = false;
@@ -106,44 +413,74 @@ bool gpioInputPin::getPinValue(bool &val, bool &rise, bool &fall) {
 	return true;
 }
 
+void gpioInputPin::onPinValue(valueHandler const &handler, bool const ok,
+		unsigned char const *reply, unsigned int const size) {
+	bool val = false, rise = false, fall = false;
+	bool const success = ok && size >= 5 && evaluatePinValue(reply, val, rise, fall);
+	handler(success, val, rise, fall);
+}
+
+void gpioInputPin::onRestoreConfig(boost::shared_ptr<gpioInputPin> const &ioent,
+		resultHandler const &handler, bool const ok) {
+	if (!ok) {
+		if (handler) handler(false);
+		return;
+	}
+
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = ioent->buildSubscribeRequest(msg,
+			ioent->m_isSubscribed, ioent->m_isRecording);
+	int const replySize = 4;
+	ioent->m_serial->asyncRequest(msg, msgSize, replySize,
+			boost::bind(&gpioInputPin::onSubscribe, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+void gpioInputPin::onSubscribe(resultHandler const &handler, bool const ok,
+		unsigned char const *reply, unsigned int const size) {
+	bool const success = ok && size >= 4 && reply[2] != GPIO_NOK;
+	if (handler) handler(success);
+}
+
+void gpioInputPin::onEvent(edgeHandler const &handler,
+		unsigned char const *event, unsigned int const size) {
+	if (size < 4) return;
+	handler((event[3] & 0x01) != 0, (event[3] & 0x02) != 0,
+			(event[3] & 0x04) != 0);
+}
+
 /**
- * @brief configures the selected io pin as a input
- * @return true in case of sucess, false in case of error
+ * @brief builds the request which configures the selected io pin as a input
+ * @param msg buffer receiving the request
+ * @return number of bytes of the request
  */
-bool gpioInputPin::config() {
-	// send request string
-	int const msgSize = 5;
+unsigned int gpioInputPin::buildConfigRequest(unsigned char *msg) const {
 	unsigned char pinNumber = m_pinVect[0].getPinNumber();
 	unsigned char configOptions = 0x00;
 	if (m_pullUpEnabled) {
 		configOptions = 0x04;
 	}
-	unsigned char msg[msgSize] =
-			{ CT_GPIO, DT_GPIO_CONFIG, pinNumber, configOptions, CT_GPIO
-					+ DT_GPIO_CONFIG + pinNumber + configOptions };
-	m_serial->writeToSerial(msg, msgSize);
 
-	// retrieve answer and evaluate it
-	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(replySize);
-	if (reply.get()[0] != CT_GPIO || reply.get()[1] != DT_GPIO_CONFIG) {
-		std::cerr << __FILE__ << ":" << __LINE__
-				<< " Error in request gpio input pin config message."
-				<< std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == GPIO_NOK) {
-		return false;
+	unsigned char const debounceTime = (unsigned char) m_debounceTime_ms;
+	if (debounceTime == 0) {
+		msg[0] = CT_GPIO;
+		msg[1] = DT_GPIO_CONFIG;
+		msg[2] = pinNumber;
+		msg[3] = configOptions;
+		msg[4] = CT_GPIO + DT_GPIO_CONFIG + pinNumber + configOptions;
+		return 5;
 	}
 
-	setIsConfiguredFlag();
-
-	return true;
+	configOptions |= 0x08; // the debounce time follows
+	msg[0] = CT_GPIO;
+	msg[1] = DT_GPIO_CONFIG;
+	msg[2] = pinNumber;
+	msg[3] = configOptions;
+	msg[4] = debounceTime;
+	msg[5] = CT_GPIO + DT_GPIO_CONFIG + pinNumber + configOptions
+			+ debounceTime;
+	return 6;
 }
 
 } // end of namespace arduinoio
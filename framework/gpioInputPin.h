@@ -32,15 +32,25 @@
 
 #include "pin.h"
 #include "ioentity.h"
+#include <boost/function.hpp>
 
 namespace arduinoio {
 
+/**
+ * @brief longest debounce time of a gpio input pin in ms
+ */
+static unsigned int const maxDebounceTime_ms = 255;
+
 /**
  * @class gpioInputPin
  * @brief implements a digital input pin as an ioentity
  */
 class gpioInputPin: public ioentity {
 public:
+	typedef boost::function<void (bool const ok, bool const val, bool const rise, bool const fall)> valueHandler;
+	typedef boost::function<void (bool const val, bool const rise, bool const fall)> edgeHandler;
+	typedef boost::function<void (bool const ok, bool const val, unsigned int const rises, unsigned int const falls)> countHandler;
+
 	/**
 	 * @brief Constructor
 	 * @param pComSerial pointer th the serial com module
@@ -55,6 +65,20 @@ public:
 	 */
 	virtual ~gpioInputPin();
 
+	/**
+	 * @brief lets the board debounce the pin, a new value counts as edge for getPinValue, the edge counts,
+	 * the events and the recorded edges once it has been stable for the debounce time. The board samples
+	 * the pin every ms instead of using the pin change interrupt. Requires protocol v2 unless the debouncing
+	 * is disabled. The pin is configured again, which clears its edge counts.
+	 * @param debounce_ms debounce time in ms up to maxDebounceTime_ms, 0 disables the debouncing
+	 * @return true in case of success, false in case of failure
+	 */
+	bool setDebounceTime(unsigned int const debounce_ms);
+
+	inline unsigned int getDebounceTime() const {
+		return m_debounceTime_ms;
+	}
+
 	/**
 	 * @brief returns the value of the pin
 	 * @param val current value of the digital input pin
@@ -65,13 +89,101 @@ public:
 	bool getPinValue(bool &val, bool &rise, bool &fall);
 
 	/**
-	 * @brief performs the requested configuration for the ioentity in question
+	 * @brief requests the value of the pin without waiting for the reply
+	 * @param handler handler invoked with value, rise and fall flag once the reply has been received
+	 */
+	void getPinValue(valueHandler const &handler);
+
+	/**
+	 * @brief appends the request for the value of the pin to a batch
+	 * @param b batch of the board the pin belongs to
+	 * @param handler handler invoked with value, rise and fall flag once the batch has been executed
+	 */
+	void getPinValue(batch &b, valueHandler const &handler);
+
+	/**
+	 * @brief returns the value of the pin and the number of its edges counted by the board since the last
+	 * call, e.g. to use the pin as an event counter. Requires protocol v2. The rise and fall flags are
+	 * cleared like by getPinValue.
+	 * @param val current value of the digital input pin
+	 * @param rises rising edges since the last readout of the counts, modulo 65536
+	 * @param falls falling edges since the last readout of the counts, modulo 65536
 	 * @return true in case of success, false in case of failure
 	 */
-	virtual bool config();
+	bool getEdgeCounts(bool &val, unsigned int &rises, unsigned int &falls);
+
+	/**
+	 * @brief requests the value of the pin and the number of its edges without waiting for the reply
+	 * @param handler handler invoked with value, rising and falling edges once the reply has been received
+	 */
+	void getEdgeCounts(countHandler const &handler);
+
+	/**
+	 * @brief appends the request for the value of the pin and the number of its edges to a batch
+	 * @param b batch of the board the pin belongs to
+	 * @param handler handler invoked with value, rising and falling edges once the batch has been executed
+	 */
+	void getEdgeCounts(batch &b, countHandler const &handler);
+
+	/**
+	 * @brief lets the board send an event for every change of the pin instead of waiting to be read,
+	 * requires protocol v2. The edges until the event has been sent are combined into it, the rise and
+	 * fall flags returned by getPinValue are not affected.
+	 * @param handler handler invoked by the io thread with value, rise and fall flag of every event
+	 * @return true in case of success, false in case of failure
+	 */
+	bool subscribe(edgeHandler const &handler);
+
+	/**
+	 * @brief stops the events of the pin
+	 * @return true in case of success, false in case of failure
+	 */
+	bool unsubscribe();
+
+	/**
+	 * @brief lets the board record every edge of the pin with a timestamp in a queue shared by all pins,
+	 * the edges are read by ioboard::readGpioEdges. Requires protocol v2.
+	 * @param isRecorded true to start, false to stop the recording
+	 * @return true in case of success, false in case of failure
+	 */
+	bool recordEdges(bool const isRecorded);
+
+	/**
+	 * @brief configures the pin again after the board has restarted and renews its subscription and
+	 * its edge recording
+	 * @param handler handler invoked with the result once the replies have been received
+	 */
+	virtual void restore(resultHandler const &handler);
+
+protected:
+	virtual unsigned int buildConfigRequest(unsigned char *msg) const;
 
 private:
 	bool m_pullUpEnabled;
+	boost::atomic<unsigned int> m_debounceTime_ms;
+	boost::atomic<bool> m_isSubscribed;
+	boost::atomic<bool> m_isRecording;
+
+	unsigned int buildSubscribeRequest(unsigned char *msg,
+			bool const isSubscribed, bool const isRecording) const;
+	bool transferSubscribeRequest(bool const isSubscribed,
+			bool const isRecording);
+	bool isCountingSupported() const;
+	unsigned int buildCountsRequest(unsigned char *msg) const;
+	static bool evaluateEdgeCounts(unsigned char const *reply, bool &val,
+			unsigned int &rises, unsigned int &falls);
+	static void onEdgeCounts(countHandler const &handler, bool const ok,
+			unsigned char const *reply, unsigned int const size);
+	static bool evaluatePinValue(unsigned char const *reply, bool &val,
+			bool &rise, bool &fall);
+	static void onPinValue(valueHandler const &handler, bool const ok,
+			unsigned char const *reply, unsigned int const size);
+	static void onRestoreConfig(boost::shared_ptr<gpioInputPin> const &ioent,
+			resultHandler const &handler, bool const ok);
+	static void onSubscribe(resultHandler const &handler, bool const ok,
+			unsigned char const *reply, unsigned int const size);
+	static void onEvent(edgeHandler const &handler, unsigned char const *event,
+			unsigned int const size);
 };
 
 } // end of namespace arduinoio
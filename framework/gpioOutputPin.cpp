@@ -31,6 +31,7 @@
 #include "tags.h"
 #include <assert.h>
 #include <iostream>
+#include <boost/bind/bind.hpp>
 
 namespace arduinoio {
 
@@ -42,7 +43,7 @@ namespace arduinoio {
  */
 gpioOutputPin::gpioOutputPin(boost::shared_ptr<serial> const &serial, E_PIN const p,
 		bool const pinValue) :
-	ioentity(serial), m_pinValue(pinValue) {
+	ioentity(serial), m_pinValue(pinValue), m_isAcknowledged(true) {
 
 	m_pinVect.push_back(p);
 }
@@ -55,43 +56,23 @@ gpioOutputPin::~gpioOutputPin() {
 }
 
 /**
- * @brief performs the requested configuration for the ioentity in question
- * @return true in case of success, false in case of failure
+ * @brief builds the request which configures the selected io pin as a output with its current value
+ * @param msg buffer receiving the request
+ * @return number of bytes of the request
  */
-bool gpioOutputPin::config() {
-	// send request string
-	int const msgSize = 5;
+unsigned int gpioOutputPin::buildConfigRequest(unsigned char *msg) const {
 	unsigned char pinNumber = m_pinVect[0].getPinNumber();
 	unsigned char configOptions = 0x01;
 	if (m_pinValue) {
 		configOptions |= 0x02;
 	}
-	unsigned char msg[msgSize] =
-			{ CT_GPIO, DT_GPIO_CONFIG, pinNumber, configOptions, CT_GPIO
-					+DT_GPIO_CONFIG + pinNumber + configOptions };
-	m_serial->writeToSerial(msg, msgSize);
 
-	// retrieve answer and evaluate it
-	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(replySize);
-	if (reply.get()[0] != CT_GPIO || reply.get()[1] != DT_GPIO_CONFIG) {
-		std::cerr << __FILE__ << ":" << __LINE__
-				<< " Error in request gpio output pin config message."
-				<< std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == GPIO_NOK) {
-		return false;
-	}
-
-	setIsConfiguredFlag();
-
-	return true;
+	msg[0] = CT_GPIO;
+	msg[1] = DT_GPIO_CONFIG;
+	msg[2] = pinNumber;
+	msg[3] = configOptions;
+	msg[4] = CT_GPIO + DT_GPIO_CONFIG + pinNumber + configOptions;
+	return 5;
 }
 
 /**
@@ -112,25 +93,25 @@ bool gpioOutputPin::setPinValue(bool const val) {
 	} else {
 		pinValue = 0x00;
 	}
-	unsigned char msg[msgSize] = { CT_GPIO, DT_GPIO_WRITE, pinNumber, pinValue,
-			CT_GPIO + DT_GPIO_WRITE + pinNumber + pinValue };
-	m_serial->writeToSerial(msg, msgSize);
+	unsigned char const dt = selectWriteTag();
+	unsigned char msg[msgSize] = { CT_GPIO, dt, pinNumber, pinValue,
+			(unsigned char) (CT_GPIO + dt + pinNumber + pinValue) };
+
+	if (dt == DT_GPIO_WRITE_NOACK) {
+		if (!m_serial->send(msg, msgSize)) {
+			return false;
+		}
+		m_pinValue = val;
+		return true;
+	}
 
 	// retrieve answer and evaluate it
 	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(replySize);
-	if (reply.get()[0] != CT_GPIO || reply.get()[1] != DT_GPIO_WRITE) {
-		std::cerr << __FILE__ << ":" << __LINE__
-				<< " Error in request gpio output pin setPinValue message."
-				<< std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == GPIO_NOK) {
+	if (!evaluateSetPinValue(reply)) {
 		return false;
 	}
 
@@ -139,4 +120,97 @@ bool gpioOutputPin::setPinValue(bool const val) {
 	return true;
 }
 
+/**
+ * @brief sets the value of the output pin without waiting for the reply
+ * @param val true = 1, false = 0
+ * @param handler handler invoked with the result once the reply has been received
+ */
+void gpioOutputPin::setPinValue(bool const val, resultHandler const &handler) {
+
+	if (!isConfigured()) {
+		if (handler) handler(false);
+		return;
+	}
+
+	// queue request string
+	int const msgSize = 5;
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	unsigned char pinValue = val ? 0x01 : 0x00;
+	unsigned char const dt = selectWriteTag();
+	unsigned char msg[msgSize] = { CT_GPIO, dt, pinNumber, pinValue,
+			(unsigned char) (CT_GPIO + dt + pinNumber + pinValue) };
+	replyHandler const onSet = boost::bind(
+			&gpioOutputPin::onPinValueSet,
+			boost::static_pointer_cast<gpioOutputPin>(shared_from_this()), val,
+			handler, boost::placeholders::_1, boost::placeholders::_2,
+			boost::placeholders::_3);
+	if (dt == DT_GPIO_WRITE_NOACK) {
+		m_serial->asyncSend(msg, msgSize, onSet);
+		return;
+	}
+	int const replySize = 4;
+	m_serial->asyncRequest(msg, msgSize, replySize, onSet);
+}
+
+/**
+ * @brief appends the request setting the value of the output pin to a batch
+ * @param val true = 1, false = 0
+ * @param b batch of the board the pin belongs to
+ * @param handler handler invoked with the result once the batch has been executed
+ */
+void gpioOutputPin::setPinValue(bool const val, batch &b,
+		resultHandler const &handler) {
+
+	if (!isConfigured()) {
+		if (handler) handler(false);
+		return;
+	}
+
+	int const msgSize = 5;
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	unsigned char pinValue = val ? 0x01 : 0x00;
+	unsigned char msg[msgSize] = { CT_GPIO, DT_GPIO_WRITE, pinNumber, pinValue,
+			(unsigned char) (CT_GPIO + DT_GPIO_WRITE + pinNumber + pinValue) };
+	int const replySize = 4;
+	b.add(msg, msgSize, replySize,
+			boost::bind(&gpioOutputPin::onPinValueSet,
+					boost::static_pointer_cast<gpioOutputPin>(
+							shared_from_this()), val, handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief returns the descriptor tag of the write request, only boards using protocol v2 know the
+ * unacknowledged write
+ */
+unsigned char gpioOutputPin::selectWriteTag() const {
+	if (!m_isAcknowledged && m_serial->getProtocolVersion() == PROTOCOL_V2) {
+		return DT_GPIO_WRITE_NOACK;
+	}
+	return DT_GPIO_WRITE;
+}
+
+/**
+ * @brief evaluates the reply to a gpio write request
+ */
+bool gpioOutputPin::evaluateSetPinValue(unsigned char const *reply) {
+	if (reply[2] == GPIO_NOK) {
+		return false;
+	}
+
+	return true;
+}
+
+void gpioOutputPin::onPinValueSet(bool const val, resultHandler const &handler,
+		bool const ok, unsigned char const *reply, unsigned int const size) {
+	bool const success = ok && (size == 0 || evaluateSetPinValue(reply)); // unacknowledged without a reply
+	if (success) {
+		m_pinValue = val;
+	}
+	if (handler) {
+		handler(success);
+	}
+}
+
 } // end of namespace arduinoio
@@ -32,6 +32,7 @@
 
 #include "pin.h"
 #include "ioentity.h"
+#include <boost/atomic.hpp>
 
 namespace arduinoio {
 
@@ -54,12 +55,6 @@ public:
 	 */
 	virtual ~gpioOutputPin();
 
-	/**
-	 * @brief performs the requested configuration for the ioentity in question
-	 * @return true in case of success, false in case of failure
-	 */
-	virtual bool config();
-
 	/**
 	 * @brief returns the value of the pin
 	 * @return true = 1, false = 0
@@ -75,8 +70,50 @@ public:
 	 */
 	bool setPinValue(bool const val);
 
+	/**
+	 * @brief sets the value of the output pin without waiting for the reply
+	 * @param val true = 1, false = 0
+	 * @param handler handler invoked with the result once the reply has been received
+	 */
+	void setPinValue(bool const val, resultHandler const &handler);
+
+	/**
+	 * @brief appends the request setting the value of the output pin to a batch
+	 * @param val true = 1, false = 0
+	 * @param b batch of the board the pin belongs to
+	 * @param handler handler invoked with the result once the batch has been executed
+	 */
+	void setPinValue(bool const val, batch &b, resultHandler const &handler);
+
+	/**
+	 * @brief selects whether the board acknowledges the values set by setPinValue. Unacknowledged values
+	 * are reported as set once they have been transmitted, a board dropping them is detected with
+	 * ioboard::getErrorCounters. Boards using protocol v1 and batches always acknowledge the values.
+	 * @param isAcknowledged true = wait for the reply (default), false = do not expect a reply
+	 */
+	inline void setAcknowledged(bool const isAcknowledged) {
+		m_isAcknowledged = isAcknowledged;
+	}
+
+	/**
+	 * @brief takes over a value written to the pin by another request, e.g. ioboard::writeGpioPort
+	 * @param val true = 1, false = 0
+	 */
+	inline void takeWrittenValue(bool const val) {
+		m_pinValue = val;
+	}
+
+protected:
+	virtual unsigned int buildConfigRequest(unsigned char *msg) const;
+
 private:
-	bool m_pinValue;
+	boost::atomic<bool> m_pinValue;
+	boost::atomic<bool> m_isAcknowledged;
+
+	unsigned char selectWriteTag() const;
+	static bool evaluateSetPinValue(unsigned char const *reply);
+	void onPinValueSet(bool const val, resultHandler const &handler,
+			bool const ok, unsigned char const *reply, unsigned int const size);
 };
 
 } // end of namespace arduinoio
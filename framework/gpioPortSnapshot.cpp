@@ -0,0 +1,64 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "gpioPortSnapshot.h"
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor, no pin has been read
+ */
+gpioPortSnapshot::gpioPortSnapshot() :
+		m_inputs(0), m_values(0), m_rises(0), m_falls(0) {
+
+}
+
+/**
+ * @brief Constructor
+ * @param inputs configured input pins which have been read
+ * @param values current values of the pins
+ * @param rises pins with a rising edge since their last readout
+ * @param falls pins with a falling edge since their last readout
+ */
+gpioPortSnapshot::gpioPortSnapshot(unsigned int const inputs,
+		unsigned int const values, unsigned int const rises,
+		unsigned int const falls) :
+		m_inputs(inputs), m_values(values), m_rises(rises), m_falls(falls) {
+
+}
+
+unsigned int gpioPortSnapshot::getPinMask(E_PIN const p) {
+	if (p < D2) {
+		return 0;
+	}
+	return 1u << pin(p).getPinNumber();
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,114 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef GPIOPORTSNAPSHOT_H_
+#define GPIOPORTSNAPSHOT_H_
+
+#include "pin.h"
+
+namespace arduinoio {
+
+/**
+ * @brief mask of all gpio pins D2 to D13, bit per pin number
+ */
+static unsigned int const allGpioPins = 0x3FFC;
+
+/**
+ * @class gpioPortSnapshot
+ * @brief values and edges of the gpio input pins of a board read with one request, see
+ * ioboard::readGpioPort. The bitmaps hold a bit per pin number, e.g. bit 3 for D3.
+ */
+class gpioPortSnapshot {
+public:
+	/**
+	 * @brief Constructor, no pin has been read
+	 */
+	gpioPortSnapshot();
+
+	/**
+	 * @brief Constructor
+	 * @param inputs configured input pins which have been read
+	 * @param values current values of the pins
+	 * @param rises pins with a rising edge since their last readout
+	 * @param falls pins with a falling edge since their last readout
+	 */
+	gpioPortSnapshot(unsigned int const inputs, unsigned int const values,
+			unsigned int const rises, unsigned int const falls);
+
+	/**
+	 * @brief returns the bit of a digital pin in the bitmaps, 0 for the analog pins
+	 */
+	static unsigned int getPinMask(E_PIN const p);
+
+	inline unsigned int getInputs() const {
+		return m_inputs;
+	}
+
+	inline unsigned int getValues() const {
+		return m_values;
+	}
+
+	inline unsigned int getRises() const {
+		return m_rises;
+	}
+
+	inline unsigned int getFalls() const {
+		return m_falls;
+	}
+
+	/**
+	 * @brief returns true if the pin is a configured input pin which has been read
+	 */
+	inline bool isRead(E_PIN const p) const {
+		return (m_inputs & getPinMask(p)) != 0;
+	}
+
+	inline bool getValue(E_PIN const p) const {
+		return (m_values & getPinMask(p)) != 0;
+	}
+
+	inline bool getRise(E_PIN const p) const {
+		return (m_rises & getPinMask(p)) != 0;
+	}
+
+	inline bool getFall(E_PIN const p) const {
+		return (m_falls & getPinMask(p)) != 0;
+	}
+
+private:
+	unsigned int m_inputs;
+	unsigned int m_values;
+	unsigned int m_rises;
+	unsigned int m_falls;
+};
+
+} // end of namespace arduinoio
+
+#endif /* GPIOPORTSNAPSHOT_H_ */
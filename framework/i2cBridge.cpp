@@ -38,9 +38,11 @@ namespace arduinoio {
  * @brief Constructor
  * @param p pin number
  * @param baudRate Baudrate of the i2c bus
+ * @param maxWriteSize number of bytes the firmware writes with one request, see capabilities
  */
-i2cBridge::i2cBridge(boost::shared_ptr<serial> const &serial, unsigned int const baudRate) :
-	ioentity(serial), m_baudRate(baudRate) {
+i2cBridge::i2cBridge(boost::shared_ptr<serial> const &serial, unsigned int const baudRate,
+		unsigned int const maxWriteSize) :
+	ioentity(serial), m_baudRate(baudRate), m_maxWriteSize(maxWriteSize) {
 
 	m_pinVect.push_back(I2C_SDA_PIN);
 	m_pinVect.push_back(I2C_SCL_PIN);
@@ -54,42 +56,22 @@ i2cBridge::~i2cBridge() {
 }
 
 /**
- * @brief performs the requested configuration for the ioentity in question
- * @return true in case of success, false in case of failure
+ * @brief builds the request which configures the baud rate of the i2c bus
+ * @param msg buffer receiving the request
+ * @return number of bytes of the request
  */
-bool i2cBridge::config() {
-
-	// send request string
-	int const msgSize = 4;
+unsigned int i2cBridge::buildConfigRequest(unsigned char *msg) const {
 	unsigned char baudRate = 0x00;
 	if (m_baudRate == i2cBaudRate100k)
 		baudRate = 0x00;
 	else if (m_baudRate == i2cBaudRate400k)
 		baudRate = 0x01;
-	unsigned char msg[msgSize] = { CT_I2C, DT_I2C_CONFIG, baudRate, CT_I2C
-			+ DT_I2C_CONFIG + baudRate };
-	m_serial->writeToSerial(msg, msgSize);
-
-	// retrieve answer and evaluate it
-	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(replySize);
-	if (reply.get()[0] != CT_I2C || reply.get()[1] != DT_I2C_CONFIG) {
-		std::cerr << __FILE__ << ":" << __LINE__
-				<< " Error in reply i2c config read message." << std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == I2C_NOK) {
-		return false;
-	}
-
-	setIsConfiguredFlag();
 
-	return true;
+	msg[0] = CT_I2C;
+	msg[1] = DT_I2C_CONFIG;
+	msg[2] = baudRate;
+	msg[3] = CT_I2C + DT_I2C_CONFIG + baudRate;
+	return 4;
 }
 
 /**
@@ -109,28 +91,20 @@ bool i2cBridge::read(unsigned char const adr, unsigned char const offset,
 	int const msgSize = 6;
 	unsigned char msg[msgSize] = { CT_I2C, DT_I2C_READ, adr, offset, length,
 			CT_I2C + DT_I2C_READ + adr + offset + length };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 4 + length;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(replySize);
-	if (reply.get()[0] != CT_I2C || reply.get()[1] != DT_I2C_READ) {
-		std::cerr << __FILE__ << ":" << __LINE__
-				<< " Error in reply i2c read read message." << std::endl;
+	unsigned char reply[maxFrameSize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == I2C_NOK) {
+	if (reply[2] == I2C_NOK) {
 		return false;
 	}
 
 	// copy data
 	for (unsigned int i = 0; i < length; i++) {
-		data[i] = reply.get()[i + 3];
+		data[i] = reply[i + 3];
 	}
 
 	return true;
@@ -149,7 +123,7 @@ bool i2cBridge::write(unsigned char const adr, unsigned char const offset,
 
 	if(!isConfigured()) return false;
 
-	if (length < 1 || length > 8)
+	if (length < 1 || length > m_maxWriteSize)
 		return false;
 
 	// send request string
@@ -167,22 +141,14 @@ bool i2cBridge::write(unsigned char const adr, unsigned char const offset,
 	for (unsigned int i = 0; i < (unsigned int) (msgSize - 1); i++) {
 		msg[msgSize - 1] += msg[i];
 	}
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(replySize);
-	if (reply.get()[0] != CT_I2C || reply.get()[1] != DT_I2C_WRITE) {
-		std::cerr << __FILE__ << ":" << __LINE__
-				<< " Error in reply i2c write message." << std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (reply.get()[2] == I2C_NOK) {
+	if (reply[2] == I2C_NOK) {
 		return false;
 	}
 
@@ -48,20 +48,16 @@ public:
 	 * @brief Constructor
 	 * @param p pin number
 	 * @param baudRate Baudrate of the i2c bus
+	 * @param maxWriteSize number of bytes the firmware writes with one request, see capabilities
 	 */
-	i2cBridge(boost::shared_ptr<serial> const &serial, unsigned int const baudRate);
+	i2cBridge(boost::shared_ptr<serial> const &serial, unsigned int const baudRate,
+			unsigned int const maxWriteSize = 8);
 
 	/**
 	 * @brief Destructor
 	 */
 	virtual ~i2cBridge();
 
-	/**
-	 * @brief performs the requested configuration for the ioentity in question
-	 * @return true in case of success, false in case of failure
-	 */
-	virtual bool config();
-
 	/**
 	 * @brief reads from the i2c slave with the address adr from the reg offset length bytes
 	 * @param adr address of the slave to read from
@@ -84,8 +80,12 @@ public:
 	bool write(unsigned char const adr, unsigned char const offset,
 			unsigned char const *data, unsigned char const length);
 
+protected:
+	virtual unsigned int buildConfigRequest(unsigned char *msg) const;
+
 private:
 	unsigned int m_baudRate;
+	unsigned int m_maxWriteSize;
 };
 
 } // end of namespace arduinoio
@@ -34,35 +34,436 @@
 #include <stdio.h>
 #include <vector>
 #include <unistd.h>
+#include <boost/bind/bind.hpp>
+#include <boost/chrono.hpp>
 #include "ioentity_factory.h"
 
 namespace arduinoio {
 
+/**
+ * @brief baud rate of the firmware after a reset
+ */
+static unsigned int const defaultBaudRate = 230400;
+
+/**
+ * @brief time in ms the firmware waits for the confirmation of a new baud rate
+ */
+static unsigned int const baudRateConfirmTime_ms = 500;
+
+/**
+ * @brief number of confirmations of a new baud rate sent before the host returns to the previous rate
+ */
+static unsigned int const baudRateConfirmAttempts = 3;
+
+/**
+ * @brief time in ms the firmware may take to answer after the device has been opened or the board has been
+ * reset, it covers the bootloader and the watchdog timeout
+ */
+static unsigned int const startupTimeout_ms = 3000;
+
+/**
+ * @brief deadline in ms for the reply to a single readiness probe
+ */
+static unsigned int const probeTimeout_ms = 50;
+
+/**
+ * @brief period in ms at which the link to the board is checked
+ */
+static unsigned int const supervisionPeriod_ms = 100;
+
 /**
  * @brief Constructor
  * @param devNode string designating the used device node for communication
+ * @param lowLatency configures the serial port for minimal latency, see serialPortTransport
  */
-ioboard::ioboard(std::string const &devNode, unsigned int const baudRate) {
+ioboard::ioboard(std::string const &devNode, unsigned int const baudRate,
+		bool const lowLatency) :
+		m_initialBaudRate(baudRate), m_baudRate(baudRate) {
 
-	m_serial = boost::shared_ptr<serial>(new serial(devNode, baudRate));
+	m_serial = boost::shared_ptr<serial>(
+			new serial(
+					transport_factory::createSerialPort(devNode, baudRate,
+							lowLatency)));
+	m_serial->startIoThread();
 
-	sleep(1); // delay one second to allow serial device to be fully initialized
+	init();
+}
 
-	if (!reset()) {
-		std::cerr << __FILE__ << ":" << __LINE__
-		<< " Error, couldnt reset board at startup." << std::endl;
-	}
+/**
+ * @brief Constructor
+ * @param devNode string designating the used device node for communication
+ * @param io_service io service shared with other boards, it has to be run by threads of the application
+ * already during the construction
+ * @param lowLatency configures the serial port for minimal latency, see serialPortTransport
+ */
+ioboard::ioboard(std::string const &devNode,
+		boost::asio::io_service &io_service, unsigned int const baudRate,
+		bool const lowLatency) :
+		m_initialBaudRate(baudRate), m_baudRate(baudRate) {
+
+	m_serial = boost::shared_ptr<serial>(
+			new serial(
+					transport_factory::createSerialPort(devNode, baudRate,
+							lowLatency), &io_service));
+
+	init();
+}
+
+/**
+ * @brief Constructor
+ * @param t transport used for the communication with the io board, see transport_factory
+ */
+ioboard::ioboard(boost::shared_ptr<transport> const &t) :
+		m_initialBaudRate(defaultBaudRate), m_baudRate(defaultBaudRate) {
+
+	m_serial = boost::shared_ptr<serial>(new serial(t));
+	m_serial->startIoThread();
+
+	init();
+}
+
+/**
+ * @brief Constructor
+ * @param t transport used for the communication with the io board, see transport_factory
+ * @param io_service io service shared with other boards, it has to be run by threads of the application
+ * already during the construction
+ */
+ioboard::ioboard(boost::shared_ptr<transport> const &t,
+		boost::asio::io_service &io_service) :
+		m_initialBaudRate(defaultBaudRate), m_baudRate(defaultBaudRate) {
 
+	m_serial = boost::shared_ptr<serial>(new serial(t, &io_service));
+
+	init();
 }
 
 /**
  * @brief Destructor
  */
 ioboard::~ioboard() {
+	stopSupervision();
+	m_serial->stopIoThread(); // the io entities may outlive the board, they use the calling threads then
 	m_pinVect.clear();
 }
 
+/**
+ * @brief brings the board into a defined state after the transport has been opened
+ */
+void ioboard::init() {
+	if (!waitUntilReady(true) || !reset()) {
+		std::cerr << __FILE__ << ":" << __LINE__
+		<< " Error, couldnt reset board at startup." << std::endl;
+	}
+
+	m_isRestoring = false;
+	m_supervisedTimeoutCount = m_serial->getTimeoutCount();
+	m_supervisionTimer.reset(
+			new boost::asio::steady_timer(m_serial->getIoService()));
+
+	boost::mutex::scoped_lock lock(m_supervisionMutex);
+	m_isSupervising = true;
+	m_isSupervisionActive = true;
+	armSupervisionTimer();
+}
+
+/**
+ * @brief schedules the next check of the link, the supervision mutex must be held
+ */
+void ioboard::armSupervisionTimer() {
+	m_supervisionTimer->expires_after(
+			boost::asio::chrono::milliseconds(supervisionPeriod_ms));
+	m_supervisionTimer->async_wait(
+			boost::bind(&ioboard::onSupervisionTimer, this,
+					boost::asio::placeholders::error));
+}
+
+/**
+ * @brief checks the link on the io service, the recovery waits for replies and runs on a thread of its
+ * own, so it blocks neither the io service nor the other boards sharing it
+ */
+void ioboard::onSupervisionTimer(boost::system::error_code const &error) {
+	boost::mutex::scoped_lock lock(m_supervisionMutex);
+	if (error == boost::asio::error::operation_aborted || !m_isSupervising) {
+		m_isSupervisionActive = false;
+		m_supervisionStopped.notify_all();
+		return;
+	}
+
+	// a restart of the board shows as timeouts while it waits for the watchdog
+	if (m_serial->isLinkLost() || m_isRestoring
+			|| m_serial->getTimeoutCount() != m_supervisedTimeoutCount) {
+		if (m_recoveryThread) {
+			m_recoveryThread->join(); // it has rearmed the timer as its last step
+		}
+		m_recoveryThread.reset(
+				new boost::thread(boost::bind(&ioboard::recover, this)));
+		return;
+	}
+
+	armSupervisionTimer();
+}
+
+/**
+ * @brief reopens the device after the link has been lost and configures the io entities again after the
+ * board has restarted, e.g. after its watchdog has reset it. Rearms the supervision timer afterwards.
+ */
+void ioboard::recover() {
+	{
+		boost::mutex::scoped_lock lock(m_linkMutex);
+
+		bool isConnected = true;
+		if (m_serial->isLinkLost()) {
+			if (!m_isRestoring) {
+				std::cerr << __FILE__ << ":" << __LINE__
+						<< " Error, lost the link to the board, reconnecting."
+						<< std::endl;
+				invalidateEntities();
+				m_isRestoring = true;
+			}
+			isConnected = m_serial->reconnect(); // the device may not have returned yet
+		}
+
+		if (isConnected && !m_isRestoring
+				&& m_serial->getTimeoutCount() != m_supervisedTimeoutCount) {
+			unsigned long const newTimeoutCount = m_serial->getTimeoutCount();
+			bool hasRestarted = false;
+			bool isQueried = queryRestart(hasRestarted);
+			if (!isQueried
+					&& m_serial->getProtocolVersion() == PROTOCOL_V2) {
+				// the board has restarted with protocol v1 unless it does not answer at all
+				m_serial->setProtocolVersion(PROTOCOL_V1);
+				isQueried = queryRestart(hasRestarted);
+				if (!isQueried) {
+					m_serial->setProtocolVersion(PROTOCOL_V2);
+				}
+			}
+			if (isQueried) {
+				m_supervisedTimeoutCount = newTimeoutCount;
+				if (hasRestarted) {
+					invalidateEntities();
+					m_isRestoring = true;
+				}
+			}
+		}
+
+		if (isConnected && m_isRestoring && restoreEntities()) {
+			m_isRestoring = false;
+			m_supervisedTimeoutCount = m_serial->getTimeoutCount();
+		}
+	}
+
+	boost::mutex::scoped_lock lock(m_supervisionMutex);
+	if (m_isSupervising) {
+		armSupervisionTimer();
+	} else {
+		m_isSupervisionActive = false;
+		m_supervisionStopped.notify_all();
+	}
+}
+
+/**
+ * @brief stops reconnecting and restoring the io entities, a board sharing an io service calls it before
+ * the io service is stopped
+ */
+void ioboard::stopSupervision() {
+	boost::mutex::scoped_lock lock(m_supervisionMutex);
+	if (!m_supervisionTimer) {
+		return;
+	}
+
+	// a recovery in progress is completed, a stopped io service does not invoke the timer handler anymore
+	m_isSupervising = false;
+	m_supervisionTimer->cancel();
+	while (m_isSupervisionActive && !m_serial->getIoService().stopped()) {
+		m_supervisionStopped.wait_for(lock,
+				boost::chrono::milliseconds(supervisionPeriod_ms));
+	}
+	lock.unlock();
+
+	if (m_recoveryThread) {
+		m_recoveryThread->join();
+		m_recoveryThread.reset();
+	}
+}
+
+/**
+ * @brief asks the board whether it has started since the last query
+ * @param hasRestarted true if the board has started, e.g. after a reset by its watchdog
+ * @return true if successful, false otherwise
+ */
+bool ioboard::queryRestart(bool &hasRestarted) {
+	int const msgSize = 3;
+	unsigned char const msg[msgSize] = { CT_MISC, DT_MISC_RESTARTED, CT_MISC
+			+ DT_MISC_RESTARTED };
+
+	int const replySize = 5;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize, probeTimeout_ms)) {
+		return false;
+	}
+	if (reply[2] == MISC_NOK) {
+		return false;
+	}
+
+	hasRestarted = (reply[3] != 0);
+	return true;
+}
+
+/**
+ * @brief switches the board and the host to protocol v2, boards with an older firmware do not answer
+ * the request and keep protocol v1
+ * @return true if protocol v2 is used from now on, false otherwise
+ */
+bool ioboard::negotiateProtocol() {
+	int const msgSize = 4;
+	unsigned char const msg[msgSize] = { CT_MISC, DT_MISC_PROTOCOL,
+			PROTOCOL_V2, CT_MISC + DT_MISC_PROTOCOL + PROTOCOL_V2 };
+
+	// the serial switches to the new framing as soon as it has received the reply
+	int const replySize = 5;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize, probeTimeout_ms)) {
+		return false;
+	}
+
+	return reply[2] != MISC_NOK && reply[3] == PROTOCOL_V2;
+}
+
+/**
+ * @brief retrieves the limits and features of the firmware and adapts the serial to them. Only the
+ * firmware introducing protocol v2 knows the request, an older one would wait for further bytes,
+ * so its capabilities are assumed instead.
+ * @return true if the firmware reported its capabilities, false otherwise
+ */
+bool ioboard::queryCapabilities() {
+	m_capabilities = capabilities();
+
+	bool ok = false;
+	if (m_serial->getProtocolVersion() == PROTOCOL_V2) {
+		int const msgSize = 3;
+		unsigned char const msg[msgSize] = { CT_MISC, DT_MISC_CAPABILITIES,
+				CT_MISC + DT_MISC_CAPABILITIES };
+
+		int const replySize = 4 + capabilityRecordSize;
+		unsigned char reply[replySize];
+		if (m_serial->transfer(msg, msgSize, reply, replySize, probeTimeout_ms)
+				&& reply[2] != MISC_NOK) {
+			capabilities reported;
+			ok = reported.parse(reply + 3);
+			if (ok) {
+				m_capabilities = reported;
+			}
+		}
+		if (!ok) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error, could not retrieve the capabilities of the board."
+					<< std::endl;
+		}
+	}
+
+	m_serial->setFirmwareBufferSizes(m_capabilities.getRxBufferSize(),
+			m_capabilities.getTxBufferSize());
+	return ok;
+}
+
+void ioboard::addEntity(boost::shared_ptr<ioentity> const &ioent) {
+	boost::mutex::scoped_lock lock(m_entityMutex);
+	m_entities.push_back(ioent);
+}
+
+/**
+ * @brief marks all live io entities as not configured, their requests fail until they are restored
+ */
+void ioboard::invalidateEntities() {
+	boost::mutex::scoped_lock lock(m_entityMutex);
+	for (unsigned int i = 0; i < m_entities.size(); i++) {
+		boost::shared_ptr<ioentity> ioent = m_entities[i].lock();
+		if (ioent) {
+			ioent->clearIsConfiguredFlag();
+		}
+	}
+}
+
+/**
+ * @brief configures all live io entities again once the board answers, all configuration requests are
+ * transmitted with one write
+ * @return true if all io entities have been configured, false otherwise
+ */
+bool ioboard::restoreEntities() {
+	// the board has restarted with its initial baud rate
+	if (m_baudRate != m_initialBaudRate) {
+		m_baudRate = m_initialBaudRate;
+		if (!m_serial->setBaudRate(m_baudRate)) {
+			return false;
+		}
+	}
+	if (!waitUntilReady(true)) {
+		return false;
+	}
+	if (m_serial->getProtocolVersion() == PROTOCOL_V1) {
+		negotiateProtocol();
+	}
+	queryCapabilities();
+	bool hasRestarted = false;
+	queryRestart(hasRestarted); // the restart has been handled
+
+	std::vector<boost::shared_ptr<ioentity> > entities;
+	{
+		boost::mutex::scoped_lock lock(m_entityMutex);
+		std::vector<boost::weak_ptr<ioentity> > liveEntities;
+		for (unsigned int i = 0; i < m_entities.size(); i++) {
+			boost::shared_ptr<ioentity> ioent = m_entities[i].lock();
+			if (ioent) {
+				entities.push_back(ioent);
+				liveEntities.push_back(ioent);
+			}
+		}
+		m_entities.swap(liveEntities);
+	}
+
+	// only the restore requests are awaited, not the requests of the application in flight
+	restoreProgress progress;
+	progress.numPending = entities.size();
+	progress.numFailed = 0;
+	m_serial->holdWrites();
+	for (unsigned int i = 0; i < entities.size(); i++) {
+		entities[i]->restore(
+				boost::bind(&ioboard::onEntityRestored, &progress,
+						boost::placeholders::_1));
+	}
+	m_serial->flush();
+
+	boost::mutex::scoped_lock lock(progress.mutex);
+	while (progress.numPending > 0) {
+		progress.done.wait(lock);
+	}
+
+	if (progress.numFailed > 0) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, could not restore "
+				<< progress.numFailed << " io entities." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ioboard::onEntityRestored(restoreProgress *pProgress, bool const ok) {
+	boost::mutex::scoped_lock lock(pProgress->mutex);
+	if (!ok) {
+		pProgress->numFailed++;
+	}
+	pProgress->numPending--;
+	if (pProgress->numPending == 0) {
+		pProgress->done.notify_all();
+	}
+}
+
 boost::shared_ptr<analogPin> ioboard::createAnalogPin(E_PIN const p) {
+	if (!m_capabilities.isAnalogPin(p)) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, the board has no analog pin "
+				<< p << "." << std::endl;
+		return boost::shared_ptr<analogPin>();
+	}
+
 	boost::shared_ptr<analogPin> ioent = ioentity_factory::createAnalogPin(
 			m_serial, p);
 
@@ -70,6 +471,7 @@ boost::shared_ptr<analogPin> ioboard::createAnalogPin(E_PIN const p) {
 		if (!ioent->config()) {
 			std::cerr << "Error, could not configure analog pin." << std::endl;
 		}
+		addEntity(ioent);
 	} else {
 		ioent.reset();
 	}
@@ -79,6 +481,12 @@ boost::shared_ptr<analogPin> ioboard::createAnalogPin(E_PIN const p) {
 
 boost::shared_ptr<servo> ioboard::createServoPin(E_PIN const p,
 		unsigned int const pulseWidth_us) {
+	if (!m_capabilities.isServoPin(p)) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, the board has no servo pin "
+				<< p << "." << std::endl;
+		return boost::shared_ptr<servo>();
+	}
+
 	boost::shared_ptr<servo> ioent = ioentity_factory::createServoPin(m_serial,
 			p, pulseWidth_us);
 
@@ -86,6 +494,7 @@ boost::shared_ptr<servo> ioboard::createServoPin(E_PIN const p,
 		if (!ioent->config()) {
 			std::cerr << "Error, could not configure servo pin." << std::endl;
 		}
+		addEntity(ioent);
 	} else {
 		ioent.reset();
 	}
@@ -94,14 +503,21 @@ boost::shared_ptr<servo> ioboard::createServoPin(E_PIN const p,
 }
 boost::shared_ptr<i2cBridge> ioboard::createI2CBridge(
 		unsigned int const baudRate) {
+	if (!m_capabilities.hasClass(CT_I2C)) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, the board has no i2c bridge."
+				<< std::endl;
+		return boost::shared_ptr<i2cBridge>();
+	}
+
 	boost::shared_ptr<i2cBridge> ioent = ioentity_factory::createI2CBridge(
-			m_serial, baudRate);
+			m_serial, baudRate, m_capabilities.getI2cMaxWriteSize());
 
 	if (!isPinInVect(I2C_SDA_PIN) && !isPinInVect(I2C_SCL_PIN)) {
 		if (!ioent->config()) {
 			std::cerr << "Error, could not configure I2C Bridge."
 					<< std::endl;
 		}
+		addEntity(ioent);
 	} else {
 		ioent.reset();
 	}
@@ -111,6 +527,12 @@ boost::shared_ptr<i2cBridge> ioboard::createI2CBridge(
 
 boost::shared_ptr<gpioInputPin> ioboard::createGpioInputPin(E_PIN const p,
 		bool const pullUpEnabled) {
+	if (!m_capabilities.isGpioPin(p)) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, the board has no gpio pin "
+				<< p << "." << std::endl;
+		return boost::shared_ptr<gpioInputPin>();
+	}
+
 	boost::shared_ptr<gpioInputPin> ioent =
 			ioentity_factory::createGpioInputPin(m_serial, p, pullUpEnabled);
 
@@ -119,6 +541,7 @@ boost::shared_ptr<gpioInputPin> ioboard::createGpioInputPin(E_PIN const p,
 			std::cerr << "Error, could not configure gpio input pin."
 					<< std::endl;
 		}
+		addEntity(ioent);
 	} else {
 		ioent.reset();
 	}
@@ -128,6 +551,12 @@ boost::shared_ptr<gpioInputPin> ioboard::createGpioInputPin(E_PIN const p,
 
 boost::shared_ptr<gpioOutputPin> ioboard::createGpioOutputPin(E_PIN const p,
 		bool const pinValue) {
+	if (!m_capabilities.isGpioPin(p)) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, the board has no gpio pin "
+				<< p << "." << std::endl;
+		return boost::shared_ptr<gpioOutputPin>();
+	}
+
 	boost::shared_ptr<gpioOutputPin> ioent =
 			ioentity_factory::createGpioOutputPin(m_serial, p, pinValue);
 
@@ -136,6 +565,7 @@ boost::shared_ptr<gpioOutputPin> ioboard::createGpioOutputPin(E_PIN const p,
 			std::cerr << "Error, could not configure gpio output pin."
 					<< std::endl;
 		}
+		addEntity(ioent);
 	} else {
 		ioent.reset();
 	}
@@ -145,6 +575,12 @@ boost::shared_ptr<gpioOutputPin> ioboard::createGpioOutputPin(E_PIN const p,
 
 boost::shared_ptr<counterPin> ioboard::createCounterPin(E_PIN const p,
 		E_COUNTER_OPTIONS const opt) {
+	if (!m_capabilities.isCounterPin(p)) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, the board has no counter pin "
+				<< p << "." << std::endl;
+		return boost::shared_ptr<counterPin>();
+	}
+
 	boost::shared_ptr<counterPin> ioent =
 			ioentity_factory::createCounterPin(m_serial, p, opt);
 
@@ -153,6 +589,7 @@ boost::shared_ptr<counterPin> ioboard::createCounterPin(E_PIN const p,
 			std::cerr << "Error, could not configure counter pin."
 					<< std::endl;
 		}
+		addEntity(ioent);
 	} else {
 		ioent.reset();
 	}
@@ -161,42 +598,101 @@ boost::shared_ptr<counterPin> ioboard::createCounterPin(E_PIN const p,
 
 }
 
+/**
+ * @brief creates an empty batch, the requests of the io entities of this board appended to it are
+ * executed with one round trip, e.g. all inputs and outputs of a control cycle
+ */
+boost::shared_ptr<batch> ioboard::createBatch() {
+	return boost::shared_ptr<batch>(
+			new batch(m_serial, m_capabilities.getBatchMaxRequestSize(),
+					m_capabilities.getBatchMaxReplySize()));
+}
+
 /**
  * @brief resets the ioboard
  * @return true if successful, false otherwise
  */
 bool ioboard::reset() {
+	boost::mutex::scoped_lock lock(m_linkMutex);
+
 	// send request string
 	int const msgSize = 3;
 	unsigned char msg[msgSize] = { CT_MISC, DT_MISC_RESET, CT_MISC
 			+ DT_MISC_RESET };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
-	if (reply.get()[0] != CT_MISC || reply.get()[1] != DT_MISC_RESET) {
-		std::cerr << __FILE__ << ":" << __LINE__
-		<< " Error in request reply message." << std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
+	if (reply[2] == MISC_NOK) {
 		return false;
 	}
-	if (reply.get()[2] == MISC_NOK) {
-		return false;
+
+	if (m_baudRate != m_initialBaudRate) {
+		// the uart of the board restarts with its initial rate
+		m_baudRate = m_initialBaudRate;
+		if (!m_serial->setBaudRate(m_baudRate)) {
+			return false;
+		}
 	}
+	m_serial->setProtocolVersion(PROTOCOL_V1); // and so does the parser
 
-	sleep(1); // sleep 1 second to enable io board to perform a full reset
+	if (!waitUntilReady(false)) {
+		return false;
+	}
+	negotiateProtocol();
+	queryCapabilities();
+	bool hasRestarted = false;
+	queryRestart(hasRestarted); // the restart is intended
 
+	// the io entities created so far are not configured anymore and are not restored
+	invalidateEntities();
+	{
+		boost::mutex::scoped_lock lock(m_entityMutex);
+		m_entities.clear();
+	}
 	m_pinVect.clear(); // now we can start reassigning functionality
 
 	return true;
 }
 
+/**
+ * @brief probes the board with id requests until the firmware answers, the requests get lost or are
+ * discarded while the bootloader runs or the board waits for the watchdog
+ * @param isAlternating the board may still use protocol v2, e.g. it has not restarted when the device
+ * was reopened, so the probes alternate between both framings
+ * @return true if the firmware answered within the startup timeout, false otherwise
+ */
+bool ioboard::waitUntilReady(bool const isAlternating) {
+	int const msgSize = 3;
+	unsigned char const msg[msgSize] = { CT_MISC, DT_MISC_ID, CT_MISC
+			+ DT_MISC_ID };
+	int const replySize = 6;
+	unsigned char reply[replySize];
+
+	boost::asio::steady_timer::clock_type::time_point const deadline =
+			boost::asio::steady_timer::clock_type::now()
+					+ boost::asio::chrono::milliseconds(startupTimeout_ms);
+	do {
+		if (m_serial->transfer(msg, msgSize, reply, replySize, probeTimeout_ms)
+				&& reply[2] != MISC_NOK) {
+			return true;
+		}
+		if (isAlternating) {
+			m_serial->setProtocolVersion(
+					(m_serial->getProtocolVersion() == PROTOCOL_V2) ?
+							PROTOCOL_V1 : PROTOCOL_V2);
+		}
+	} while (boost::asio::steady_timer::clock_type::now() < deadline);
+
+	std::cerr << __FILE__ << ":" << __LINE__
+			<< " Error, the board did not answer within " << startupTimeout_ms
+			<< " ms." << std::endl;
+	return false;
+}
+
 /**
  * @brief retrieves the id from the io board
  * @param id read from the board
@@ -206,28 +702,19 @@ bool ioboard::getId(unsigned int &id) {
 	// send request string
 	int const msgSize = 3;
 	unsigned char msg[msgSize] = { CT_MISC, DT_MISC_ID, CT_MISC + DT_MISC_ID };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 6;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
-	if (reply.get()[0] != CT_MISC || reply.get()[1] != DT_MISC_ID) {
-		std::cerr << __FILE__ << ":" << __LINE__
-		<< " Error in request reply message." << std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == MISC_NOK) {
+	if (reply[2] == MISC_NOK) {
 		return false;
 	}
 
 	// write id into the the result variable
-	unsigned char const tmp[2] = { reply.get()[4], reply.get()[3] };
+	unsigned char const tmp[2] = { reply[4], reply[3] };
 	memcpy(&id, tmp, 2);
 
 	return true;
@@ -243,29 +730,20 @@ bool ioboard::getTemperature(float &temp) {
 	int const msgSize = 3;
 	unsigned char msg[msgSize] =
 			{ CT_MISC, DT_MISC_TEMP, CT_MISC + DT_MISC_TEMP };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 6;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
-	if (reply.get()[0] != CT_MISC || reply.get()[1] != DT_MISC_TEMP) {
-		std::cerr << __FILE__ << ":" << __LINE__
-		<< " Error in request reply message." << std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (reply.get()[2] == MISC_NOK) {
+	if (reply[2] == MISC_NOK) {
 		return false;
 	}
 
 	// write id into the the result variable
 	unsigned int tmp = 0;
-	unsigned char const tmpArray[2] = { reply.get()[4], reply.get()[3] };
+	unsigned char const tmpArray[2] = { reply[4], reply[3] };
 	memcpy(&tmp, tmpArray, 2);
 	// voltage measured at the adc pin
 	float resVoltage = ((float) (tmp)) * (1.1 / 1024.0);
@@ -277,6 +755,163 @@ bool ioboard::getTemperature(float &temp) {
 	return true;
 }
 
+/**
+ * @brief reads the values and edges of the gpio input pins selected by a mask with one request
+ * @return true if successful, false otherwise
+ */
+bool ioboard::readGpioPort(unsigned int const mask, gpioPortSnapshot &snapshot) {
+	if (m_serial->getProtocolVersion() != PROTOCOL_V2) {
+		return false; // an older firmware does not know the port requests
+	}
+
+	// send request string
+	int const msgSize = 5;
+	unsigned char const maskLow = (unsigned char) (mask & 0xFF);
+	unsigned char const maskHigh = (unsigned char) ((mask >> 8) & 0xFF);
+	unsigned char msg[msgSize] = { CT_GPIO, DT_GPIO_READ_PORT, maskLow, maskHigh,
+			(unsigned char) (CT_GPIO + DT_GPIO_READ_PORT + maskLow + maskHigh) };
+
+	// retrieve answer and evaluate it
+	int const replySize = 12;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+		return false;
+	}
+	if (reply[2] == GPIO_NOK) {
+		return false;
+	}
+
+	snapshot = gpioPortSnapshot(reply[3] | (reply[4] << 8),
+			reply[5] | (reply[6] << 8), reply[7] | (reply[8] << 8),
+			reply[9] | (reply[10] << 8));
+
+	return true;
+}
+
+/**
+ * @brief writes the values of the gpio output pins selected by a mask with one request
+ * @return true if all selected pins have been written, false otherwise
+ */
+bool ioboard::writeGpioPort(unsigned int const mask, unsigned int const values) {
+	if (m_serial->getProtocolVersion() != PROTOCOL_V2) {
+		return false; // an older firmware does not know the port requests
+	}
+
+	// send request string
+	int const msgSize = 7;
+	unsigned char const maskLow = (unsigned char) (mask & 0xFF);
+	unsigned char const maskHigh = (unsigned char) ((mask >> 8) & 0xFF);
+	unsigned char const valuesLow = (unsigned char) (values & 0xFF);
+	unsigned char const valuesHigh = (unsigned char) ((values >> 8) & 0xFF);
+	unsigned char msg[msgSize] = { CT_GPIO, DT_GPIO_WRITE_PORT, maskLow,
+			maskHigh, valuesLow, valuesHigh, (unsigned char) (CT_GPIO
+					+ DT_GPIO_WRITE_PORT + maskLow + maskHigh + valuesLow
+					+ valuesHigh) };
+
+	// retrieve answer and evaluate it
+	int const replySize = 6;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+		return false;
+	}
+	if (reply[2] == GPIO_NOK) {
+		return false;
+	}
+
+	// the output pins keep the written values, e.g. for their restore after a restart
+	unsigned int const written = reply[3] | (reply[4] << 8);
+	{
+		boost::mutex::scoped_lock lock(m_entityMutex);
+		for (unsigned int i = 0; i < m_entities.size(); i++) {
+			boost::shared_ptr<gpioOutputPin> outputPin =
+					boost::dynamic_pointer_cast<gpioOutputPin>(
+							m_entities[i].lock());
+			if (!outputPin) {
+				continue;
+			}
+			unsigned int const pinMask = gpioPortSnapshot::getPinMask(
+					outputPin->getPinVect()->at(0).getPin());
+			if (written & pinMask) {
+				outputPin->takeWrittenValue((values & pinMask) != 0);
+			}
+		}
+	}
+
+	return (written & mask) == (mask & allGpioPins);
+}
+
+/**
+ * @brief reads the edges recorded by the board since the last readout
+ * @return true if successful, false otherwise
+ */
+bool ioboard::readGpioEdges(std::vector<gpioEdge> &edges,
+		unsigned int &lostEdges) {
+	edges.clear();
+	if (m_serial->getProtocolVersion() != PROTOCOL_V2) {
+		return false; // an older firmware does not record edges
+	}
+
+	int const msgSize = 3;
+	unsigned char const msg[msgSize] = { CT_GPIO, DT_GPIO_READ_EDGES,
+			CT_GPIO + DT_GPIO_READ_EDGES };
+	int const replySize = 7 + GPIO_EDGE_RECORDS * GPIO_EDGE_RECORD_SIZE;
+	unsigned char reply[replySize];
+
+	// the replies have a fixed size, a full one is followed by another request until one queue of the
+	// board has been drained, a pin changing faster than the host reads cannot keep the caller here
+	unsigned int count = GPIO_EDGE_RECORDS;
+	for (unsigned int round = 0; count == GPIO_EDGE_RECORDS
+			&& round < GPIO_EDGE_QUEUE_SIZE / GPIO_EDGE_RECORDS; round++) {
+		if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+			return false;
+		}
+		if (reply[2] == GPIO_NOK || reply[5] > GPIO_EDGE_RECORDS) {
+			return false;
+		}
+
+		lostEdges = reply[3] | (reply[4] << 8);
+		count = reply[5];
+		for (unsigned int i = 0; i < count; i++) {
+			edges.push_back(
+					gpioEdge::fromRecord(&reply[6 + i * GPIO_EDGE_RECORD_SIZE]));
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief retrieves the cumulative error counters of the board
+ * @return true if successful, false otherwise
+ */
+bool ioboard::getErrorCounters(unsigned int &droppedFrames,
+		unsigned int &failedRequests, unsigned int &executedRequests) {
+	if (m_serial->getProtocolVersion() != PROTOCOL_V2) {
+		return false; // the counters belong to the unacknowledged requests of protocol v2
+	}
+
+	// send request string
+	int const msgSize = 3;
+	unsigned char msg[msgSize] = { CT_MISC, DT_MISC_ERRORS, CT_MISC
+			+ DT_MISC_ERRORS };
+
+	// retrieve answer and evaluate it
+	int const replySize = 10;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+		return false;
+	}
+	if (reply[2] == MISC_NOK) {
+		return false;
+	}
+
+	droppedFrames = reply[3] | (reply[4] << 8);
+	failedRequests = reply[5] | (reply[6] << 8);
+	executedRequests = reply[7] | (reply[8] << 8);
+
+	return true;
+}
+
 /**
  * @brief reads the analog value of all 6 analog input pins at once
  * @param ax voltage of ax, x = 0 to 5
@@ -289,64 +924,55 @@ bool ioboard::getAllAnalog(float &a0, float &a1, float &a2, float &a3,
 	int const msgSize = 3;
 	unsigned char msg[msgSize] = { CT_ANALOG, DT_ANALOG_READ_ALL, CT_ANALOG
 			+ DT_ANALOG_READ_ALL };
-	m_serial->writeToSerial(msg, msgSize);
 
 	// retrieve answer and evaluate it
 	int const replySize = 16;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
-	if (reply.get()[0] != CT_ANALOG || reply.get()[1] != DT_ANALOG_READ_ALL) {
-		std::cerr << __FILE__ << ":" << __LINE__
-		<< " Error in request reply message." << std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (reply.get()[2] == ANALOG_NOK) {
+	if (reply[2] == ANALOG_NOK) {
 		return false;
 	}
 
 	{
 		unsigned int tmp = 0;
-		unsigned char const tmpArray[2] = { reply.get()[4], reply.get()[3] };
+		unsigned char const tmpArray[2] = { reply[4], reply[3] };
 		memcpy(&tmp, tmpArray, 2);
 		a0 = ((float) (tmp)) * lsb;
 	}
 
 	{
 		unsigned tmp = 0;
-		unsigned char const tmpArray[2] = { reply.get()[6], reply.get()[5] };
+		unsigned char const tmpArray[2] = { reply[6], reply[5] };
 		memcpy(&tmp, tmpArray, 2);
 		a1 = ((float) (tmp)) * lsb;
 	}
 
 	{
 		unsigned int tmp = 0;
-		unsigned char const tmpArray[2] = { reply.get()[8], reply.get()[7] };
+		unsigned char const tmpArray[2] = { reply[8], reply[7] };
 		memcpy(&tmp, tmpArray, 2);
 		a2 = ((float) (tmp)) * lsb;
 	}
 
 	{
 		unsigned int tmp = 0;
-		unsigned char const tmpArray[2] = { reply.get()[10], reply.get()[9] };
+		unsigned char const tmpArray[2] = { reply[10], reply[9] };
 		memcpy(&tmp, tmpArray, 2);
 		a3 = ((float) (tmp)) * lsb;
 	}
 
 	{
 		unsigned int tmp = 0;
-		unsigned char const tmpArray[2] = { reply.get()[12], reply.get()[11] };
+		unsigned char const tmpArray[2] = { reply[12], reply[11] };
 		memcpy(&tmp, tmpArray, 2);
 		a4 = ((float) (tmp)) * lsb;
 	}
 
 	{
 		unsigned int tmp = 0;
-		unsigned char const tmpArray[2] = { reply.get()[14], reply.get()[13] };
+		unsigned char const tmpArray[2] = { reply[14], reply[13] };
 		memcpy(&tmp, tmpArray, 2);
 		a5 = ((float) (tmp)) * lsb;
 	}
@@ -354,4 +980,142 @@ bool ioboard::getAllAnalog(float &a0, float &a1, float &a2, float &a3,
 	return true;
 }
 
+/**
+ * @brief switches the board and the host to another baud rate, the board reverts to the previous rate
+ * unless the host confirms the new one within 0.5 s. A reset returns to the initial baud rate.
+ * @param baudRate 230400, 250000, 500000 or 1000000
+ * @return true if both sides use the new baud rate, false if both kept the previous one
+ */
+bool ioboard::setBaudRate(unsigned int const baudRate) {
+	boost::mutex::scoped_lock lock(m_linkMutex);
+
+	unsigned char rate = 0;
+	switch (baudRate) {
+	case 230400:
+		rate = 0;
+		break;
+	case 250000:
+		rate = 1;
+		break;
+	case 500000:
+		rate = 2;
+		break;
+	case 1000000:
+		rate = 3;
+		break;
+	default:
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, baud rate "
+				<< baudRate << " is not supported by the board." << std::endl;
+		return false;
+	}
+
+	// send request string, the board replies with the old rate and switches afterwards
+	int const msgSize = 4;
+	unsigned char msg[msgSize] = { CT_MISC, DT_MISC_BAUD, rate,
+			(unsigned char) (CT_MISC + DT_MISC_BAUD + rate) };
+
+	int const replySize = 4;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+		// the board may have switched and lost its reply, it returns to the previous rate without confirmation
+		isAnswering(2 * baudRateConfirmTime_ms);
+		return false;
+	}
+	if (reply[2] == MISC_NOK) {
+		return false;
+	}
+
+	if (!m_serial->setBaudRate(baudRate)) {
+		// without the confirmation the board returns to the previous rate
+		isAnswering(2 * baudRateConfirmTime_ms);
+		return false;
+	}
+	usleep(1000); // the board switches once its reply has left the uart
+
+	// confirm the new rate, the reply is the first frame transmitted with it. The confirmation is repeated
+	// since the board keeps the new rate as soon as it has received one, even if the reply gets lost.
+	int const confirmSize = 3;
+	unsigned char confirm[confirmSize] = { CT_MISC, DT_MISC_BAUD_CONFIRM,
+			CT_MISC + DT_MISC_BAUD_CONFIRM };
+	bool isConfirmed = false;
+	for (unsigned int i = 0; i < baudRateConfirmAttempts && !isConfirmed; i++) {
+		isConfirmed = m_serial->transfer(confirm, confirmSize, reply,
+				replySize, probeTimeout_ms) && reply[2] != MISC_NOK;
+	}
+	if (!isConfirmed) {
+		// the board returns to the previous rate unless only the replies to the confirmations got lost
+		m_serial->setBaudRate(m_baudRate);
+		if (isAnswering(2 * baudRateConfirmTime_ms)) {
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error, baud rate "
+					<< baudRate << " not confirmed, reverted." << std::endl;
+			return false;
+		}
+		m_serial->setBaudRate(baudRate);
+		if (!isAnswering(baudRateConfirmAttempts * probeTimeout_ms)) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error, the board answers neither at " << m_baudRate
+					<< " nor at " << baudRate << " baud." << std::endl;
+			m_serial->setBaudRate(m_baudRate);
+			return false;
+		}
+	}
+
+	m_baudRate = baudRate;
+	return true;
+}
+
+/**
+ * @brief probes the board with id requests until it answers at the current baud rate of the host
+ * @param timeout_ms time in ms the board may take to answer
+ * @return true if the board answered within the timeout, false otherwise
+ */
+bool ioboard::isAnswering(unsigned int const timeout_ms) {
+	int const msgSize = 3;
+	unsigned char const msg[msgSize] = { CT_MISC, DT_MISC_ID, CT_MISC
+			+ DT_MISC_ID };
+	int const replySize = 6;
+	unsigned char reply[replySize];
+
+	boost::asio::steady_timer::clock_type::time_point const deadline =
+			boost::asio::steady_timer::clock_type::now()
+					+ boost::asio::chrono::milliseconds(timeout_ms);
+	do {
+		if (m_serial->transfer(msg, msgSize, reply, replySize, probeTimeout_ms)
+				&& reply[2] != MISC_NOK) {
+			return true;
+		}
+	} while (boost::asio::steady_timer::clock_type::now() < deadline);
+
+	return false;
+}
+
+/**
+ * @brief writes the latency percentiles of all operations used so far as text
+ */
+void ioboard::dumpLatencyStatistics(std::ostream &os) const {
+	m_serial->getLatencyStatistics().dump(os);
+}
+
+/**
+ * @brief waits until all asynchronous requests issued via the io entities have been completed
+ */
+void ioboard::waitForAll() {
+	m_serial->waitForAll();
+}
+
+/**
+ * @brief holds back the requests issued via the io entities until flush is called, they are then
+ * transmitted with one write, e.g. all outputs of a control cycle
+ */
+void ioboard::holdWrites() {
+	m_serial->holdWrites();
+}
+
+/**
+ * @brief transmits the requests held back since holdWrites
+ */
+void ioboard::flush() {
+	m_serial->flush();
+}
+
 } // end of namespace arduinoio
@@ -32,7 +32,14 @@
 
 #include <vector>
 #include <algorithm>
+#include <boost/atomic.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/weak_ptr.hpp>
 #include "serial.h"
+#include "capabilities.h"
 
 #include "ioentity.h"
 #include "pin.h"
@@ -40,24 +47,63 @@
 #include "analogPin.h"
 #include "gpioInputPin.h"
 #include "gpioOutputPin.h"
+#include "gpioEdge.h"
+#include "gpioPortSnapshot.h"
 #include "i2cBridge.h"
 #include "servo.h"
 #include "counterPin.h"
 #include "ioentity_factory.h"
+#include "transport_factory.h"
 
 namespace arduinoio {
 
 /**
  * @class ioboard
- * @brief this class represents the arduino io board as an object in the pc
+ * @brief this class represents the arduino io board as an object in the pc. The communication is processed
+ * by an io thread owned by the board, so the board and its io entities may be used by several threads
+ * concurrently. The handlers of asynchronous requests are invoked by the io thread.
+ *
+ * Alternatively many boards share one io service run by a few threads of the application, each board
+ * serialises its handlers by a strand then. stopSupervision has to be called and the io service must be
+ * stopped before such a board is destroyed, and the blocking methods must not be called from the handlers
+ * of asynchronous requests.
+ *
+ * If the link to the board is lost, e.g. the usb serial adapter has been unplugged, the board reopens the
+ * device node. After the board has restarted it configures all live io entities again, their requests fail
+ * until then.
  */
 class ioboard {
 public:
 	/**
 	 * @brief Constructor
 	 * @param devNode string designating the used device node for communication
+	 * @param lowLatency configures the serial port for minimal latency, see serialPortTransport
 	 */
-	ioboard(std::string const &devNode, unsigned int const baudRate = 230400);
+	ioboard(std::string const &devNode, unsigned int const baudRate = 230400, bool const lowLatency = false);
+
+	/**
+	 * @brief Constructor
+	 * @param devNode string designating the used device node for communication
+	 * @param io_service io service shared with other boards, it has to be run by threads of the application
+	 * already during the construction
+	 * @param lowLatency configures the serial port for minimal latency, see serialPortTransport
+	 */
+	ioboard(std::string const &devNode, boost::asio::io_service &io_service,
+			unsigned int const baudRate = 230400, bool const lowLatency = false);
+
+	/**
+	 * @brief Constructor
+	 * @param t transport used for the communication with the io board, see transport_factory
+	 */
+	ioboard(boost::shared_ptr<transport> const &t);
+
+	/**
+	 * @brief Constructor
+	 * @param t transport used for the communication with the io board, see transport_factory
+	 * @param io_service io service shared with other boards, it has to be run by threads of the application
+	 * already during the construction
+	 */
+	ioboard(boost::shared_ptr<transport> const &t, boost::asio::io_service &io_service);
 
 	/**
 	 * @brief Destructor
@@ -71,6 +117,26 @@ public:
 	boost::shared_ptr<gpioOutputPin> createGpioOutputPin(E_PIN const p,	bool const pinValue);
 	boost::shared_ptr<counterPin> createCounterPin(E_PIN const p, E_COUNTER_OPTIONS const opt);
 
+	/**
+	 * @brief creates an empty batch, the requests of the io entities of this board appended to it are
+	 * executed with one round trip, e.g. all inputs and outputs of a control cycle
+	 */
+	boost::shared_ptr<batch> createBatch();
+
+	/**
+	 * @brief returns true if the firmware executes batches
+	 */
+	inline bool isBatchSupported() const {
+		return m_capabilities.hasClass(CT_BATCH);
+	}
+
+	/**
+	 * @brief returns the limits and features reported by the firmware after the last reset or restart
+	 */
+	inline capabilities const &getCapabilities() const {
+		return m_capabilities;
+	}
+
 	/**
 	 * @brief resets the ioboard
 	 * @return true if successful, false otherwise
@@ -88,6 +154,47 @@ public:
 	 * @return true if successful, false otherwise
 	 */
 	bool getTemperature(float &temp);
+	/**
+	 * @brief retrieves the cumulative error counters of the board, they count modulo 65536 since the last
+	 * start of the board. The unacknowledged requests transmitted by the host minus the executed and the
+	 * failed ones are the requests the board has not received, see getUnacknowledgedCount.
+	 * @param droppedFrames frames dropped due to a wrong length or crc
+	 * @param failedRequests unacknowledged requests rejected due to a wrong checksum or argument
+	 * @param executedRequests unacknowledged requests executed by the board
+	 * @return true if successful, false otherwise, e.g. for boards using protocol v1
+	 */
+	bool getErrorCounters(unsigned int &droppedFrames,
+			unsigned int &failedRequests, unsigned int &executedRequests);
+
+	/**
+	 * @brief returns the number of unacknowledged requests transmitted to the board, see
+	 * gpioOutputPin::setAcknowledged and servo::setAcknowledged
+	 */
+	inline unsigned long getUnacknowledgedCount() const {
+		return m_serial->getUnacknowledgedCount();
+	}
+
+	/**
+	 * @brief returns the number of received bytes discarded while resynchronising to the replies
+	 */
+	inline unsigned long getDiscardedByteCount() const {
+		return m_serial->getDiscardedByteCount();
+	}
+
+	/**
+	 * @brief returns the number of replies with a wrong checksum or crc, or not matching their request
+	 */
+	inline unsigned long getCorruptReplyCount() const {
+		return m_serial->getCorruptReplyCount();
+	}
+
+	/**
+	 * @brief returns the number of replies the board has sent but the host has not received, v2 only
+	 */
+	inline unsigned long getLostReplyCount() const {
+		return m_serial->getLostReplyCount();
+	}
+
 	/**
 	 * @brief reads the analog value of all 6 analog input pins at once
 	 * @param ax voltage of ax, x = 0 to 5
@@ -95,10 +202,130 @@ public:
 	 */
 	bool getAllAnalog(float &a0, float &a1, float &a2, float &a3, float &a4,
 			float &a5);
+	/**
+	 * @brief reads the values and edges of the gpio input pins selected by a mask with one request, e.g. a
+	 * scan of all digital inputs. Only the pins configured by a gpioInputPin are read, their edges are
+	 * cleared like by gpioInputPin::getPinValue.
+	 * @param mask pins to read, bit per pin number, see gpioPortSnapshot::getPinMask
+	 * @param snapshot values and edges of the pins which have been read
+	 * @return true if successful, false otherwise, e.g. for boards using protocol v1
+	 */
+	bool readGpioPort(unsigned int const mask, gpioPortSnapshot &snapshot);
+	/**
+	 * @brief writes the values of the gpio output pins selected by a mask with one request, only the pins
+	 * configured by a gpioOutputPin are written
+	 * @param mask pins to write, bit per pin number, see gpioPortSnapshot::getPinMask
+	 * @param values values of the pins, bit per pin number
+	 * @return true if all selected pins have been written, false otherwise, e.g. for boards using protocol v1
+	 */
+	bool writeGpioPort(unsigned int const mask, unsigned int const values);
+	/**
+	 * @brief reads the edges recorded by the board since the last readout, see gpioInputPin::recordEdges.
+	 * The board queues up to 32 edges, further edges are counted as lost until the queue is read. One call
+	 * fetches at most one queue of edges, edges recorded meanwhile are left for the next call.
+	 * @param edges receives the edges of all recording pins in the order they occurred. The edges are
+	 * removed from the board once they have been fetched, so they are valid even if false is returned.
+	 * @param lostEdges cumulative number of edges lost since the start of the board, modulo 65536
+	 * @return true if successful, false if a request failed or for boards using protocol v1
+	 */
+	bool readGpioEdges(std::vector<gpioEdge> &edges, unsigned int &lostEdges);
+	/**
+	 * @brief switches the board and the host to another baud rate, the board reverts to the previous rate
+	 * unless the host confirms the new one within 0.5 s. A reset returns to the initial baud rate.
+	 * @param baudRate 230400, 250000, 500000 or 1000000
+	 * @return true if both sides use the new baud rate, false if both kept the previous one
+	 */
+	bool setBaudRate(unsigned int const baudRate);
+
+	/**
+	 * @brief returns the baud rate currently used for the communication with the board
+	 */
+	inline unsigned int getBaudRate() const {
+		return m_baudRate;
+	}
+
+	/**
+	 * @brief returns the protocol version used for the communication with the board, protocol v2 is
+	 * negotiated after every reset and falls back to v1 for boards with an older firmware
+	 * @return PROTOCOL_V1 or PROTOCOL_V2
+	 */
+	inline unsigned int getProtocolVersion() const {
+		return m_serial->getProtocolVersion();
+	}
+
+	/**
+	 * @brief returns the latencies of all requests to the board per operation, they can be queried while
+	 * requests are processed
+	 */
+	inline latencyStatistics &getLatencyStatistics() {
+		return m_serial->getLatencyStatistics();
+	}
+
+	/**
+	 * @brief writes the latency percentiles of all operations used so far as text
+	 */
+	void dumpLatencyStatistics(std::ostream &os) const;
+
+	/**
+	 * @brief stops reconnecting and restoring the io entities, must be called before a shared io service
+	 * is stopped. The destructor calls it as well.
+	 */
+	void stopSupervision();
+
+	/**
+	 * @brief waits until all asynchronous requests issued via the io entities have been completed
+	 */
+	void waitForAll();
+
+	/**
+	 * @brief holds back the requests issued via the io entities until flush is called, they are then
+	 * transmitted with one write, e.g. all outputs of a control cycle
+	 */
+	void holdWrites();
+
+	/**
+	 * @brief transmits the requests held back since holdWrites
+	 */
+	void flush();
 
 private:
 	boost::shared_ptr<serial> m_serial;
 	std::vector<E_PIN > m_pinVect;
+	boost::mutex m_entityMutex;
+	std::vector<boost::weak_ptr<ioentity> > m_entities; // io entities restored after a restart of the board
+	boost::scoped_ptr<boost::asio::steady_timer> m_supervisionTimer;
+	boost::scoped_ptr<boost::thread> m_recoveryThread; // reconnects and restores, it waits for replies
+	boost::mutex m_supervisionMutex;
+	boost::condition_variable m_supervisionStopped;
+	bool m_isSupervising; // the supervision continues, cleared by stopSupervision
+	bool m_isSupervisionActive; // the timer is armed or the recovery thread runs
+	bool m_isRestoring;
+	unsigned long m_supervisedTimeoutCount; // timeouts already checked for a restart of the board
+	boost::mutex m_linkMutex; // serialises the supervision with resets and baud rate changes
+	unsigned int m_initialBaudRate; // baud rate of the board after a reset
+	unsigned int m_baudRate;
+	capabilities m_capabilities;
+
+	void init();
+	bool waitUntilReady(bool const isAlternating);
+	bool isAnswering(unsigned int const timeout_ms);
+	void armSupervisionTimer();
+	void onSupervisionTimer(boost::system::error_code const &error);
+	void recover();
+	bool queryRestart(bool &hasRestarted);
+	bool negotiateProtocol();
+	bool queryCapabilities();
+	void addEntity(boost::shared_ptr<ioentity> const &ioent);
+	void invalidateEntities();
+	bool restoreEntities();
+	struct restoreProgress {
+		boost::mutex mutex;
+		boost::condition_variable done;
+		unsigned int numPending;
+		unsigned int numFailed;
+	};
+
+	static void onEntityRestored(restoreProgress *pProgress, bool const ok);
 
 	inline bool isPinInVect(E_PIN const p) {
 		return (std::find(m_pinVect.begin(), m_pinVect.end(), p) != m_pinVect.end());
@@ -30,6 +30,8 @@
 #include "ioentity.h"
 #include <assert.h>
 #include <algorithm>
+#include <boost/bind/bind.hpp>
+#include "tags.h"
 
 namespace arduinoio {
 
@@ -48,5 +50,78 @@ ioentity::~ioentity() {
   m_pinVect.clear();
 }
 
+/**
+ * @brief performs the requested configuration for the ioentity in question
+ * @return true in case of success, false in case of failure
+ */
+bool ioentity::config() {
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = buildConfigRequest(msg);
+	if (msgSize > 0) {
+		// retrieve answer and evaluate it
+		int const replySize = 4;
+		unsigned char reply[replySize];
+		if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
+			return false;
+		}
+		if (!evaluateConfig(reply)) {
+			return false;
+		}
+	}
+
+	m_isConfigured = true;
+
+	return true;
+}
+
+/**
+ * @brief performs the configuration without waiting for the reply, e.g. to configure many io entities
+ * with one write
+ * @param handler handler invoked with the result once the reply has been received
+ */
+void ioentity::config(resultHandler const &handler) {
+	unsigned char msg[maxFrameSize];
+	unsigned int const msgSize = buildConfigRequest(msg);
+	if (msgSize == 0) {
+		m_isConfigured = true;
+		if (handler) handler(true);
+		return;
+	}
+
+	int const replySize = 4;
+	m_serial->asyncRequest(msg, msgSize, replySize,
+			boost::bind(&ioentity::onConfig, shared_from_this(), handler,
+					boost::placeholders::_1, boost::placeholders::_2,
+					boost::placeholders::_3));
+}
+
+/**
+ * @brief configures the io entity again after the board has restarted, by default with the
+ * configuration request alone
+ * @param handler handler invoked with the result once the replies have been received
+ */
+void ioentity::restore(resultHandler const &handler) {
+	config(handler);
+}
+
+/**
+ * @brief evaluates the reply to a configuration request, the status is *_NOK for all classes on failure
+ */
+bool ioentity::evaluateConfig(unsigned char const *reply) {
+	return reply[2] != MISC_NOK;
+}
+
+void ioentity::onConfig(boost::shared_ptr<ioentity> const &ioent,
+		resultHandler const &handler, bool const ok,
+		unsigned char const *reply, unsigned int const size) {
+	bool const success = ok && size >= 4 && evaluateConfig(reply);
+	if (success) {
+		ioent->m_isConfigured = true;
+	}
+	if (handler) {
+		handler(success);
+	}
+}
+
 
 } // end of namespace arduinoio
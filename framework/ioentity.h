@@ -30,10 +30,14 @@
 #ifndef IOENTITY_H_
 #define IOENTITY_H_
 
+#include "batch.h"
 #include "pin.h"
 #include "serial.h"
 #include <vector>
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
 
 namespace arduinoio {
 
@@ -41,8 +45,10 @@ namespace arduinoio {
  * @class ioentity
  * @brief implements an ioentity which is the generalised form of an conrete io object
  */
-class ioentity {
+class ioentity : public boost::enable_shared_from_this<ioentity> {
 public:
+	typedef boost::function<void (bool const ok)> resultHandler;
+
 	/**
 	 * @brief Constructor
 	 * @param
@@ -58,7 +64,21 @@ public:
 	 * @brief performs the requested configuration for the ioentity in question
 	 * @return true in case of success, false in case of failure
 	 */
-	virtual bool config() = 0;
+	bool config();
+
+	/**
+	 * @brief performs the configuration without waiting for the reply, e.g. to configure many io entities
+	 * with one write
+	 * @param handler handler invoked with the result once the reply has been received
+	 */
+	void config(resultHandler const &handler);
+
+	/**
+	 * @brief configures the io entity again after the board has restarted, by default with the
+	 * configuration request alone
+	 * @param handler handler invoked with the result once the replies have been received
+	 */
+	virtual void restore(resultHandler const &handler);
 
 	/**
 	 * operator ==
@@ -80,15 +100,31 @@ public:
 		return m_isConfigured;
 	}
 
+	/**
+	 * @brief marks the io entity as not configured, e.g. after the board has lost its configuration
+	 */
+	inline void clearIsConfiguredFlag() {
+		m_isConfigured = false;
+	}
+
 protected:
 	boost::shared_ptr<serial> m_serial;
 	std::vector<pin> m_pinVect;
 
-	inline void setIsConfiguredFlag() {
-		m_isConfigured = true;
-	}
+	/**
+	 * @brief builds the request which configures the io entity on the board from its current state
+	 * @param msg buffer of maxFrameSize bytes receiving the request
+	 * @return number of bytes of the request, 0 if the io entity needs no configuration
+	 */
+	virtual unsigned int buildConfigRequest(unsigned char *msg) const = 0;
+
 private:
-	bool m_isConfigured;
+	boost::atomic<bool> m_isConfigured;
+
+	static bool evaluateConfig(unsigned char const *reply);
+	static void onConfig(boost::shared_ptr<ioentity> const &ioent,
+			resultHandler const &handler, bool const ok,
+			unsigned char const *reply, unsigned int const size);
 };
 
 } // end of namespace arduinoio
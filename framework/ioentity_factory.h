@@ -58,8 +58,9 @@ public:
 	static boost::shared_ptr<servo> createServoPin(boost::shared_ptr<serial> const &serial, E_PIN const p, unsigned int const pulseWidth_us) {
 		return boost::shared_ptr<servo>(new servo(serial, p, pulseWidth_us));
 	}
-	static boost::shared_ptr<i2cBridge> createI2CBridge(boost::shared_ptr<serial> const &serial, unsigned int const baudRate) {
-		return boost::shared_ptr<i2cBridge>(new i2cBridge(serial, baudRate));
+	static boost::shared_ptr<i2cBridge> createI2CBridge(boost::shared_ptr<serial> const &serial, unsigned int const baudRate,
+			unsigned int const maxWriteSize) {
+		return boost::shared_ptr<i2cBridge>(new i2cBridge(serial, baudRate, maxWriteSize));
 	}
 	static boost::shared_ptr<gpioInputPin> createGpioInputPin(boost::shared_ptr<serial> const &serial, E_PIN const p, bool const pullUpEnabled) {
 		return boost::shared_ptr<gpioInputPin>(new gpioInputPin(serial, p, pullUpEnabled));
@@ -0,0 +1,152 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "latencyHistogram.h"
+#include <cmath>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ */
+latencyHistogram::latencyHistogram() {
+	reset();
+}
+
+/**
+ * @brief Destructor
+ */
+latencyHistogram::~latencyHistogram() {
+
+}
+
+/**
+ * @brief counts a duration, only called by one thread at a time
+ * @param value_us duration in us, larger values than about 12 days are counted as such
+ */
+void latencyHistogram::record(unsigned long const value_us) {
+	m_buckets[getBucketIndex(value_us)].fetch_add(1,
+			boost::memory_order_relaxed);
+	if (value_us > m_max.load(boost::memory_order_relaxed)) {
+		m_max.store(value_us, boost::memory_order_relaxed);
+	}
+	m_count.fetch_add(1, boost::memory_order_release);
+}
+
+/**
+ * @brief returns the number of recorded durations
+ */
+unsigned long latencyHistogram::getCount() const {
+	return m_count.load(boost::memory_order_acquire);
+}
+
+/**
+ * @brief returns the largest recorded duration in us
+ */
+unsigned long latencyHistogram::getMax() const {
+	return m_max.load(boost::memory_order_relaxed);
+}
+
+/**
+ * @brief returns the duration not exceeded by the given share of the recorded durations
+ * @param percentile share in percent, e.g. 99.9
+ * @return upper bound of the bucket containing the percentile in us, 0 if nothing has been recorded
+ */
+unsigned long latencyHistogram::getValueAtPercentile(
+		double const percentile) const {
+	unsigned long const count = getCount();
+	if (count == 0) {
+		return 0;
+	}
+
+	unsigned long target = (unsigned long) std::ceil(
+			percentile / 100.0 * (double) count);
+	if (target == 0) {
+		target = 1;
+	}
+
+	// the buckets may be ahead of the count while a duration is recorded, so the sum is compared
+	unsigned long sum = 0;
+	for (unsigned int i = 0; i < numBuckets; i++) {
+		sum += m_buckets[i].load(boost::memory_order_relaxed);
+		if (sum >= target) {
+			unsigned long const upper = getBucketUpperValue(i);
+			unsigned long const max = getMax();
+			return (upper < max) ? upper : max;
+		}
+	}
+
+	return getMax();
+}
+
+/**
+ * @brief discards all recorded durations
+ */
+void latencyHistogram::reset() {
+	for (unsigned int i = 0; i < numBuckets; i++) {
+		m_buckets[i].store(0, boost::memory_order_relaxed);
+	}
+	m_max.store(0, boost::memory_order_relaxed);
+	m_count.store(0, boost::memory_order_release);
+}
+
+/**
+ * @brief values below 2^(subBucketBits + 1) have a bucket of their own, the larger ones share a bucket with the
+ * values having the same magnitude and the same subBucketBits bits following the most significant one
+ */
+unsigned int latencyHistogram::getBucketIndex(unsigned long const value) {
+	unsigned long const maxValue = (1UL << maxValueBits) - 1;
+	unsigned long const v = (value < maxValue) ? value : maxValue;
+	if (v < (1UL << subBucketBits)) {
+		return (unsigned int) v;
+	}
+
+	unsigned int magnitude = 0; // position of the most significant bit
+	while ((v >> (magnitude + 1)) != 0) {
+		magnitude++;
+	}
+	unsigned int const shift = magnitude - subBucketBits;
+
+	return (shift << subBucketBits) + (unsigned int) (v >> shift);
+}
+
+unsigned long latencyHistogram::getBucketUpperValue(unsigned int const index) {
+	unsigned int const subBucketCount = 1 << subBucketBits;
+	if (index < 2 * subBucketCount) {
+		return index;
+	}
+
+	unsigned int const shift = (index >> subBucketBits) - 1;
+	unsigned long const subBucket = (index & (subBucketCount - 1))
+			+ subBucketCount;
+
+	return ((subBucket + 1) << shift) - 1;
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,99 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <boost/atomic.hpp>
+
+namespace arduinoio {
+
+/**
+ * @class latencyHistogram
+ * @brief histogram of durations in us with logarithmic buckets, each power of two is divided into 16 buckets,
+ * so the values are resolved to 6.25 %. Values below 32 us are counted exactly. Recording and reading do not
+ * lock, one thread records while any number of threads read.
+ */
+class latencyHistogram {
+public:
+	/**
+	 * @brief Constructor
+	 */
+	latencyHistogram();
+
+	/**
+	 * @brief Destructor
+	 */
+	~latencyHistogram();
+
+	/**
+	 * @brief counts a duration, only called by one thread at a time
+	 * @param value_us duration in us, larger values than about 12 days are counted as such
+	 */
+	void record(unsigned long const value_us);
+
+	/**
+	 * @brief returns the number of recorded durations
+	 */
+	unsigned long getCount() const;
+
+	/**
+	 * @brief returns the largest recorded duration in us
+	 */
+	unsigned long getMax() const;
+
+	/**
+	 * @brief returns the duration not exceeded by the given share of the recorded durations
+	 * @param percentile share in percent, e.g. 99.9
+	 * @return upper bound of the bucket containing the percentile in us, 0 if nothing has been recorded
+	 */
+	unsigned long getValueAtPercentile(double const percentile) const;
+
+	/**
+	 * @brief discards all recorded durations
+	 */
+	void reset();
+
+private:
+	static unsigned int const subBucketBits = 4;
+	static unsigned int const maxValueBits = 40;
+	static unsigned int const numBuckets = (maxValueBits - subBucketBits)
+			<< subBucketBits;
+
+	boost::atomic<unsigned long> m_buckets[numBuckets];
+	boost::atomic<unsigned long> m_count;
+	boost::atomic<unsigned long> m_max;
+
+	static unsigned int getBucketIndex(unsigned long const value);
+	static unsigned long getBucketUpperValue(unsigned int const index);
+};
+
+} // end of namespace arduinoio
+
+#endif /* LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,179 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "latencyStatistics.h"
+#include <iomanip>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ */
+latencyStatistics::latencyStatistics() :
+		m_numOperations(0) {
+
+}
+
+/**
+ * @brief Destructor
+ */
+latencyStatistics::~latencyStatistics() {
+	unsigned int const numOperations = m_numOperations.load(
+			boost::memory_order_acquire);
+	for (unsigned int i = 0; i < numOperations; i++) {
+		delete m_operations[i];
+	}
+}
+
+/**
+ * @brief records a completed request
+ * @param classTag class tag of the request
+ * @param descriptorTag descriptor tag of the request
+ * @param firstByte_us time from the submission of the request until the first byte of its reply has been received
+ * @param complete_us time from the submission of the request until its reply has been received completely
+ */
+void latencyStatistics::record(unsigned char const classTag,
+		unsigned char const descriptorTag, unsigned long const firstByte_us,
+		unsigned long const complete_us) {
+	operation *pOp = findOrAdd(classTag, descriptorTag);
+	if (pOp != 0) {
+		pOp->firstByte.record(firstByte_us);
+		pOp->complete.record(complete_us);
+	}
+}
+
+/**
+ * @brief records a request which failed, i.e. its deadline has passed or its reply was invalid
+ */
+void latencyStatistics::recordFailure(unsigned char const classTag,
+		unsigned char const descriptorTag) {
+	operation *pOp = findOrAdd(classTag, descriptorTag);
+	if (pOp != 0) {
+		pOp->failureCount.fetch_add(1, boost::memory_order_relaxed);
+	}
+}
+
+latencyHistogram const *latencyStatistics::getFirstByteHistogram(
+		unsigned char const classTag, unsigned char const descriptorTag) const {
+	operation const *pOp = find(classTag, descriptorTag);
+	return (pOp != 0) ? &pOp->firstByte : 0;
+}
+
+latencyHistogram const *latencyStatistics::getCompleteHistogram(
+		unsigned char const classTag, unsigned char const descriptorTag) const {
+	operation const *pOp = find(classTag, descriptorTag);
+	return (pOp != 0) ? &pOp->complete : 0;
+}
+
+unsigned long latencyStatistics::getFailureCount(unsigned char const classTag,
+		unsigned char const descriptorTag) const {
+	operation const *pOp = find(classTag, descriptorTag);
+	return (pOp != 0) ? pOp->failureCount.load(boost::memory_order_relaxed) : 0;
+}
+
+/**
+ * @brief writes a table with the count, the failures and the p50, p99, p99.9 and maximum latencies in us
+ * of all used operations
+ */
+void latencyStatistics::dump(std::ostream &os) const {
+	os << "CT DT latency      count   failed      p50      p99    p99.9      max"
+			<< std::endl;
+
+	unsigned int const numOperations = m_numOperations.load(
+			boost::memory_order_acquire);
+	for (unsigned int i = 0; i < numOperations; i++) {
+		operation const &op = *m_operations[i];
+		for (unsigned int j = 0; j < 2; j++) {
+			latencyHistogram const &h = (j == 0) ? op.firstByte : op.complete;
+			os << std::hex << std::setfill('0') << std::setw(2)
+					<< (unsigned int) op.classTag << " " << std::setw(2)
+					<< (unsigned int) op.descriptorTag << std::dec
+					<< std::setfill(' ') << " "
+					<< ((j == 0) ? "first byte" : "complete  ") << " "
+					<< std::setw(8) << h.getCount() << " " << std::setw(8)
+					<< op.failureCount.load(boost::memory_order_relaxed) << " "
+					<< std::setw(8) << h.getValueAtPercentile(50.0) << " "
+					<< std::setw(8) << h.getValueAtPercentile(99.0) << " "
+					<< std::setw(8) << h.getValueAtPercentile(99.9) << " "
+					<< std::setw(8) << h.getMax() << std::endl;
+		}
+	}
+}
+
+/**
+ * @brief discards the recorded latencies, the operations are kept
+ */
+void latencyStatistics::reset() {
+	unsigned int const numOperations = m_numOperations.load(
+			boost::memory_order_acquire);
+	for (unsigned int i = 0; i < numOperations; i++) {
+		m_operations[i]->firstByte.reset();
+		m_operations[i]->complete.reset();
+		m_operations[i]->failureCount.store(0, boost::memory_order_relaxed);
+	}
+}
+
+latencyStatistics::operation *latencyStatistics::find(
+		unsigned char const classTag, unsigned char const descriptorTag) const {
+	unsigned int const numOperations = m_numOperations.load(
+			boost::memory_order_acquire);
+	for (unsigned int i = 0; i < numOperations; i++) {
+		if (m_operations[i]->classTag == classTag
+				&& m_operations[i]->descriptorTag == descriptorTag) {
+			return m_operations[i];
+		}
+	}
+
+	return 0;
+}
+
+latencyStatistics::operation *latencyStatistics::findOrAdd(
+		unsigned char const classTag, unsigned char const descriptorTag) {
+	operation *pOp = find(classTag, descriptorTag);
+	if (pOp != 0) {
+		return pOp;
+	}
+
+	unsigned int const numOperations = m_numOperations.load(
+			boost::memory_order_relaxed);
+	if (numOperations == maxLatencyOperations) {
+		return 0; // not recorded
+	}
+
+	pOp = new operation();
+	pOp->classTag = classTag;
+	pOp->descriptorTag = descriptorTag;
+	pOp->failureCount.store(0, boost::memory_order_relaxed);
+	m_operations[numOperations] = pOp;
+	m_numOperations.store(numOperations + 1, boost::memory_order_release);
+
+	return pOp;
+}
+
+} // end of namespace arduinoio
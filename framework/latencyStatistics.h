@@ -0,0 +1,127 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LATENCYSTATISTICS_H_
+#define LATENCYSTATISTICS_H_
+
+#include "latencyHistogram.h"
+#include <ostream>
+#include <boost/atomic.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief number of operations, i.e. combinations of class and descriptor tag, which are distinguished
+ */
+static unsigned int const maxLatencyOperations = 64;
+
+/**
+ * @class latencyStatistics
+ * @brief latencies of the requests per operation, recorded by the thread processing the requests
+ * and readable by any thread at runtime
+ */
+class latencyStatistics {
+public:
+	/**
+	 * @brief Constructor
+	 */
+	latencyStatistics();
+
+	/**
+	 * @brief Destructor
+	 */
+	~latencyStatistics();
+
+	/**
+	 * @brief records a completed request
+	 * @param classTag class tag of the request
+	 * @param descriptorTag descriptor tag of the request
+	 * @param firstByte_us time from the submission of the request until the first byte of its reply has been received
+	 * @param complete_us time from the submission of the request until its reply has been received completely
+	 */
+	void record(unsigned char const classTag, unsigned char const descriptorTag,
+			unsigned long const firstByte_us, unsigned long const complete_us);
+
+	/**
+	 * @brief records a request which failed, i.e. its deadline has passed or its reply was invalid
+	 */
+	void recordFailure(unsigned char const classTag,
+			unsigned char const descriptorTag);
+
+	/**
+	 * @brief returns the histogram of the time until the first byte of the reply, 0 if the operation has not been used
+	 */
+	latencyHistogram const *getFirstByteHistogram(unsigned char const classTag,
+			unsigned char const descriptorTag) const;
+
+	/**
+	 * @brief returns the histogram of the time until the complete reply, 0 if the operation has not been used
+	 */
+	latencyHistogram const *getCompleteHistogram(unsigned char const classTag,
+			unsigned char const descriptorTag) const;
+
+	/**
+	 * @brief returns the number of failed requests of the operation
+	 */
+	unsigned long getFailureCount(unsigned char const classTag,
+			unsigned char const descriptorTag) const;
+
+	/**
+	 * @brief writes a table with the count, the failures and the p50, p99, p99.9 and maximum latencies in us
+	 * of all used operations
+	 */
+	void dump(std::ostream &os) const;
+
+	/**
+	 * @brief discards the recorded latencies, the operations are kept
+	 */
+	void reset();
+
+private:
+	struct operation {
+		unsigned char classTag;
+		unsigned char descriptorTag;
+		latencyHistogram firstByte;
+		latencyHistogram complete;
+		boost::atomic<unsigned long> failureCount;
+	};
+
+	// appended by the recording thread only, so the readers see complete operations below m_numOperations
+	operation *m_operations[maxLatencyOperations];
+	boost::atomic<unsigned int> m_numOperations;
+
+	operation *find(unsigned char const classTag,
+			unsigned char const descriptorTag) const;
+	operation *findOrAdd(unsigned char const classTag,
+			unsigned char const descriptorTag);
+};
+
+} // end of namespace arduinoio
+
+#endif /* LATENCYSTATISTICS_H_ */
@@ -0,0 +1,151 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "loopbackTransport.h"
+#include <algorithm>
+#include <cassert>
+#include <boost/bind/bind.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ */
+loopbackTransport::loopbackTransport() :
+		m_pStrand(0), m_baudRate(0), m_pReadBuf(0), m_readBufSize(0) {
+
+}
+
+/**
+ * @brief Destructor
+ */
+loopbackTransport::~loopbackTransport() {
+
+}
+
+bool loopbackTransport::open(boost::asio::io_service::strand &strand) {
+	m_pStrand = &strand;
+	return true;
+}
+
+void loopbackTransport::asyncWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	assert(m_pStrand != 0);
+	// handlers must never be invoked from within the initiating function
+	m_pStrand->post(
+			boost::bind(&loopbackTransport::onWrite, this, buffers, numBuffers,
+					handler));
+}
+
+void loopbackTransport::asyncReadSome(unsigned char *data,
+		std::size_t const size, ioHandler const &handler) {
+	assert(m_pStrand != 0 && !m_readHandler);
+	m_pReadBuf = data;
+	m_readBufSize = size;
+	m_readHandler = handler;
+	completeRead();
+}
+
+void loopbackTransport::cancel() {
+	if (m_readHandler) {
+		m_pStrand->post(
+				boost::bind(m_readHandler,
+						boost::system::error_code(
+								boost::asio::error::operation_aborted), 0));
+		m_readHandler.clear();
+	}
+}
+
+/**
+ * @brief records the baud rate of the host, the bytes are not paced by it
+ */
+bool loopbackTransport::setBaudRate(unsigned int const baudRate) {
+	m_baudRate = baudRate;
+	return true;
+}
+
+/**
+ * @brief sets the handler receiving the bytes written by the host, without handler the bytes are dropped
+ */
+void loopbackTransport::setDeviceHandler(deviceHandler const &handler) {
+	m_deviceHandler = handler;
+}
+
+/**
+ * @brief passes bytes to the host as if they had been received from the io board,
+ * may be called from any thread, e.g. by a device emulated in its own thread
+ */
+void loopbackTransport::injectToHost(unsigned char const *data,
+		std::size_t const size) {
+	assert(m_pStrand != 0);
+	// the receive buffer is only accessed from within the strand
+	m_pStrand->post(
+			boost::bind(&loopbackTransport::onInject, this,
+					std::vector<unsigned char>(data, data + size)));
+}
+
+void loopbackTransport::onWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	m_txData.clear();
+	for (std::size_t i = 0; i < numBuffers; i++) {
+		unsigned char const *data =
+				static_cast<unsigned char const *>(buffers[i].data());
+		m_txData.insert(m_txData.end(), data, data + buffers[i].size());
+	}
+
+	if (m_deviceHandler && !m_txData.empty()) {
+		m_deviceHandler(&m_txData[0], m_txData.size());
+	}
+	handler(boost::system::error_code(), m_txData.size());
+}
+
+void loopbackTransport::onInject(std::vector<unsigned char> const &data) {
+	m_rxData.insert(m_rxData.end(), data.begin(), data.end());
+	completeRead();
+}
+
+/**
+ * @brief completes the pending read operation as soon as injected data is available
+ */
+void loopbackTransport::completeRead() {
+	if (!m_readHandler || m_rxData.empty()) {
+		return;
+	}
+
+	std::size_t const numBytes = std::min(m_readBufSize, m_rxData.size());
+	std::copy(m_rxData.begin(), m_rxData.begin() + numBytes, m_pReadBuf);
+	m_rxData.erase(m_rxData.begin(), m_rxData.begin() + numBytes);
+
+	ioHandler handler;
+	handler.swap(m_readHandler);
+	m_pStrand->post(
+			boost::bind(handler, boost::system::error_code(), numBytes));
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,105 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LOOPBACKTRANSPORT_H_
+#define LOOPBACKTRANSPORT_H_
+
+#include "transport.h"
+#include <deque>
+#include <vector>
+#include <boost/atomic.hpp>
+
+namespace arduinoio {
+
+/**
+ * @class loopbackTransport
+ * @brief in process transport, the bytes written by the host are passed to a device handler
+ * which answers via injectToHost, e.g. an emulated io board used for benchmarks without hardware
+ */
+class loopbackTransport : public transport {
+public:
+	/**
+	 * @brief handler receiving the bytes written by the host
+	 */
+	typedef boost::function<void (unsigned char const *data, std::size_t const size)> deviceHandler;
+
+	/**
+	 * @brief Constructor
+	 */
+	loopbackTransport();
+
+	/**
+	 * @brief Destructor
+	 */
+	~loopbackTransport();
+
+	bool open(boost::asio::io_service::strand &strand);
+	void asyncWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler);
+	void asyncReadSome(unsigned char *data, std::size_t const size, ioHandler const &handler);
+	void cancel();
+	bool setBaudRate(unsigned int const baudRate);
+
+	/**
+	 * @brief returns the baud rate last set by the host, 0 if it has not set one since the transport was created.
+	 * The rate does not pace the bytes, a device handler may use it to drop the bytes of a mismatching rate.
+	 */
+	inline unsigned int getBaudRate() const {
+		return m_baudRate;
+	}
+
+	/**
+	 * @brief sets the handler receiving the bytes written by the host, without handler the bytes are dropped
+	 */
+	void setDeviceHandler(deviceHandler const &handler);
+
+	/**
+	 * @brief passes bytes to the host as if they had been received from the io board,
+	 * may be called from any thread, e.g. by a device emulated in its own thread
+	 */
+	void injectToHost(unsigned char const *data, std::size_t const size);
+
+private:
+	boost::asio::io_service::strand *m_pStrand;
+	deviceHandler m_deviceHandler;
+	std::deque<unsigned char> m_rxData; // bytes injected but not read by the host yet
+	std::vector<unsigned char> m_txData; // bytes of one write passed to the device handler at once
+	boost::atomic<unsigned int> m_baudRate;
+
+	unsigned char *m_pReadBuf; // buffer of the pending read operation
+	std::size_t m_readBufSize;
+	ioHandler m_readHandler;
+
+	void onWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler);
+	void onInject(std::vector<unsigned char> const &data);
+	void completeRead();
+};
+
+} // end of namespace arduinoio
+
+#endif /* LOOPBACKTRANSPORT_H_ */
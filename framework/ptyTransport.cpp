@@ -0,0 +1,110 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ptyTransport.h"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor, creates the pseudo terminal so the peer can attach before the transport is opened
+ */
+ptyTransport::ptyTransport() :
+		m_masterFd(-1), m_slaveFd(-1) {
+	m_masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (m_masterFd < 0 || grantpt(m_masterFd) != 0
+			|| unlockpt(m_masterFd) != 0) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not create pseudo terminal." << std::endl;
+		return;
+	}
+	m_slaveName = ptsname(m_masterFd);
+
+	// the protocol is binary, so the line discipline must not alter any byte
+	struct termios tio;
+	tcgetattr(m_masterFd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(m_masterFd, TCSANOW, &tio);
+
+	m_slaveFd = ::open(m_slaveName.c_str(), O_RDWR | O_NOCTTY);
+}
+
+/**
+ * @brief Destructor
+ */
+ptyTransport::~ptyTransport() {
+	if (m_master) {
+		m_master.reset(); // closes the master
+	} else if (m_masterFd >= 0) {
+		close(m_masterFd);
+	}
+	if (m_slaveFd >= 0) {
+		close(m_slaveFd);
+	}
+}
+
+bool ptyTransport::open(boost::asio::io_service::strand &strand) {
+	if (m_masterFd < 0) {
+		return false;
+	}
+
+	if (m_master) {
+		m_master->release(); // reopened, the master stays open
+	}
+	m_master.reset(
+			new boost::asio::posix::stream_descriptor(strand.context(), m_masterFd));
+	return true;
+}
+
+void ptyTransport::asyncWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	assert(m_master);
+	boost::asio::async_write(*m_master,
+			constBufferRange(buffers, numBuffers), handler);
+}
+
+void ptyTransport::asyncReadSome(unsigned char *data, std::size_t const size,
+		ioHandler const &handler) {
+	assert(m_master);
+	m_master->async_read_some(boost::asio::buffer(data, size), handler);
+}
+
+void ptyTransport::cancel() {
+	if (m_master) {
+		boost::system::error_code ignored;
+		m_master->cancel(ignored);
+	}
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,77 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PTYTRANSPORT_H_
+#define PTYTRANSPORT_H_
+
+#include "transport.h"
+#include <string>
+#include <boost/scoped_ptr.hpp>
+
+namespace arduinoio {
+
+/**
+ * @class ptyTransport
+ * @brief transport via the master side of a pseudo terminal created by the host,
+ * a board emulator or a board sharing daemon attaches to the slave device node
+ */
+class ptyTransport : public transport {
+public:
+	/**
+	 * @brief Constructor, creates the pseudo terminal so the peer can attach before the transport is opened
+	 */
+	ptyTransport();
+
+	/**
+	 * @brief Destructor
+	 */
+	~ptyTransport();
+
+	bool open(boost::asio::io_service::strand &strand);
+	void asyncWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler);
+	void asyncReadSome(unsigned char *data, std::size_t const size, ioHandler const &handler);
+	void cancel();
+
+	/**
+	 * @brief returns the device node of the slave side, empty if the pseudo terminal could not be created
+	 */
+	inline std::string const &getSlaveName() const {
+		return m_slaveName;
+	}
+
+private:
+	int m_masterFd;
+	boost::scoped_ptr<boost::asio::posix::stream_descriptor> m_master;
+	int m_slaveFd; // keeps the slave open, otherwise reading the master fails until the peer has attached
+	std::string m_slaveName;
+};
+
+} // end of namespace arduinoio
+
+#endif /* PTYTRANSPORT_H_ */
@@ -0,0 +1,99 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "recordingTransport.h"
+#include <cassert>
+#include <boost/bind/bind.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ * @param t transport to the io board
+ * @param recorder trace the exchanged bytes are appended to
+ */
+recordingTransport::recordingTransport(boost::shared_ptr<transport> const &t,
+		boost::shared_ptr<traceRecorder> const &recorder) :
+		m_transport(t), m_recorder(recorder), m_pReadBuf(0) {
+	assert(m_transport && m_recorder);
+}
+
+/**
+ * @brief Destructor
+ */
+recordingTransport::~recordingTransport() {
+
+}
+
+bool recordingTransport::open(boost::asio::io_service::strand &strand) {
+	return m_transport->open(strand);
+}
+
+void recordingTransport::asyncWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	// every buffer holds one request frame
+	for (std::size_t i = 0; i < numBuffers; i++) {
+		m_recorder->record(TRACE_TX,
+				static_cast<unsigned char const *>(buffers[i].data()),
+				buffers[i].size());
+	}
+	m_transport->asyncWrite(buffers, numBuffers, handler);
+}
+
+void recordingTransport::asyncReadSome(unsigned char *data,
+		std::size_t const size, ioHandler const &handler) {
+	assert(!m_readHandler);
+	m_pReadBuf = data;
+	m_readHandler = handler;
+	m_transport->asyncReadSome(data, size,
+			boost::bind(&recordingTransport::onRead, this,
+					boost::asio::placeholders::error,
+					boost::asio::placeholders::bytes_transferred));
+}
+
+void recordingTransport::cancel() {
+	m_transport->cancel();
+}
+
+bool recordingTransport::setBaudRate(unsigned int const baudRate) {
+	return m_transport->setBaudRate(baudRate);
+}
+
+void recordingTransport::onRead(boost::system::error_code const &error,
+		std::size_t const bytesTransferred) {
+	if (!error && bytesTransferred > 0) {
+		m_recorder->record(TRACE_RX, m_pReadBuf, bytesTransferred);
+	}
+
+	ioHandler handler;
+	handler.swap(m_readHandler);
+	handler(error, bytesTransferred);
+}
+
+} // end of namespace arduinoio
@@ -0,0 +1,84 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECORDINGTRANSPORT_H_
+#define RECORDINGTRANSPORT_H_
+
+#include "transport.h"
+#include "traceRecorder.h"
+#include <boost/shared_ptr.hpp>
+
+namespace arduinoio {
+
+/**
+ * @class recordingTransport
+ * @brief passes all operations to another transport and records the written and received bytes,
+ * the trace can be fed back into an ioboard with replayTransport
+ */
+class recordingTransport : public transport {
+public:
+	/**
+	 * @brief Constructor
+	 * @param t transport to the io board
+	 * @param recorder trace the exchanged bytes are appended to
+	 */
+	recordingTransport(boost::shared_ptr<transport> const &t,
+			boost::shared_ptr<traceRecorder> const &recorder);
+
+	/**
+	 * @brief Destructor
+	 */
+	~recordingTransport();
+
+	bool open(boost::asio::io_service::strand &strand);
+	void asyncWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler);
+	void asyncReadSome(unsigned char *data, std::size_t const size, ioHandler const &handler);
+	void cancel();
+	bool setBaudRate(unsigned int const baudRate);
+
+	/**
+	 * @brief returns the recorder of the trace
+	 */
+	inline boost::shared_ptr<traceRecorder> const &getRecorder() const {
+		return m_recorder;
+	}
+
+private:
+	boost::shared_ptr<transport> m_transport;
+	boost::shared_ptr<traceRecorder> m_recorder;
+
+	unsigned char *m_pReadBuf; // buffer of the pending read operation
+	ioHandler m_readHandler;
+
+	void onRead(boost::system::error_code const &error, std::size_t const bytesTransferred);
+};
+
+} // end of namespace arduinoio
+
+#endif /* RECORDINGTRANSPORT_H_ */
@@ -0,0 +1,267 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "replayTransport.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <boost/bind/bind.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ * @param fileName path of the trace file
+ * @param speed factor by which the replay is accelerated, 0 delivers the received chunks without delay
+ */
+replayTransport::replayTransport(std::string const &fileName,
+		double const speed) :
+		m_fileName(fileName), m_speed(speed), m_pStrand(0), m_txRecord(0), m_txOffset(
+				0), m_rxRecord(0), m_mismatchCount(0), m_pReadBuf(0), m_readBufSize(
+				0) {
+	assert(speed >= 0.0);
+}
+
+/**
+ * @brief Destructor
+ */
+replayTransport::~replayTransport() {
+
+}
+
+bool replayTransport::open(boost::asio::io_service::strand &strand) {
+	m_pStrand = &strand;
+	m_timer.reset(new boost::asio::steady_timer(strand.context()));
+
+	if (!load()) {
+		return false;
+	}
+
+	m_openTime = clock::now();
+	skipToTx();
+	deliver(); // chunks received before the first write
+	return true;
+}
+
+void replayTransport::asyncWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	assert(m_pStrand != 0);
+	// handlers must never be invoked from within the initiating function
+	m_pStrand->post(
+			boost::bind(&replayTransport::onWrite, this, buffers, numBuffers,
+					handler));
+}
+
+void replayTransport::asyncReadSome(unsigned char *data,
+		std::size_t const size, ioHandler const &handler) {
+	assert(m_pStrand != 0 && !m_readHandler);
+	m_pReadBuf = data;
+	m_readBufSize = size;
+	m_readHandler = handler;
+	completeRead();
+}
+
+void replayTransport::cancel() {
+	if (m_readHandler) {
+		m_pStrand->post(
+				boost::bind(m_readHandler,
+						boost::system::error_code(
+								boost::asio::error::operation_aborted), 0));
+		m_readHandler.clear();
+	}
+}
+
+/**
+ * @brief reads the trace file and indexes its records
+ */
+bool replayTransport::load() {
+	std::ifstream file(m_fileName.c_str(), std::ios::binary);
+	m_trace.assign(std::istreambuf_iterator<char>(file),
+			std::istreambuf_iterator<char>());
+	if (!file.good() && !file.eof()) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not read trace file " << m_fileName
+				<< std::endl;
+		return false;
+	}
+	if (m_trace.size() < traceHeaderSize
+			|| memcmp(&m_trace[0], traceMagic, sizeof(traceMagic)) != 0
+			|| getLittleEndian(&m_trace[8], 4) != traceVersion) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, " << m_fileName
+				<< " is not a trace file." << std::endl;
+		return false;
+	}
+
+	std::size_t const end = std::min<std::size_t>(m_trace.size(),
+			traceHeaderSize + getLittleEndian(&m_trace[24], 8));
+	std::size_t offset = traceHeaderSize;
+	std::size_t precedingTx = none;
+	while (offset + traceRecordHeaderSize <= end) {
+		record r;
+		r.time_ns = getLittleEndian(&m_trace[offset], 8);
+		r.direction = (m_trace[offset + 8] == TRACE_TX) ? TRACE_TX : TRACE_RX;
+		r.size = getLittleEndian(&m_trace[offset + 9], 2);
+		r.offset = offset + traceRecordHeaderSize;
+		r.precedingTx = precedingTx;
+		if (r.offset + r.size > end) {
+			break; // truncated record
+		}
+		if (r.direction == TRACE_TX) {
+			precedingTx = m_records.size();
+		}
+		m_records.push_back(r);
+		offset = r.offset + r.size;
+	}
+	m_txTime.resize(m_records.size());
+
+	return true;
+}
+
+/**
+ * @brief moves the cursor of the written bytes to the next written chunk
+ */
+void replayTransport::skipToTx() {
+	while (m_txRecord < m_records.size()
+			&& m_records[m_txRecord].direction != TRACE_TX) {
+		m_txRecord++;
+	}
+}
+
+void replayTransport::onWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	clock::time_point const now = clock::now();
+	std::size_t total = 0;
+
+	for (std::size_t i = 0; i < numBuffers; i++) {
+		unsigned char const *data =
+				static_cast<unsigned char const *>(buffers[i].data());
+		for (std::size_t j = 0; j < buffers[i].size(); j++) {
+			if (m_txRecord == m_records.size()) {
+				m_mismatchCount++; // the host writes more than has been recorded
+				continue;
+			}
+
+			record const &r = m_records[m_txRecord];
+			if (data[j] != m_trace[r.offset + m_txOffset]) {
+				if (m_mismatchCount == 0) {
+					std::cerr << __FILE__ << ":" << __LINE__
+							<< " Error, the host diverges from the trace."
+							<< std::endl;
+				}
+				m_mismatchCount++;
+			}
+
+			m_txOffset++;
+			if (m_txOffset == r.size) {
+				m_txTime[m_txRecord] = now;
+				m_txRecord++;
+				m_txOffset = 0;
+				skipToTx();
+			}
+		}
+		total += buffers[i].size();
+	}
+
+	deliver();
+	handler(boost::system::error_code(), total);
+}
+
+/**
+ * @brief delivers the received chunks which are due, arms the timer for the next one
+ */
+void replayTransport::deliver() {
+	clock::time_point const now = clock::now();
+
+	while (m_rxRecord < m_records.size()) {
+		record const &r = m_records[m_rxRecord];
+		if (r.direction == TRACE_TX) {
+			m_rxRecord++;
+			continue;
+		}
+		if (r.precedingTx != none && r.precedingTx >= m_txRecord) {
+			break; // the host has not written the request yet
+		}
+
+		// the chunk is delayed relative to the preceding write like in the recording
+		clock::time_point due = m_openTime;
+		boost::uint64_t delay_ns = r.time_ns;
+		if (r.precedingTx != none) {
+			due = m_txTime[r.precedingTx];
+			delay_ns -= std::min(delay_ns, m_records[r.precedingTx].time_ns);
+		}
+		if (m_speed > 0.0) {
+			due += boost::asio::chrono::nanoseconds(
+					(boost::uint64_t) ((double) delay_ns / m_speed));
+		}
+		if (due > now) {
+			m_timer->expires_at(due);
+			m_timer->async_wait(
+					m_pStrand->wrap(
+							boost::bind(&replayTransport::onTimer, this,
+									boost::asio::placeholders::error)));
+			break;
+		}
+
+		m_rxData.insert(m_rxData.end(), m_trace.begin() + r.offset,
+				m_trace.begin() + r.offset + r.size);
+		m_rxRecord++;
+	}
+
+	completeRead();
+}
+
+void replayTransport::onTimer(boost::system::error_code const &error) {
+	if (error) {
+		return; // the timer has been rearmed
+	}
+	deliver();
+}
+
+/**
+ * @brief completes the pending read operation as soon as delivered data is available
+ */
+void replayTransport::completeRead() {
+	if (!m_readHandler || m_rxData.empty()) {
+		return;
+	}
+
+	std::size_t const numBytes = std::min(m_readBufSize, m_rxData.size());
+	std::copy(m_rxData.begin(), m_rxData.begin() + numBytes, m_pReadBuf);
+	m_rxData.erase(m_rxData.begin(), m_rxData.begin() + numBytes);
+
+	ioHandler handler;
+	handler.swap(m_readHandler);
+	m_pStrand->post(
+			boost::bind(handler, boost::system::error_code(), numBytes));
+}
+
+} // end of namespace arduinoio
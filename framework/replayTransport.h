@@ -0,0 +1,124 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REPLAYTRANSPORT_H_
+#define REPLAYTRANSPORT_H_
+
+#include "transport.h"
+#include "traceRecorder.h"
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/scoped_ptr.hpp>
+
+namespace arduinoio {
+
+/**
+ * @class replayTransport
+ * @brief feeds a trace recorded by recordingTransport back into an ioboard. The bytes written by the host are
+ * compared with the recorded ones, a received chunk is delivered once the host has written everything which had
+ * been written before it, delayed as in the recording relative to the last of these writes.
+ */
+class replayTransport : public transport {
+public:
+	/**
+	 * @brief Constructor
+	 * @param fileName path of the trace file
+	 * @param speed factor by which the replay is accelerated, 0 delivers the received chunks without delay
+	 */
+	replayTransport(std::string const &fileName, double const speed = 1.0);
+
+	/**
+	 * @brief Destructor
+	 */
+	~replayTransport();
+
+	bool open(boost::asio::io_service::strand &strand);
+	void asyncWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler);
+	void asyncReadSome(unsigned char *data, std::size_t const size, ioHandler const &handler);
+	void cancel();
+
+	/**
+	 * @brief returns the number of written bytes which differ from the trace or exceed it
+	 */
+	inline unsigned long getMismatchCount() const {
+		return m_mismatchCount;
+	}
+
+	/**
+	 * @brief returns true once all received chunks of the trace have been delivered
+	 */
+	inline bool isFinished() const {
+		return m_rxRecord == m_records.size();
+	}
+
+private:
+	typedef boost::asio::steady_timer::clock_type clock;
+
+	static std::size_t const none = static_cast<std::size_t>(-1);
+
+	struct record {
+		boost::uint64_t time_ns;
+		E_TRACE_DIRECTION direction;
+		std::size_t offset; // of the data in the trace
+		std::size_t size;
+		std::size_t precedingTx; // index of the last written chunk before a received one, none if there is none
+	};
+
+	std::string m_fileName;
+	double m_speed;
+	boost::asio::io_service::strand *m_pStrand;
+	boost::scoped_ptr<boost::asio::steady_timer> m_timer;
+	std::vector<unsigned char> m_trace;
+	std::vector<record> m_records;
+	std::vector<clock::time_point> m_txTime; // time at which the host has completed a written chunk
+	clock::time_point m_openTime;
+
+	std::size_t m_txRecord; // written chunk the next byte of the host is compared with
+	std::size_t m_txOffset;
+	std::size_t m_rxRecord; // next received chunk to be delivered
+	std::deque<unsigned char> m_rxData; // delivered bytes not read by the host yet
+	unsigned long m_mismatchCount;
+
+	unsigned char *m_pReadBuf; // buffer of the pending read operation
+	std::size_t m_readBufSize;
+	ioHandler m_readHandler;
+
+	bool load();
+	void skipToTx();
+	void onWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler);
+	void deliver();
+	void onTimer(boost::system::error_code const &error);
+	void completeRead();
+};
+
+} // end of namespace arduinoio
+
+#endif /* REPLAYTRANSPORT_H_ */
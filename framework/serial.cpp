@@ -28,53 +28,1148 @@
  */
 
 #include "serial.h"
+#include "tags.h"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <boost/bind/bind.hpp>
 
 namespace arduinoio {
 
+static unsigned int const defaultMaxInFlight = 16;
+
+/**
+ * @brief size of the uart ring buffers of a firmware which does not report them
+ */
+static unsigned int const defaultFirmwareBufferSize = 256;
+
+/**
+ * @brief bytes of an event frame, the firmware may send one of them while the replies in flight are queued
+ */
+static unsigned int const eventWireSize = 4 + FRAME_OVERHEAD;
+
+/**
+ * @brief time in ms the line has to be quiet after a timeout before transmission is resumed
+ */
+static unsigned int const resyncGuardTime_ms = 10;
+
+/**
+ * @brief number of times a caller checks for its completion before it goes to sleep,
+ * a reply usually arrives within a few hundred microseconds
+ */
+static unsigned int const completionSpinCount = 200;
+
+boost::thread_specific_ptr<serial::completion> serial::s_callerCompletion;
+
+static inline unsigned long toMicroseconds(
+		boost::asio::steady_timer::clock_type::duration const &d) {
+	return (unsigned long) boost::asio::chrono::duration_cast<
+			boost::asio::chrono::microseconds>(d).count();
+}
+
 /**
  * @brief Constructor
+ * @param t transport used for the communication with the io board, it is opened by the constructor
+ * @param pIoService io service shared with other boards and run by threads of the application, all handlers
+ * of this board are serialised by a strand and the requests are handed over like to the io thread.
+ * The io service has to be running while requests are processed and must be stopped before the object
+ * is destroyed. 0 creates an io service of its own.
  */
-serial::serial(std::string const &devNode, unsigned int const baudRate) :
-		m_devNode(devNode), m_baudRate(baudRate), m_io_service(), m_serial_port(
-				m_io_service, m_devNode) {
+serial::serial(boost::shared_ptr<transport> const &t,
+		boost::asio::io_service *pIoService) :
+		m_pOwnIoService(
+				(pIoService == 0) ? new boost::asio::io_service() : 0), m_io_service(
+				(pIoService == 0) ? *m_pOwnIoService : *pIoService), m_strand(
+				m_io_service), m_transport(t), m_deadlineTimer(m_io_service), m_head(
+				0), m_numQueued(0), m_numCompleting(0), m_numTransmitted(0), m_maxInFlight(
+				defaultMaxInFlight), m_rxBufferSize(defaultFirmwareBufferSize), m_txBufferSize(
+				defaultFirmwareBufferSize), m_timeout_ms(defaultTimeout_ms), m_timerGeneration(
+				0), m_numWriting(0), m_isHolding(false), m_isReading(false), m_isAborting(false), m_isLinkLost(false), m_isResynchronising(
+				false), m_protocolVersion(PROTOCOL_V1), m_nextSeq(0), m_rxCount(0), m_timeoutCount(0), m_discardedByteCount(0), m_corruptReplyCount(0), m_lostReplyCount(0), m_unacknowledgedCount(0), m_numPending(
+				0), m_isTakeOverPosted(false), m_hasIoThread(false) {
+	assert(m_transport);
 
-	m_serial_port.set_option(
-			boost::asio::serial_port_base::baud_rate(m_baudRate));
-	m_serial_port.set_option(boost::asio::serial_port_base::character_size(8));
-	m_serial_port.set_option(
-			boost::asio::serial_port_base::flow_control(
-					boost::asio::serial_port_base::flow_control::none));
-	m_serial_port.set_option(
-			boost::asio::serial_port_base::parity(
-					boost::asio::serial_port_base::parity::none));
-	m_serial_port.set_option(
-			boost::asio::serial_port_base::stop_bits(
-					boost::asio::serial_port_base::stop_bits::one));
+	for (unsigned int i = 0; i < maxSubmissions; i++) {
+		m_freeSubmissions.push(&m_submissions[i]);
+	}
+
+	if (!m_transport->open(m_strand)) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not open transport." << std::endl;
+	}
+
+	m_strand.post(boost::bind(&serial::startRead, this));
 }
 
 /**
  * @brief Destructor
  */
 serial::~serial() {
+	stopIoThread();
+}
+
+/**
+ * @brief starts the io thread which processes the requests from now on, the requests are then handed over
+ * from the calling threads via lock free queues, so the methods may be called by several threads concurrently.
+ * The handlers of asynchronous requests are invoked by the io thread.
+ */
+void serial::startIoThread() {
+	if (m_ioThread) {
+		return;
+	}
+	if (!m_pOwnIoService) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, the shared io service is run by the application."
+				<< std::endl;
+		return;
+	}
+
+	m_work.reset(new boost::asio::io_service::work(m_io_service));
+	if (m_io_service.stopped()) {
+		m_io_service.restart();
+	}
+
+	completion started;
+	started.done = false;
+	started.ok = false;
+	m_ioThread.reset(
+			new boost::thread(
+					boost::bind(&serial::runIoThread, this, &started)));
+	waitForCompletion(started); // the id of the io thread is known from now on
+}
+
+/**
+ * @brief stops the io thread, the requests not completed yet are processed by the calling threads again
+ */
+void serial::stopIoThread() {
+	if (!m_ioThread) {
+		return;
+	}
+	if (boost::this_thread::get_id() == m_ioThreadId) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, the io thread cannot stop itself." << std::endl;
+		return;
+	}
+
+	waitForAll();
+
+	m_work.reset();
+	m_io_service.stop();
+	m_ioThread->join();
+	m_ioThread.reset();
+	m_hasIoThread = false;
+	m_ioThreadId = boost::thread::id();
+}
+
+void serial::runIoThread(completion *pStarted) {
+	m_ioThreadId = boost::this_thread::get_id();
+	m_hasIoThread = true;
+	signalCompletion(*pStarted, true);
+
+	m_io_service.run();
+}
+
+/**
+ * @brief transmits a request and waits for its reply
+ * @param msg pointer to the complete request message including the checksum
+ * @param msgSize number of bytes of the request message
+ * @param reply buffer provided by the caller which receives the reply
+ * @param replySize number of bytes of the expected reply
+ * @param timeout_ms deadline for the reply after transmission, 0 selects the default timeout. Timeouts
+ * of requests with a deadline of their own are only counted, the caller reports them.
+ * @return true if a matching reply has been received, false otherwise
+ */
+bool serial::transfer(unsigned char const *msg, unsigned int const msgSize,
+		unsigned char *reply, unsigned int const replySize,
+		unsigned int const timeout_ms) {
+	assert(reply != 0);
+
+	if (isAsynchronous()) {
+		if (m_strand.running_in_this_thread()) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error, transfer must not be called by a reply handler."
+					<< std::endl;
+			return false;
+		}
+
+		completion &c = callerCompletion();
+
+		submission *pSub = acquireSubmission();
+		pSub->type = SUBMIT_REQUEST;
+		memcpy(pSub->msg, msg, msgSize);
+		pSub->msgSize = msgSize;
+		pSub->reply = reply;
+		pSub->replySize = replySize;
+		pSub->timeout_ms = timeout_ms;
+		pSub->submitTime = clock::now();
+		pSub->pCompletion = &c;
+		m_numPending++;
+		submit(pSub);
+
+		waitForCompletion(c);
+		return c.ok;
+	}
+
+	completion c;
+	c.done = false;
+	c.ok = false;
+	m_numPending++;
+	request &req = enqueue(msg, msgSize, replySize, timeout_ms);
+	req.reply = reply; // the reply is copied directly into the buffer of the caller
+	req.pCompletion = &c;
+
+	flush(); // the reply is awaited right away
+	while (!c.done) {
+		runOne();
+	}
+
+	return c.ok;
+}
+
+/**
+ * @brief queues a request which is transmitted while other requests are still waiting for their reply
+ * @param msg pointer to the complete request message including the checksum
+ * @param msgSize number of bytes of the request message
+ * @param replySize number of bytes of the expected reply
+ * @param handler handler invoked once the reply has been received or the deadline has passed
+ * @param timeout_ms deadline for the reply after transmission, 0 selects the default timeout
+ */
+void serial::asyncRequest(unsigned char const *msg, unsigned int const msgSize,
+		unsigned int const replySize, replyHandler const &handler,
+		unsigned int const timeout_ms) {
+	m_numPending++;
+
+	// the handlers running on the io thread queue their follow up requests directly as long as the ring has room
+	if (isAsynchronous()
+			&& (!m_strand.running_in_this_thread() || isRingFull())) {
+		submission *pSub = acquireSubmission();
+		if (pSub == 0) {
+			m_numPending--;
+			if (handler) handler(false, 0, 0);
+			return;
+		}
+		pSub->type = SUBMIT_REQUEST;
+		memcpy(pSub->msg, msg, msgSize);
+		pSub->msgSize = msgSize;
+		pSub->reply = 0;
+		pSub->replySize = replySize;
+		pSub->timeout_ms = timeout_ms;
+		pSub->submitTime = clock::now();
+		pSub->handler = handler;
+		pSub->pCompletion = 0;
+		submit(pSub);
+		return;
+	}
+
+	request &req = enqueue(msg, msgSize, replySize, timeout_ms);
+	req.handler = handler;
+
+	startWrite();
+}
+
+bool serial::send(unsigned char const *msg, unsigned int const msgSize) {
+	unsigned char unused = 0;
+	return transfer(msg, msgSize, &unused, 0);
+}
+
+void serial::asyncSend(unsigned char const *msg, unsigned int const msgSize,
+		replyHandler const &handler) {
+	asyncRequest(msg, msgSize, 0, handler);
+}
+
+/**
+ * @brief processes the queued requests until all of them have been completed
+ */
+void serial::waitForAll() {
+	flush();
+
+	if (isAsynchronous()) {
+		if (m_strand.running_in_this_thread()) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error, waitForAll must not be called by a reply handler."
+					<< std::endl;
+			return;
+		}
+
+		boost::mutex::scoped_lock lock(m_pendingMutex);
+		while (m_numPending > 0) {
+			m_allCompleted.wait(lock);
+		}
+		return;
+	}
+
+	while (m_numQueued > 0) {
+		runOne();
+	}
+}
+
+/**
+ * @brief sets the maximum number of requests transmitted without having received their reply,
+ * independent of this limit the requests and replies in flight never exceed the uart buffers of the firmware
+ */
+void serial::setMaxInFlight(unsigned int const maxInFlight) {
+	assert(maxInFlight > 0);
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		m_strand.post(boost::bind(&serial::setMaxInFlight, this, maxInFlight));
+		return;
+	}
+
+	m_maxInFlight = maxInFlight;
+	startWrite();
+}
+
+/**
+ * @brief sets the sizes of the uart buffers of the firmware, the requests and the replies in flight
+ * never exceed them
+ * @param rxBufferSize size of the receive buffer of the firmware
+ * @param txBufferSize size of the transmit buffer of the firmware
+ */
+void serial::setFirmwareBufferSizes(unsigned int const rxBufferSize,
+		unsigned int const txBufferSize) {
+	assert(rxBufferSize > 0 && txBufferSize > 0);
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		m_strand.post(
+				boost::bind(&serial::setFirmwareBufferSizes, this,
+						rxBufferSize, txBufferSize));
+		return;
+	}
+
+	m_rxBufferSize = rxBufferSize;
+	m_txBufferSize = txBufferSize;
+	startWrite();
+}
+
+/**
+ * @brief sets the handler of the events of a source, e.g. the edges of a subscribed gpio pin. The events
+ * arrive as v2 frames with the sequence id FRAME_EVENT_SEQUENCE and are invoked by the io thread, events
+ * without a handler are dropped.
+ * @param classTag class tag of the event
+ * @param source third byte of the event, e.g. the pin number
+ * @param handler handler of the events, an empty handler removes the previous one. The previous handler
+ * is not invoked anymore once the method has returned.
+ */
+void serial::setEventHandler(unsigned char const classTag,
+		unsigned char const source, eventHandler const &handler) {
+	boost::recursive_mutex::scoped_lock lock(m_eventMutex);
+	unsigned int const key = (classTag << 8) | source;
+	if (handler) {
+		m_eventHandlers[key] = handler;
+	} else {
+		m_eventHandlers.erase(key);
+	}
+}
+
+/**
+ * @brief sets the default deadline for replies
+ * @param timeout_ms time in ms a request waits for its reply after it has been transmitted
+ */
+void serial::setTimeout(unsigned int const timeout_ms) {
+	assert(timeout_ms > 0);
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		m_strand.post(boost::bind(&serial::setTimeout, this, timeout_ms));
+		return;
+	}
+
+	m_timeout_ms = timeout_ms;
+}
+
+/**
+ * @brief changes the baud rate of the transport after all queued requests have been completed
+ * @return true in case of success, false in case of failure
+ */
+bool serial::setBaudRate(unsigned int const baudRate) {
+	waitForAll(); // the line rate must not change while requests are in flight
+
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		// the transport is only accessed by the io thread
+		completion &c = callerCompletion();
+		m_strand.post(boost::bind(&serial::onSetBaudRate, this, baudRate, &c));
+		waitForCompletion(c);
+		return c.ok;
+	}
+
+	return m_transport->setBaudRate(baudRate);
+}
+
+void serial::onSetBaudRate(unsigned int const baudRate,
+		completion *pCompletion) {
+	signalCompletion(*pCompletion, m_transport->setBaudRate(baudRate));
+}
+
+/**
+ * @brief changes the framing used by the host after all queued requests have been completed, e.g. when
+ * the board has restarted with protocol v1. The framing negotiated with DT_MISC_PROTOCOL is switched
+ * automatically as soon as the reply has been received.
+ * @param version PROTOCOL_V1 or PROTOCOL_V2
+ */
+void serial::setProtocolVersion(unsigned int const version) {
+	assert(version == PROTOCOL_V1 || version == PROTOCOL_V2);
+	waitForAll();
+
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		completion &c = callerCompletion();
+		m_strand.post(
+				boost::bind(&serial::onSetProtocolVersion, this, version, &c));
+		waitForCompletion(c);
+		return;
+	}
+
+	completion c;
+	onSetProtocolVersion(version, &c);
+}
+
+void serial::onSetProtocolVersion(unsigned int const version,
+		completion *pCompletion) {
+	m_protocolVersion = version;
+	m_rxCount = 0; // partial replies of the previous framing
+	signalCompletion(*pCompletion, true);
+}
+
+/**
+ * @brief reopens the transport after the link has been lost
+ * @return true in case of success, false in case of failure
+ */
+bool serial::reconnect() {
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		completion &c = callerCompletion();
+		m_strand.post(boost::bind(&serial::onReconnect, this, &c));
+		waitForCompletion(c);
+		return c.ok;
+	}
+
+	completion c;
+	onReconnect(&c);
+	return c.ok;
+}
+
+void serial::onReconnect(completion *pCompletion) {
+	if (!m_isLinkLost) {
+		signalCompletion(*pCompletion, true);
+		return;
+	}
+	if (!m_transport->open(m_strand)) {
+		signalCompletion(*pCompletion, false);
+		return;
+	}
+
+	m_isLinkLost = false;
+	startRead();
+	startWrite();
+	signalCompletion(*pCompletion, true);
+}
+
+/**
+ * @brief holds back the transmission of new requests until flush is called, so they are combined into one write
+ */
+void serial::holdWrites() {
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		// keeps the order relative to the submitted requests
+		submission *pSub = acquireSubmission();
+		if (pSub == 0) {
+			return;
+		}
+		pSub->type = SUBMIT_HOLD;
+		submit(pSub);
+		return;
+	}
+
+	m_isHolding = true;
+}
+
+/**
+ * @brief transmits the requests held back since holdWrites
+ */
+void serial::flush() {
+	if (isAsynchronous() && !m_strand.running_in_this_thread()) {
+		submission *pSub = acquireSubmission();
+		if (pSub == 0) {
+			return;
+		}
+		pSub->type = SUBMIT_FLUSH;
+		submit(pSub);
+		return;
+	}
+
+	m_isHolding = false;
+	startWrite();
+}
+
+/**
+ * @brief takes a free submission from the pool, waits for one if all of them are in use
+ * @return the submission, 0 if the pool is exhausted by the handlers running on the io thread
+ */
+serial::submission *serial::acquireSubmission() {
+	submission *pSub = 0;
+	while (!m_freeSubmissions.pop(pSub)) {
+		if (m_strand.running_in_this_thread()) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error, too many requests submitted by reply handlers."
+					<< std::endl;
+			return 0;
+		}
+		boost::this_thread::yield(); // the io thread takes the submissions over shortly
+	}
+
+	return pSub;
+}
+
+/**
+ * @brief hands a submission over to the io thread
+ */
+void serial::submit(submission *pSub) {
+	m_submitted.push(pSub); // cannot fail, the queue holds all submissions of the pool
+	postTakeOver();
+}
+
+/**
+ * @brief schedules takeOverSubmissions on the io thread unless it is already scheduled
+ */
+void serial::postTakeOver() {
+	if (!m_isTakeOverPosted.exchange(true)) {
+		m_strand.post(boost::bind(&serial::takeOverSubmissions, this));
+	}
+}
+
+/**
+ * @brief moves the submitted requests into the request ring, runs on the io thread
+ */
+void serial::takeOverSubmissions() {
+	m_isTakeOverPosted = false; // submissions pushed from now on schedule a new take over
+
+	// submissions left behind by a full ring are taken over once requests have been completed
+	submission *pSub = 0;
+	while (!isRingFull() && m_submitted.pop(pSub)) {
+		switch (pSub->type) {
+		case SUBMIT_REQUEST: {
+			request &req = enqueue(pSub->msg, pSub->msgSize, pSub->replySize,
+					pSub->timeout_ms);
+			req.submitTime = pSub->submitTime;
+			if (pSub->pCompletion != 0) {
+				req.reply = pSub->reply;
+				req.pCompletion = pSub->pCompletion;
+				m_isHolding = false; // the caller awaits the reply right away
+			} else {
+				req.handler.swap(pSub->handler);
+			}
+			break;
+		}
+		case SUBMIT_HOLD:
+			m_isHolding = true;
+			break;
+		case SUBMIT_FLUSH:
+			m_isHolding = false;
+			break;
+		}
+		m_freeSubmissions.push(pSub);
+	}
+
+	if (m_isHolding && isRingFull()) {
+		m_isHolding = false; // the ring is full, the held requests have to be transmitted
+	}
+	startWrite();
+}
+
+/**
+ * @brief returns the completion slot of the calling thread, prepared for the next wait
+ */
+serial::completion &serial::callerCompletion() {
+	completion *pCompletion = s_callerCompletion.get();
+	if (pCompletion == 0) {
+		pCompletion = new completion();
+		s_callerCompletion.reset(pCompletion);
+	}
+	pCompletion->done = false;
+	pCompletion->ok = false;
+
+	return *pCompletion;
+}
+
+/**
+ * @brief wakes up the thread waiting for the completion
+ */
+void serial::signalCompletion(completion &c, bool const ok) {
+	boost::mutex::scoped_lock lock(c.mutex);
+	c.ok = ok;
+	c.done = true;
+	c.cond.notify_one();
+}
+
+/**
+ * @brief blocks the calling thread until the completion has been signalled
+ */
+void serial::waitForCompletion(completion &c) {
+	for (unsigned int i = 0; i < completionSpinCount && !c.done; i++) {
+		boost::this_thread::yield();
+	}
+
+	// the lock is taken in any case, so the completing thread has released the slot before it is reused
+	boost::mutex::scoped_lock lock(c.mutex);
+	while (!c.done) {
+		c.cond.wait(lock);
+	}
+}
+
+/**
+ * @brief copies a request into the next free slot of the request ring, waits for a slot if necessary
+ */
+serial::request &serial::enqueue(unsigned char const *msg,
+		unsigned int const msgSize, unsigned int const replySize,
+		unsigned int const timeout_ms) {
+	assert(msg != 0 && msgSize >= 3 && msgSize <= maxFrameSize);
+	assert(replySize == 0 || (replySize >= 3 && replySize <= maxFrameSize));
+
+	while (isRingFull()) {
+		if (m_isHolding) {
+			flush(); // the ring is full, the held requests have to be transmitted
+		}
+		runOne();
+	}
+
+	request &req = at(m_numQueued);
+	memcpy(req.msg, msg, msgSize);
+	req.msgSize = msgSize;
+	req.reply = req.frame;
+	req.replySize = replySize;
+	req.timeout_ms = (timeout_ms > 0) ? timeout_ms : m_timeout_ms;
+	req.isTimeoutReported = (timeout_ms == 0);
+	req.submitTime = clock::now();
+	req.hasFirstByte = false;
+	req.handler.clear();
+	req.pCompletion = 0;
+	m_numQueued++;
+
+	return req;
+}
+
+/**
+ * @brief executes one handler of the io service
+ */
+void serial::runOne() {
+	if (m_io_service.stopped()) {
+		m_io_service.restart();
+	}
+	m_io_service.run_one();
+}
+
+/**
+ * @brief transmits the next queued request if the in flight limit permits it
+ */
+void serial::startWrite() {
+	if (m_numWriting > 0 || m_isHolding || m_isAborting || m_isResynchronising) {
+		return;
+	}
+	if (m_isLinkLost) {
+		abort(); // fails the requests right away instead of letting them wait for their deadline
+		return;
+	}
+
+	unsigned int msgBytes = 0;
+	unsigned int replyBytes =
+			(m_protocolVersion == PROTOCOL_V2) ? eventWireSize : 0;
+	for (unsigned int i = 0; i < m_numTransmitted; i++) {
+		msgBytes += at(i).wireSize;
+		replyBytes += at(i).wireReplySize;
+	}
+
+	// all requests permitted by the in flight limits are combined into one write
+	clock::time_point const now = clock::now();
+	while (m_numTransmitted < m_numQueued && m_numTransmitted < m_maxInFlight) {
+		request &req = at(m_numTransmitted);
+		buildWire(req);
+		msgBytes += req.wireSize;
+		replyBytes += req.wireReplySize;
+		// the firmware counts the bytes of its ring buffers with 8 bits, a completely full ring reads as empty
+		if (m_numTransmitted > 0
+				&& (msgBytes >= m_rxBufferSize
+						|| replyBytes >= m_txBufferSize)) {
+			break;
+		}
+
+		// the request counts as transmitted right away, its reply may be received before the write handler runs
+		req.deadline = now + boost::asio::chrono::milliseconds(req.timeout_ms);
+		m_writeBuffers[m_numWriting] = boost::asio::buffer(req.pWire,
+				req.wireSize);
+		m_numWriting++;
+		m_numTransmitted++;
+		if (m_numTransmitted == 1) {
+			armDeadline();
+		}
+	}
+
+	if (m_numWriting > 0) {
+		m_transport->asyncWrite(m_writeBuffers, m_numWriting,
+				m_strand.wrap(
+						boost::bind(&serial::onWrite, this,
+								boost::asio::placeholders::error)));
+	}
+}
+
+/**
+ * @brief frames a request with the current protocol version, in v2 it gets the next sequence id
+ */
+void serial::buildWire(request &req) {
+	if (m_protocolVersion != PROTOCOL_V2) {
+		req.pWire = req.msg;
+		req.wireSize = req.msgSize;
+		req.wireReplySize = req.replySize;
+		return;
+	}
+
+	// the crc-16 replaces the additive checksum
+	unsigned int const length = req.msgSize - 1;
+	if (m_nextSeq == FRAME_EVENT_SEQUENCE) {
+		m_nextSeq = 0;
+	}
+	req.seq = m_nextSeq++;
+	req.wire[0] = FRAME_START;
+	req.wire[1] = (unsigned char) length;
+	req.wire[2] = req.seq;
+	memcpy(req.wire + 3, req.msg, length);
+	unsigned short const crc = computeCrc16(req.wire + 1, length + 2);
+	req.wire[length + 3] = (unsigned char) (crc & 0xFF);
+	req.wire[length + 4] = (unsigned char) ((crc >> 8) & 0xFF);
+
+	req.pWire = req.wire;
+	req.wireSize = length + FRAME_OVERHEAD;
+	req.wireReplySize = (req.replySize > 0) ? req.replySize - 1 + FRAME_OVERHEAD : 0;
+}
+
+void serial::onWrite(boost::system::error_code const &error) {
+	m_numWriting = 0;
+	if (error && error != boost::asio::error::operation_aborted) {
+		m_isLinkLost = true;
+	}
+	if (error || !m_isReading) {
+		// a failed read waits for the pending write before the requests are aborted
+		abort();
+		return;
+	}
+
+	// the transport has taken the requests without a reply
+	if (completeUnacknowledged()) {
+		armDeadline();
+	}
+	startWrite();
+}
+
+/**
+ * @brief receives data from the port, the data is assigned to the requests by processReceivedData
+ */
+void serial::startRead() {
+	if (m_isReading || m_isAborting || m_isLinkLost) {
+		return;
+	}
+
+	m_isReading = true;
+	m_transport->asyncReadSome(m_rxBuf + m_rxCount,
+			sizeof(m_rxBuf) - m_rxCount,
+			m_strand.wrap(
+					boost::bind(&serial::onRead, this,
+							boost::asio::placeholders::error,
+							boost::asio::placeholders::bytes_transferred)));
+}
+
+void serial::onRead(boost::system::error_code const &error,
+		std::size_t const bytesTransferred) {
+	m_isReading = false;
+	if (error) {
+		if (error != boost::asio::error::operation_aborted) {
+			m_isLinkLost = true;
+		}
+		abort();
+		return;
+	}
+
+	m_rxCount += bytesTransferred;
+	m_rxTime = clock::now();
+	if (m_isResynchronising) {
+		// the line is not quiet yet, restart the guard time
+		discardReceivedData(m_rxCount);
+		m_timerGeneration++;
+		m_deadlineTimer.expires_after(
+				boost::asio::chrono::milliseconds(resyncGuardTime_ms));
+		m_deadlineTimer.async_wait(
+				m_strand.wrap(
+						boost::bind(&serial::onDeadline, this,
+								boost::asio::placeholders::error,
+								m_timerGeneration)));
+	} else {
+		processReceivedData();
+	}
+
+	startRead();
+}
+
+/**
+ * @brief assigns the received data to the transmitted requests, garbage is skipped until a valid reply is found
+ */
+void serial::processReceivedData() {
+	bool hasCompleted = false;
+
+	while (m_rxCount > 0 && !m_isResynchronising) {
+		if (m_numTransmitted == 0 && m_protocolVersion != PROTOCOL_V2) {
+			discardReceivedData(m_rxCount); // nobody is waiting for this data
+			break;
+		}
+
+		// the framing may change with the reply to DT_MISC_PROTOCOL
+		bool const isWaiting =
+				(m_protocolVersion == PROTOCOL_V2) ?
+						!receiveFrame(hasCompleted) :
+						!receiveReply(hasCompleted);
+		completeUnacknowledged(); // the next reply belongs to the request behind them
+		if (isWaiting) {
+			break; // wait for the rest of the reply
+		}
+	}
+
+	if (hasCompleted) {
+		armDeadline();
+		startWrite(); // the completed requests have freed in flight slots
+	}
+}
+
+/**
+ * @brief assigns a v1 reply to the front request, the reply is recognised by its class and descriptor tag
+ * @return false if more data is needed, true otherwise
+ */
+bool serial::receiveReply(bool &hasCompleted) {
+	// the reply starts with the class and descriptor tag of the request
+	request &req = at(0);
+	unsigned int start = 0;
+	while (start < m_rxCount
+			&& !(m_rxBuf[start] == req.msg[0]
+					&& (start + 1 == m_rxCount
+							|| m_rxBuf[start + 1] == req.msg[1]))) {
+		start++;
+	}
+	if (start > 0) {
+		discardReceivedData(start);
+	}
+	if (m_rxCount > 0 && !req.hasFirstByte) {
+		req.hasFirstByte = true;
+		req.firstByteTime = m_rxTime;
+	}
+	if (m_rxCount < req.replySize) {
+		return false;
+	}
+
+	if (!isChecksumOk(m_rxBuf, req.replySize)) {
+		// the header did not start a valid frame, the reply of the request is lost
+		m_corruptReplyCount++;
+		discardReceivedData(1);
+		completeFront(false);
+	} else {
+		acceptReply(m_rxBuf);
+		m_rxCount -= req.replySize;
+		memmove(m_rxBuf, m_rxBuf + req.replySize, m_rxCount);
+		completeFront(true);
+	}
+	hasCompleted = true;
+	return true;
+}
+
+/**
+ * @brief assigns a v2 frame to the transmitted request with the same sequence id. The board answers in
+ * order, so the requests transmitted before it have lost their reply and fail right away.
+ * @return false if more data is needed, true otherwise
+ */
+bool serial::receiveFrame(bool &hasCompleted) {
+	unsigned int start = 0;
+	while (start < m_rxCount && m_rxBuf[start] != FRAME_START) {
+		start++;
+	}
+	if (start > 0) {
+		discardReceivedData(start);
+	}
+	if (m_rxCount > 0 && m_numTransmitted > 0 && !at(0).hasFirstByte) {
+		at(0).hasFirstByte = true;
+		at(0).firstByteTime = m_rxTime;
+	}
+	if (m_rxCount < 2) {
+		return false;
+	}
+
+	unsigned int const length = m_rxBuf[1];
+	unsigned int const frameSize = length + FRAME_OVERHEAD;
+	if (length < 3) {
+		discardReceivedData(1); // no reply is shorter than class tag, descriptor tag and status
+		return true;
+	}
+	if (m_rxCount < frameSize) {
+		return false;
+	}
+
+	unsigned short const crc = (unsigned short) (m_rxBuf[frameSize - 2]
+			| (m_rxBuf[frameSize - 1] << 8));
+	if (computeCrc16(m_rxBuf + 1, length + 2) != crc) {
+		m_corruptReplyCount++;
+		discardReceivedData(1);
+		return true;
+	}
+
+	unsigned char const seq = m_rxBuf[2];
+	if (seq == FRAME_EVENT_SEQUENCE) {
+		dispatchEvent(m_rxBuf + 3, length);
+		m_rxCount -= frameSize;
+		memmove(m_rxBuf, m_rxBuf + frameSize, m_rxCount);
+		return true;
+	}
+
+	unsigned int pos = 0;
+	while (pos < m_numTransmitted && at(pos).seq != seq) {
+		pos++;
+	}
+	if (pos == m_numTransmitted) {
+		discardReceivedData(frameSize); // late reply of a request which has already failed
+		return true;
+	}
+
+	for (; pos > 0; pos--) {
+		if (at(0).replySize == 0) {
+			completeFront(true); // not answered by the board
+			m_unacknowledgedCount++;
+			continue;
+		}
+		m_lostReplyCount++;
+		completeFront(false);
+	}
+
+	request &req = at(0);
+	if (length + 1 != req.replySize || m_rxBuf[3] != req.msg[0]
+			|| m_rxBuf[4] != req.msg[1]) {
+		m_corruptReplyCount++;
+		discardReceivedData(frameSize);
+		completeFront(false);
+	} else {
+		acceptReply(m_rxBuf + 3);
+		m_rxCount -= frameSize;
+		memmove(m_rxBuf, m_rxBuf + frameSize, m_rxCount);
+		completeFront(true);
+	}
+	hasCompleted = true;
+	return true;
+}
+
+/**
+ * @brief copies the reply of the front request into its reply buffer in the v1 format, so the io entities
+ * evaluate it independent of the protocol version
+ * @param reply the reply, its checksum is replaced
+ */
+void serial::acceptReply(unsigned char const *reply) {
+	request &req = at(0);
+	m_latency.record(req.msg[0], req.msg[1],
+			toMicroseconds(req.firstByteTime - req.submitTime),
+			toMicroseconds(m_rxTime - req.submitTime));
+
+	unsigned char cs = 0;
+	for (unsigned int i = 0; i + 1 < req.replySize; i++) {
+		req.reply[i] = reply[i];
+		cs += reply[i];
+	}
+	req.reply[req.replySize - 1] = cs;
+
+	// the board has sent the reply with the previous framing and uses the new one from now on
+	if (req.msg[0] == CT_MISC && req.msg[1] == DT_MISC_PROTOCOL
+			&& req.reply[2] != MISC_NOK
+			&& (req.reply[3] == PROTOCOL_V1 || req.reply[3] == PROTOCOL_V2)) {
+		m_protocolVersion = req.reply[3];
+	}
+}
+
+/**
+ * @brief invokes the handler of the source of an event
+ * @param event payload of the event frame
+ * @param size number of bytes of the payload
+ */
+void serial::dispatchEvent(unsigned char const *event,
+		unsigned int const size) {
+	if (size < 3) {
+		return;
+	}
+
+	boost::recursive_mutex::scoped_lock lock(m_eventMutex);
+	std::map<unsigned int, eventHandler>::const_iterator it =
+			m_eventHandlers.find((event[0] << 8) | event[2]);
+	if (it == m_eventHandlers.end()) {
+		return;
+	}
+
+	// the handler may replace itself
+	eventHandler const handler = it->second;
+	handler(event, size);
+}
+
+/**
+ * @brief removes data from the front of the receive buffer
+ */
+void serial::discardReceivedData(unsigned int const numBytes) {
+	assert(numBytes <= m_rxCount);
+
+	m_rxCount -= numBytes;
+	memmove(m_rxBuf, m_rxBuf + numBytes, m_rxCount);
+	m_discardedByteCount += numBytes;
+}
+
+/**
+ * @brief starts the deadline timer for the oldest transmitted request
+ */
+void serial::armDeadline() {
+	if (m_isResynchronising) {
+		return; // the timer measures the guard time
+	}
+
+	m_timerGeneration++;
+	if (m_numTransmitted == 0) {
+		m_deadlineTimer.cancel();
+		return;
+	}
+
+	m_deadlineTimer.expires_at(at(0).deadline);
+	m_deadlineTimer.async_wait(
+			m_strand.wrap(
+					boost::bind(&serial::onDeadline, this,
+							boost::asio::placeholders::error,
+							m_timerGeneration)));
+}
+
+void serial::onDeadline(boost::system::error_code const &error,
+		unsigned long const generation) {
+	if (error || generation != m_timerGeneration) {
+		return; // the timer has been restarted in the meantime
+	}
+
+	if (m_isResynchronising) {
+		// the line has been quiet for the guard time, replies of requests written meanwhile are lost
+		m_isResynchronising = false;
+		failTransmitted();
+		armDeadline();
+		startWrite();
+		return;
+	}
+
+	if (m_numTransmitted == 0) {
+		return;
+	}
+
+	m_timeoutCount++;
+	if (at(0).isTimeoutReported) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, timeout while waiting for reply." << std::endl;
+	}
+
+	if (m_protocolVersion == PROTOCOL_V2) {
+		// the sequence ids still assign the replies of the other requests
+		completeFront(false);
+		completeUnacknowledged();
+		armDeadline();
+		startWrite();
+		return;
+	}
+
+	// the replies of the other transmitted requests cannot be assigned reliably anymore,
+	// so the input is discarded until the line is quiet
+	m_isResynchronising = true;
+	discardReceivedData(m_rxCount);
+	failTransmitted();
+
+	m_timerGeneration++;
+	m_deadlineTimer.expires_after(
+			boost::asio::chrono::milliseconds(resyncGuardTime_ms));
+	m_deadlineTimer.async_wait(
+			m_strand.wrap(
+					boost::bind(&serial::onDeadline, this,
+							boost::asio::placeholders::error,
+							m_timerGeneration)));
+}
+
+/**
+ * @brief fails all requests which have been transmitted and still wait for their reply
+ */
+void serial::failTransmitted() {
+	for (unsigned int numFailed = m_numTransmitted; numFailed > 0;
+			numFailed--) {
+		completeFront(false);
+	}
+}
+
+/**
+ * @brief removes the front request from the queue and invokes its handler
+ */
+void serial::completeFront(bool const ok) {
+	request &req = at(0);
+	m_head = (m_head + 1) % maxQueuedRequests;
+	m_numQueued--;
+	if (m_numTransmitted > 0) {
+		m_numTransmitted--;
+	}
+	if (!ok) {
+		m_latency.recordFailure(req.msg[0], req.msg[1]);
+	}
+
+	if (req.pCompletion != 0) {
+		signalCompletion(*req.pCompletion, ok);
+	}
+	if (req.handler) {
+		replyHandler handler;
+		handler.swap(req.handler);
+		m_numCompleting++; // keeps the reply buffer valid while the handler runs
+		handler(ok, req.reply, req.replySize);
+		m_numCompleting--;
+	}
 
+	if (--m_numPending == 0) {
+		boost::mutex::scoped_lock lock(m_pendingMutex);
+		m_allCompleted.notify_all();
+	}
+	if (isAsynchronous() && !m_submitted.empty()) {
+		postTakeOver(); // the completed request has freed a slot of the ring
+	}
 }
 
 /**
- * @brief write data to the serial port
+ * @brief completes the transmitted requests without a reply at the front of the queue, they are
+ * completed in order with the requests transmitted before them
+ * @return true if a request has been completed, false otherwise
  */
-void serial::writeToSerial(unsigned char const *buf, unsigned int const size) {
-	boost::asio::write(m_serial_port, boost::asio::buffer(buf, size));
+bool serial::completeUnacknowledged() {
+	bool hasCompleted = false;
+	while (m_numTransmitted > 0 && at(0).replySize == 0) {
+		completeFront(true);
+		m_unacknowledgedCount++;
+		hasCompleted = true;
+	}
+	return hasCompleted;
 }
 
 /**
- * @brief read data from the serial port
+ * @brief fails all queued requests after a communication error
  */
-boost::shared_ptr<unsigned char> serial::readFromSerial(unsigned int const size) {
-	boost::shared_ptr<unsigned char> buf(new unsigned char[size]);
+void serial::abort() {
+	boost::system::error_code ignored;
+	m_transport->cancel();
+	m_deadlineTimer.cancel(ignored);
+	if (m_numWriting > 0 || m_isReading || m_isAborting) {
+		return; // the pending operation completes with an error and calls abort again
+	}
 
-	boost::asio::read(m_serial_port, boost::asio::buffer(buf.get(), size));
+	// requests queued by the handlers of the failed requests are not affected unless the link is lost
+	m_isAborting = true;
+	m_isResynchronising = false;
+	m_rxCount = 0;
+	for (unsigned int numFailed = m_numQueued; numFailed > 0; numFailed--) {
+		completeFront(false);
+	}
+	while (m_isLinkLost && m_numQueued > 0) {
+		completeFront(false);
+	}
+	m_numTransmitted = 0;
+	m_isAborting = false;
 
-	return buf;
+	startRead();
+	if (!m_isLinkLost) {
+		startWrite();
+	}
 }
 
 } // end of namespace arduinoio
@@ -30,18 +30,74 @@
 #ifndef SERIAL_H_
 #define SERIAL_H_
 
+#include <map>
 #include <string>
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include "latencyStatistics.h"
+#include "tags.h"
+#include "transport.h"
 
 namespace arduinoio {
 
+/**
+ * @brief largest frame exchanged with the io board (i2c read reply with 255 data bytes)
+ */
+static unsigned int const maxFrameSize = 4 + 255;
+
+/**
+ * @brief number of requests which can be queued before a new request has to wait for a free slot
+ */
+static unsigned int const maxQueuedRequests = 32;
+
+/**
+ * @brief number of requests which can be submitted by the application threads before they are taken over by the io thread
+ */
+static unsigned int const maxSubmissions = 64;
+
+/**
+ * @brief time in ms a request waits for its reply after it has been transmitted
+ */
+static unsigned int const defaultTimeout_ms = 200;
+
+/**
+ * @brief completion handler of an asynchronous request
+ * @param ok true if a matching reply has been received, false otherwise
+ * @param reply pointer to the reply, only valid during the call of the handler
+ * @param size number of bytes of the reply
+ */
+typedef boost::function<void (bool const ok, unsigned char const *reply, unsigned int const size)> replyHandler;
+
+/**
+ * @brief handler of the events the board sends without a request
+ * @param event pointer to the payload of the event, [class tag, descriptor tag, source, data], only valid
+ * during the call of the handler
+ * @param size number of bytes of the payload
+ */
+typedef boost::function<void (unsigned char const *event, unsigned int const size)> eventHandler;
+
 class serial {
 public:
 	/**
 	 * @brief Constructor
+	 * @param t transport used for the communication with the io board, it is opened by the constructor
+	 * @param pIoService io service shared with other boards and run by threads of the application, all handlers
+	 * of this board are serialised by a strand and the requests are handed over like to the io thread.
+	 * The io service has to be running while requests are processed and must be stopped before the object
+	 * is destroyed. 0 creates an io service of its own.
 	 */
-	serial(std::string const &devNode, unsigned int const baudRate);
+	serial(boost::shared_ptr<transport> const &t,
+			boost::asio::io_service *pIoService = 0);
 
 	/**
 	 * @brief Destructor
@@ -49,20 +105,360 @@ public:
 	~serial();
 
 	/**
-	 * @brief write data to the serial port
+	 * @brief starts the io thread which processes the requests from now on, the requests are then handed over
+	 * from the calling threads via lock free queues, so the methods may be called by several threads concurrently.
+	 * The handlers of asynchronous requests are invoked by the io thread.
+	 */
+	void startIoThread();
+
+	/**
+	 * @brief stops the io thread, the requests not completed yet are processed by the calling threads again
+	 */
+	void stopIoThread();
+
+	/**
+	 * @brief transmits a request and waits for its reply
+	 * @param msg pointer to the complete request message including the checksum
+	 * @param msgSize number of bytes of the request message
+	 * @param reply buffer provided by the caller which receives the reply
+	 * @param replySize number of bytes of the expected reply
+	 * @param timeout_ms deadline for the reply after transmission, 0 selects the default timeout. Timeouts
+	 * of requests with a deadline of their own are only counted, the caller reports them.
+	 * @return true if a matching reply has been received, false otherwise
+	 */
+	bool transfer(unsigned char const *msg, unsigned int const msgSize,
+			unsigned char *reply, unsigned int const replySize,
+			unsigned int const timeout_ms = 0);
+
+	/**
+	 * @brief queues a request which is transmitted while other requests are still waiting for their reply
+	 * @param msg pointer to the complete request message including the checksum
+	 * @param msgSize number of bytes of the request message
+	 * @param replySize number of bytes of the expected reply
+	 * @param handler handler invoked once the reply has been received or the deadline has passed
+	 * @param timeout_ms deadline for the reply after transmission, 0 selects the default timeout
+	 */
+	void asyncRequest(unsigned char const *msg, unsigned int const msgSize,
+			unsigned int const replySize, replyHandler const &handler,
+			unsigned int const timeout_ms = 0);
+
+	/**
+	 * @brief transmits a request the board does not answer, e.g. DT_GPIO_WRITE_NOACK, and waits until it
+	 * has been passed to the transport. Such requests are only counted by the board, see DT_MISC_ERRORS.
+	 * @param msg pointer to the complete request message including the checksum
+	 * @param msgSize number of bytes of the request message
+	 * @return true if the request has been transmitted, false otherwise
+	 */
+	bool send(unsigned char const *msg, unsigned int const msgSize);
+
+	/**
+	 * @brief queues a request the board does not answer, it is transmitted together with the other requests
+	 * @param msg pointer to the complete request message including the checksum
+	 * @param msgSize number of bytes of the request message
+	 * @param handler handler invoked once the request has been transmitted or has failed, without a reply
+	 */
+	void asyncSend(unsigned char const *msg, unsigned int const msgSize,
+			replyHandler const &handler);
+
+	/**
+	 * @brief processes the queued requests until all of them have been completed, held requests are flushed
+	 */
+	void waitForAll();
+
+	/**
+	 * @brief holds back the transmission of new requests until flush is called, so they are combined into one write
+	 * e.g. the outputs set during one control cycle. transfer flushes the held requests together with its own one.
+	 */
+	void holdWrites();
+
+	/**
+	 * @brief transmits the requests held back since holdWrites
+	 */
+	void flush();
+
+	/**
+	 * @brief changes the baud rate of the transport after all queued requests have been completed
+	 * @return true in case of success, false in case of failure
+	 */
+	bool setBaudRate(unsigned int const baudRate);
+
+	/**
+	 * @brief changes the framing used by the host after all queued requests have been completed, e.g. when
+	 * the board has restarted with protocol v1. The framing negotiated with DT_MISC_PROTOCOL is switched
+	 * automatically as soon as the reply has been received.
+	 * @param version PROTOCOL_V1 or PROTOCOL_V2
+	 */
+	void setProtocolVersion(unsigned int const version);
+
+	/**
+	 * @brief returns the framing currently used for the requests, PROTOCOL_V1 or PROTOCOL_V2
+	 */
+	inline unsigned int getProtocolVersion() const {
+		return m_protocolVersion;
+	}
+
+	/**
+	 * @brief sets the handler of the events of a source, e.g. the edges of a subscribed gpio pin. The events
+	 * arrive as v2 frames with the sequence id FRAME_EVENT_SEQUENCE and are invoked by the io thread, events
+	 * without a handler are dropped.
+	 * @param classTag class tag of the event
+	 * @param source third byte of the event, e.g. the pin number
+	 * @param handler handler of the events, an empty handler removes the previous one. The previous handler
+	 * is not invoked anymore once the method has returned.
+	 */
+	void setEventHandler(unsigned char const classTag,
+			unsigned char const source, eventHandler const &handler);
+
+	/**
+	 * @brief returns true if the transport has failed, e.g. the device has disappeared. All requests fail
+	 * until the transport has been reopened by reconnect.
+	 */
+	inline bool isLinkLost() const {
+		return m_isLinkLost;
+	}
+
+	/**
+	 * @brief reopens the transport after the link has been lost
+	 * @return true in case of success, false in case of failure
+	 */
+	bool reconnect();
+
+	/**
+	 * @brief returns the number of requests which have not been completed yet
+	 */
+	inline unsigned int getPendingCount() const {
+		return m_numPending;
+	}
+
+	/**
+	 * @brief sets the maximum number of requests transmitted without having received their reply,
+	 * independent of this limit the requests and replies in flight never exceed the uart buffers of the firmware
+	 */
+	void setMaxInFlight(unsigned int const maxInFlight);
+
+	/**
+	 * @brief sets the sizes of the uart buffers of the firmware, the requests and the replies in flight
+	 * never exceed them
+	 * @param rxBufferSize size of the receive buffer of the firmware
+	 * @param txBufferSize size of the transmit buffer of the firmware
+	 */
+	void setFirmwareBufferSizes(unsigned int const rxBufferSize,
+			unsigned int const txBufferSize);
+
+	/**
+	 * @brief sets the default deadline for replies
+	 * @param timeout_ms time in ms a request waits for its reply after it has been transmitted
+	 */
+	void setTimeout(unsigned int const timeout_ms);
+
+	/**
+	 * @brief returns the number of requests which failed since their deadline has passed
+	 */
+	inline unsigned long getTimeoutCount() const {
+		return m_timeoutCount;
+	}
+
+	/**
+	 * @brief returns the number of received bytes discarded during resynchronisation
+	 */
+	inline unsigned long getDiscardedByteCount() const {
+		return m_discardedByteCount;
+	}
+
+	/**
+	 * @brief returns the number of replies with a wrong checksum or crc, or not matching their request
+	 */
+	inline unsigned long getCorruptReplyCount() const {
+		return m_corruptReplyCount;
+	}
+
+	/**
+	 * @brief returns the number of replies the board has sent but the host has not received, v2 only
 	 */
-	void writeToSerial(unsigned char const *buf, unsigned int const size);
+	inline unsigned long getLostReplyCount() const {
+		return m_lostReplyCount;
+	}
 
 	/**
-	 * @brief read data from the serial port
+	 * @brief returns the number of requests without a reply which have been transmitted
 	 */
-	boost::shared_ptr<unsigned char> readFromSerial(unsigned int const size);
+	inline unsigned long getUnacknowledgedCount() const {
+		return m_unacknowledgedCount;
+	}
+
+	/**
+	 * @brief returns the io service processing the requests, the board runs its supervision on it
+	 */
+	inline boost::asio::io_service &getIoService() {
+		return m_io_service;
+	}
+
+	/**
+	 * @brief returns the latencies of the requests per operation, they can be read while requests are processed
+	 */
+	inline latencyStatistics &getLatencyStatistics() {
+		return m_latency;
+	}
 
 private:
-	std::string m_devNode;
-	unsigned int m_baudRate;
-	boost::asio::io_service m_io_service;
-	boost::asio::serial_port m_serial_port;
+	typedef boost::asio::steady_timer::clock_type clock;
+
+	/**
+	 * @brief slot a caller waits on for the completion of its request, every calling thread owns one
+	 */
+	struct completion {
+		boost::atomic<bool> done;
+		bool ok;
+		boost::mutex mutex;
+		boost::condition_variable cond;
+	};
+
+	enum E_SUBMISSION {
+		SUBMIT_REQUEST, SUBMIT_HOLD, SUBMIT_FLUSH
+	};
+
+	/**
+	 * @brief request or command handed over from an application thread to the io thread
+	 */
+	struct submission {
+		E_SUBMISSION type;
+		unsigned char msg[maxFrameSize];
+		unsigned int msgSize;
+		unsigned char *reply;
+		unsigned int replySize;
+		unsigned int timeout_ms;
+		clock::time_point submitTime;
+		replyHandler handler;
+		completion *pCompletion;
+	};
+
+	typedef boost::lockfree::queue<submission *,
+			boost::lockfree::capacity<maxSubmissions> > submissionQueue;
+
+	struct request {
+		unsigned char msg[maxFrameSize];
+		unsigned int msgSize;
+		unsigned char wire[maxFrameSize - 1 + FRAME_OVERHEAD]; // v2 frame of the request
+		unsigned char const *pWire; // either msg or wire, set when the request is transmitted
+		unsigned int wireSize;
+		unsigned int wireReplySize;
+		unsigned char seq; // sequence id of the v2 frame
+		unsigned char frame[maxFrameSize]; // pooled reply buffer
+		unsigned char *reply; // either frame or the buffer of the caller
+		unsigned int replySize;
+		unsigned int timeout_ms;
+		bool isTimeoutReported; // requests with a deadline of their own leave the report to the caller
+		clock::time_point submitTime;
+		clock::time_point firstByteTime;
+		bool hasFirstByte; // the first byte of the reply has been received
+		clock::time_point deadline;
+		replyHandler handler;
+		completion *pCompletion;
+	};
+
+	boost::scoped_ptr<boost::asio::io_service> m_pOwnIoService;
+	boost::asio::io_service &m_io_service;
+	boost::asio::io_service::strand m_strand; // serialises all handlers of this board
+	boost::shared_ptr<transport> m_transport;
+	boost::asio::steady_timer m_deadlineTimer;
+
+	request m_requests[maxQueuedRequests]; // ring of requests in transmission order
+	unsigned int m_head;
+	unsigned int m_numQueued;
+	unsigned int m_numCompleting; // requests whose handlers are running
+	unsigned int m_numTransmitted; // requests of the queue already written to the port
+	unsigned int m_maxInFlight;
+	unsigned int m_rxBufferSize; // uart buffers of the firmware
+	unsigned int m_txBufferSize;
+	unsigned int m_timeout_ms;
+	unsigned long m_timerGeneration; // identifies the current wait of the deadline timer
+	boost::asio::const_buffer m_writeBuffers[maxQueuedRequests]; // requests combined into the current write
+	unsigned int m_numWriting;
+	bool m_isHolding; // new requests are not transmitted before flush is called
+	bool m_isReading;
+	bool m_isAborting;
+	boost::atomic<bool> m_isLinkLost;
+	bool m_isResynchronising; // discarding input until the line is quiet after a timeout
+	boost::atomic<unsigned int> m_protocolVersion;
+	unsigned char m_nextSeq;
+	boost::recursive_mutex m_eventMutex; // held while an event handler runs
+	std::map<unsigned int, eventHandler> m_eventHandlers; // by class tag and source
+
+	unsigned char m_rxBuf[2 * maxFrameSize]; // received bytes not yet assigned to a request
+	unsigned int m_rxCount;
+	clock::time_point m_rxTime; // time at which the data of the current read has been received
+
+	boost::atomic<unsigned long> m_timeoutCount;
+	boost::atomic<unsigned long> m_discardedByteCount;
+	boost::atomic<unsigned long> m_corruptReplyCount;
+	boost::atomic<unsigned long> m_lostReplyCount;
+	boost::atomic<unsigned long> m_unacknowledgedCount;
+	latencyStatistics m_latency;
+
+	boost::atomic<unsigned int> m_numPending; // submitted or queued requests not completed yet
+	boost::mutex m_pendingMutex;
+	boost::condition_variable m_allCompleted;
+
+	submission m_submissions[maxSubmissions];
+	submissionQueue m_freeSubmissions;
+	submissionQueue m_submitted; // in submission order, taken over by the io thread
+	boost::atomic<bool> m_isTakeOverPosted;
+	boost::scoped_ptr<boost::asio::io_service::work> m_work;
+	boost::scoped_ptr<boost::thread> m_ioThread;
+	boost::thread::id m_ioThreadId;
+	boost::atomic<bool> m_hasIoThread; // set by the io thread after m_ioThreadId, read by all threads
+
+	static boost::thread_specific_ptr<completion> s_callerCompletion;
+
+	inline request &at(unsigned int const i) {
+		return m_requests[(m_head + i) % maxQueuedRequests];
+	}
+
+	// the requests are handed over to the io service instead of being processed by the calling thread
+	inline bool isAsynchronous() const {
+		return !m_pOwnIoService || m_hasIoThread;
+	}
+
+	// slots of requests whose handlers are still running must not be reused,
+	// neither the slots being written which may already have been completed
+	inline bool isRingFull() const {
+		return m_numQueued + m_numCompleting + m_numWriting >= maxQueuedRequests;
+	}
+
+	request &enqueue(unsigned char const *msg, unsigned int const msgSize,
+			unsigned int const replySize, unsigned int const timeout_ms);
+	void runOne();
+	void runIoThread(completion *pStarted);
+	submission *acquireSubmission();
+	void submit(submission *pSub);
+	void postTakeOver();
+	void takeOverSubmissions();
+	completion &callerCompletion();
+	void waitForCompletion(completion &c);
+	static void signalCompletion(completion &c, bool const ok);
+	void onSetBaudRate(unsigned int const baudRate, completion *pCompletion);
+	void onReconnect(completion *pCompletion);
+	void onSetProtocolVersion(unsigned int const version,
+			completion *pCompletion);
+	void buildWire(request &req);
+	void startWrite();
+	void onWrite(boost::system::error_code const &error);
+	void startRead();
+	void onRead(boost::system::error_code const &error,
+			std::size_t const bytesTransferred);
+	void processReceivedData();
+	bool receiveReply(bool &hasCompleted);
+	bool receiveFrame(bool &hasCompleted);
+	void acceptReply(unsigned char const *payload);
+	void dispatchEvent(unsigned char const *event, unsigned int const size);
+	void discardReceivedData(unsigned int const numBytes);
+	void armDeadline();
+	void onDeadline(boost::system::error_code const &error,
+			unsigned long const generation);
+	void failTransmitted();
+	void completeFront(bool const ok);
+	bool completeUnacknowledged();
+	void abort();
 };
 
 } // end of namespace arduinoio
@@ -0,0 +1,180 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "serialPortTransport.h"
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ * @param devNode string designating the used device node for communication
+ * @param baudRate baud rate of the serial port
+ * @param lowLatency configures the port for minimal latency when it is opened
+ */
+serialPortTransport::serialPortTransport(std::string const &devNode,
+		unsigned int const baudRate, bool const lowLatency) :
+		m_devNode(devNode), m_baudRate(baudRate), m_lowLatency(lowLatency) {
+	lowLatencyStatus const status = { false, false, false, false };
+	m_lowLatencyStatus = status;
+}
+
+/**
+ * @brief Destructor
+ */
+serialPortTransport::~serialPortTransport() {
+
+}
+
+bool serialPortTransport::open(boost::asio::io_service::strand &strand) {
+	m_serial_port.reset(new boost::asio::serial_port(strand.context()));
+
+	boost::system::error_code error;
+	m_serial_port->open(m_devNode, error);
+	if (error) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, could not open "
+				<< m_devNode << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	try {
+		m_serial_port->set_option(
+				boost::asio::serial_port_base::baud_rate(m_baudRate));
+		m_serial_port->set_option(
+				boost::asio::serial_port_base::character_size(8));
+		m_serial_port->set_option(
+				boost::asio::serial_port_base::flow_control(
+						boost::asio::serial_port_base::flow_control::none));
+		m_serial_port->set_option(
+				boost::asio::serial_port_base::parity(
+						boost::asio::serial_port_base::parity::none));
+		m_serial_port->set_option(
+				boost::asio::serial_port_base::stop_bits(
+						boost::asio::serial_port_base::stop_bits::one));
+	} catch (boost::system::system_error const &e) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not configure " << m_devNode << ": "
+				<< e.what() << std::endl;
+		return false;
+	}
+
+	if (m_lowLatency) {
+		configureLowLatency();
+	}
+
+	return true;
+}
+
+void serialPortTransport::asyncWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	assert(m_serial_port);
+	boost::asio::async_write(*m_serial_port,
+			constBufferRange(buffers, numBuffers), handler);
+}
+
+void serialPortTransport::asyncReadSome(unsigned char *data,
+		std::size_t const size, ioHandler const &handler) {
+	assert(m_serial_port);
+	m_serial_port->async_read_some(boost::asio::buffer(data, size), handler);
+}
+
+void serialPortTransport::cancel() {
+	if (m_serial_port) {
+		boost::system::error_code ignored;
+		m_serial_port->cancel(ignored);
+	}
+}
+
+bool serialPortTransport::setBaudRate(unsigned int const baudRate) {
+	if (!m_serial_port) {
+		return false;
+	}
+
+	boost::system::error_code error;
+	m_serial_port->set_option(
+			boost::asio::serial_port_base::baud_rate(baudRate), error);
+	if (error) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not set the baud rate of " << m_devNode
+				<< " to " << baudRate << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	m_baudRate = baudRate;
+	return true;
+}
+
+/**
+ * @brief configures the file descriptor of the port for minimal latency, settings which are not supported are skipped
+ */
+void serialPortTransport::configureLowLatency() {
+	int const fd = m_serial_port->native_handle();
+
+	// asio reads non blocking, VMIN = 1 and VTIME = 0 wake it on the first received byte without inter byte timer
+	struct termios tio;
+	if (tcgetattr(fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		tio.c_cflag |= CLOCAL | CREAD;
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		m_lowLatencyStatus.isRaw = (tcsetattr(fd, TCSANOW, &tio) == 0);
+	}
+
+	// the driver passes received data to the tty layer immediately instead of deferring it to a work queue
+	struct serial_struct ss;
+	if (ioctl(fd, TIOCGSERIAL, &ss) == 0) {
+		ss.flags |= ASYNC_LOW_LATENCY;
+		m_lowLatencyStatus.isLowLatency = (ioctl(fd, TIOCSSERIAL, &ss) == 0);
+	}
+
+	m_lowLatencyStatus.isExclusive = (ioctl(fd, TIOCEXCL) == 0);
+
+	// usb serial adapters like the ftdi chips buffer received data up to their latency timer, 16 ms by default
+	char realPath[PATH_MAX];
+	if (realpath(m_devNode.c_str(), realPath) != 0) {
+		std::string const path(realPath);
+		std::string const latencyTimer = "/sys/bus/usb-serial/devices/"
+				+ path.substr(path.find_last_of('/') + 1) + "/latency_timer";
+		std::ofstream file(latencyTimer.c_str());
+		if (file) {
+			file << 1 << std::endl;
+			m_lowLatencyStatus.isLatencyTimerSet = file.good();
+		}
+	}
+}
+
+} // end of namespace arduinoio
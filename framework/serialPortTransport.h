@@ -0,0 +1,93 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SERIALPORTTRANSPORT_H_
+#define SERIALPORTTRANSPORT_H_
+
+#include "transport.h"
+#include <string>
+#include <boost/scoped_ptr.hpp>
+
+namespace arduinoio {
+
+/**
+ * @class serialPortTransport
+ * @brief transport via a serial device node, e.g. /dev/ttyUSB0 or the slave side of a pseudo terminal
+ */
+class serialPortTransport : public transport {
+public:
+	/**
+	 * @brief settings of the low latency mode which have taken effect
+	 */
+	struct lowLatencyStatus {
+		bool isRaw; // raw termios, VMIN = 1 and VTIME = 0
+		bool isLowLatency; // ASYNC_LOW_LATENCY of the serial driver
+		bool isExclusive; // TIOCEXCL, no other process can open the port
+		bool isLatencyTimerSet; // latency timer of a usb serial adapter set to 1 ms
+	};
+
+	/**
+	 * @brief Constructor
+	 * @param devNode string designating the used device node for communication
+	 * @param baudRate baud rate of the serial port
+	 * @param lowLatency configures the port for minimal latency when it is opened
+	 */
+	serialPortTransport(std::string const &devNode, unsigned int const baudRate, bool const lowLatency = false);
+
+	/**
+	 * @brief Destructor
+	 */
+	~serialPortTransport();
+
+	bool open(boost::asio::io_service::strand &strand);
+	void asyncWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler);
+	void asyncReadSome(unsigned char *data, std::size_t const size, ioHandler const &handler);
+	void cancel();
+	bool setBaudRate(unsigned int const baudRate);
+
+	/**
+	 * @brief returns the settings of the low latency mode which have taken effect, all false if the mode is off
+	 */
+	inline lowLatencyStatus const &getLowLatencyStatus() const {
+		return m_lowLatencyStatus;
+	}
+
+private:
+	std::string m_devNode;
+	unsigned int m_baudRate;
+	bool m_lowLatency;
+	lowLatencyStatus m_lowLatencyStatus;
+	boost::scoped_ptr<boost::asio::serial_port> m_serial_port;
+
+	void configureLowLatency();
+};
+
+} // end of namespace arduinoio
+
+#endif /* SERIALPORTTRANSPORT_H_ */
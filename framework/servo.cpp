@@ -31,6 +31,7 @@
 #include "tags.h"
 #include <assert.h>
 #include <iostream>
+#include <boost/bind/bind.hpp>
 
 namespace arduinoio {
 
@@ -42,7 +43,7 @@ namespace arduinoio {
  */
 servo::servo(boost::shared_ptr<serial> const &serial, E_PIN const p,
 		unsigned int const pulseWidth_us) :
-		ioentity(serial), m_pulseWidth_us(pulseWidth_us) {
+		ioentity(serial), m_pulseWidth_us(pulseWidth_us), m_isAcknowledged(true) {
 
 	assert(m_pulseWidth_us <= maxPulseWidth);
 	assert(m_pulseWidth_us >= minPulseWidth);
@@ -50,6 +51,9 @@ servo::servo(boost::shared_ptr<serial> const &serial, E_PIN const p,
 			p == SW_SERVO_PIN_1 || p == SW_SERVO_PIN_2 || p == SW_SERVO_PIN_3 || p == SW_SERVO_PIN_4 || p == SW_SERVO_PIN_5 || p == SW_SERVO_PIN_6 || p == HW_SERVO_PIN_1 || p == HW_SERVO_PIN_2);
 
 	m_pinVect.push_back(p);
+
+	// the pulse width is kept in the unit of the firmware, so the configuration can be repeated
+	m_pulseWidth_us = convertPulseWidth(pulseWidth_us);
 }
 
 /**
@@ -60,63 +64,152 @@ servo::~servo() {
 }
 
 /**
- * @brief configures the servo
- * @return true in case of success, false in case of failure
+ * @brief builds the request which configures the servo with its current pulse width
+ * @param msg buffer receiving the request
+ * @return number of bytes of the request
  */
-bool servo::config() {
-	// in case of SERVO_PIN_1 and 2 we need to take special care, since its based on a 8bit timer
-	if (m_pinVect[0] == SW_SERVO_PIN_1 || m_pinVect[0] == SW_SERVO_PIN_2
-			|| m_pinVect[0] == SW_SERVO_PIN_3 || m_pinVect[0] == SW_SERVO_PIN_4
-			|| m_pinVect[0] == SW_SERVO_PIN_5
-			|| m_pinVect[0] == SW_SERVO_PIN_6) {
-		m_pulseWidth_us = m_pulseWidth_us / 100;
-	}
-
-	// send request string
+unsigned int servo::buildConfigRequest(unsigned char *msg) const {
 	unsigned char pinNumber = m_pinVect[0].getPinNumber();
-	int const msgSize = 6;
 	unsigned char const lowByte = (unsigned char) (m_pulseWidth_us & 0xFF);
 	unsigned char const highByte = (unsigned char) ((m_pulseWidth_us >> 8)
 			& 0xFF);
 
-	unsigned char msg[msgSize] = { CT_SERVO, DT_SERVO_CONFIG, pinNumber,
-			lowByte, highByte, CT_SERVO + DT_SERVO_CONFIG + pinNumber + lowByte
-					+ highByte };
-	m_serial->writeToSerial(msg, msgSize);
+	msg[0] = CT_SERVO;
+	msg[1] = DT_SERVO_CONFIG;
+	msg[2] = pinNumber;
+	msg[3] = lowByte;
+	msg[4] = highByte;
+	msg[5] = CT_SERVO + DT_SERVO_CONFIG + pinNumber + lowByte + highByte;
+	return 6;
+}
 
-	// retrieve answer and evaluate it
-	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
+/**
+ * @brief sets the width of the servo pwm pulse
+ * @param pulseWidth_us pulse width of the servo pulse in us (should be between 1000 and 2000 us)
+ */
+bool servo::setPwm(unsigned int const pulseWidth_us) {
 
-	if (reply.get()[0] != CT_SERVO || reply.get()[1] != DT_SERVO_CONFIG) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in request reply message."
-				<< std::endl;
+	if (!isConfigured())
 		return false;
+
+	unsigned int const tmpPulseWidth = convertPulseWidth(pulseWidth_us);
+
+	// send request string
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	int const msgSize = 6;
+	unsigned char const lowByte = (unsigned char) (tmpPulseWidth & 0xFF);
+	unsigned char const highByte = (unsigned char) ((tmpPulseWidth >> 8) & 0xFF);
+
+	unsigned char const dt = selectSetTag();
+	unsigned char msg[msgSize] = { CT_SERVO, dt, pinNumber, lowByte, highByte,
+			(unsigned char) (CT_SERVO + dt + pinNumber + lowByte + highByte) };
+
+	if (dt == DT_SERVO_SET_NOACK) {
+		if (!m_serial->send(msg, msgSize)) {
+			return false;
+		}
+		m_pulseWidth_us = tmpPulseWidth;
+		return true;
 	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
+
+	// retrieve answer and evaluate it
+	int const replySize = 4;
+	unsigned char reply[replySize];
+	if (!m_serial->transfer(msg, msgSize, reply, replySize)) {
 		return false;
 	}
-	if (reply.get()[2] == SERVO_NOK) {
+	if (!evaluateSetPwm(reply)) {
 		return false;
 	}
 
-	setIsConfiguredFlag();
+	m_pulseWidth_us = tmpPulseWidth;
 
 	return true;
 }
 
 /**
- * @brief sets the width of the servo pwm pulse
+ * @brief sets the width of the servo pwm pulse without waiting for the reply
  * @param pulseWidth_us pulse width of the servo pulse in us (should be between 1000 and 2000 us)
+ * @param handler handler invoked with the result once the reply has been received
  */
-bool servo::setPwm(unsigned int const pulseWidth_us) {
+void servo::setPwm(unsigned int const pulseWidth_us,
+		resultHandler const &handler) {
 
-	if (!isConfigured())
-		return false;
+	if (!isConfigured()) {
+		if (handler) handler(false);
+		return;
+	}
+
+	unsigned int const tmpPulseWidth = convertPulseWidth(pulseWidth_us);
+
+	// queue request string
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	int const msgSize = 6;
+	unsigned char const lowByte = (unsigned char) (tmpPulseWidth & 0xFF);
+	unsigned char const highByte = (unsigned char) ((tmpPulseWidth >> 8) & 0xFF);
+
+	unsigned char const dt = selectSetTag();
+	unsigned char msg[msgSize] = { CT_SERVO, dt, pinNumber, lowByte, highByte,
+			(unsigned char) (CT_SERVO + dt + pinNumber + lowByte + highByte) };
+	replyHandler const onSet = boost::bind(&servo::onPwmSet,
+			boost::static_pointer_cast<servo>(shared_from_this()),
+			tmpPulseWidth, handler, boost::placeholders::_1,
+			boost::placeholders::_2, boost::placeholders::_3);
+	if (dt == DT_SERVO_SET_NOACK) {
+		m_serial->asyncSend(msg, msgSize, onSet);
+		return;
+	}
+	int const replySize = 4;
+	m_serial->asyncRequest(msg, msgSize, replySize, onSet);
+}
 
+/**
+ * @brief appends the request setting the width of the servo pwm pulse to a batch
+ * @param pulseWidth_us pulse width of the servo pulse in us (should be between 1000 and 2000 us)
+ * @param b batch of the board the servo belongs to
+ * @param handler handler invoked with the result once the batch has been executed
+ */
+void servo::setPwm(unsigned int const pulseWidth_us, batch &b,
+		resultHandler const &handler) {
+
+	if (!isConfigured()) {
+		if (handler) handler(false);
+		return;
+	}
+
+	unsigned int const tmpPulseWidth = convertPulseWidth(pulseWidth_us);
+
+	unsigned char pinNumber = m_pinVect[0].getPinNumber();
+	int const msgSize = 6;
+	unsigned char const lowByte = (unsigned char) (tmpPulseWidth & 0xFF);
+	unsigned char const highByte = (unsigned char) ((tmpPulseWidth >> 8) & 0xFF);
+
+	unsigned char msg[msgSize] = { CT_SERVO, DT_SERVO_SET, pinNumber, lowByte,
+			highByte, (unsigned char) (CT_SERVO + DT_SERVO_SET + pinNumber
+					+ lowByte + highByte) };
+	int const replySize = 4;
+	b.add(msg, msgSize, replySize,
+			boost::bind(&servo::onPwmSet,
+					boost::static_pointer_cast<servo>(shared_from_this()),
+					tmpPulseWidth, handler, boost::placeholders::_1,
+					boost::placeholders::_2, boost::placeholders::_3));
+}
+
+/**
+ * @brief returns the descriptor tag of the set request, only boards using protocol v2 know the
+ * unacknowledged set
+ */
+unsigned char servo::selectSetTag() const {
+	if (!m_isAcknowledged && m_serial->getProtocolVersion() == PROTOCOL_V2) {
+		return DT_SERVO_SET_NOACK;
+	}
+	return DT_SERVO_SET;
+}
+
+/**
+ * @brief limits the pulse width and converts it into the value expected by the firmware
+ */
+unsigned int servo::convertPulseWidth(unsigned int const pulseWidth_us) const {
 	unsigned int tmpPulseWidth = 0;
 
 	if (pulseWidth_us > maxPulseWidth)
@@ -134,40 +227,31 @@ bool servo::setPwm(unsigned int const pulseWidth_us) {
 		tmpPulseWidth = tmpPulseWidth / 100;
 	}
 
-	// send request string
-	unsigned char pinNumber = m_pinVect[0].getPinNumber();
-	int const msgSize = 6;
-	unsigned char const lowByte = (unsigned char) (tmpPulseWidth & 0xFF);
-	unsigned char const highByte = (unsigned char) ((tmpPulseWidth >> 8) & 0xFF);
-
-	unsigned char msg[msgSize] = { CT_SERVO, DT_SERVO_SET, pinNumber, lowByte,
-			highByte, CT_SERVO + DT_SERVO_SET + pinNumber + lowByte + highByte };
-	m_serial->writeToSerial(msg, msgSize);
-
-	// retrieve answer and evaluate it
-	int const replySize = 4;
-	boost::shared_ptr<unsigned char> reply = m_serial->readFromSerial(
-			replySize);
+	return tmpPulseWidth;
+}
 
-	if (reply.get()[0] != CT_SERVO || reply.get()[1] != DT_SERVO_SET) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in request reply message."
-				<< std::endl;
-		return false;
-	}
-	if (!isChecksumOk(reply.get(), replySize)) {
-		std::cerr << __FILE__ << ":" << __LINE__ << " Error in checksum."
-				<< std::endl;
-		return false;
-	}
-	if (reply.get()[2] == SERVO_NOK) {
+/**
+ * @brief evaluates the reply to a servo set request
+ */
+bool servo::evaluateSetPwm(unsigned char const *reply) {
+	if (reply[2] == SERVO_NOK) {
 		return false;
 	}
 
-	m_pulseWidth_us = tmpPulseWidth;
-
 	return true;
 }
 
+void servo::onPwmSet(unsigned int const pwm, resultHandler const &handler,
+		bool const ok, unsigned char const *reply, unsigned int const size) {
+	bool const success = ok && (size == 0 || evaluateSetPwm(reply)); // unacknowledged without a reply
+	if (success) {
+		m_pulseWidth_us = pwm;
+	}
+	if (handler) {
+		handler(success);
+	}
+}
+
 /**
  * @brief returns the current pwm pulse widht setting
  * @return pulsewidth in us
@@ -32,6 +32,7 @@
 
 #include "pin.h"
 #include "ioentity.h"
+#include <boost/atomic.hpp>
 
 namespace arduinoio {
 
@@ -58,16 +59,36 @@ public:
 	virtual ~servo();
 
 	/**
-	 * @brief configures the servo
-	 * @return true in case of success, false in case of failure
+	 * @brief sets the width of the servo pwm pulse
+	 * @param pulseWidth_us pulse width of the servo pulse in us (should be between 1000 and 2000 us)
 	 */
-	virtual bool config();
+	bool setPwm(unsigned int const pulseWidth_us);
 
 	/**
-	 * @brief sets the width of the servo pwm pulse
+	 * @brief sets the width of the servo pwm pulse without waiting for the reply
 	 * @param pulseWidth_us pulse width of the servo pulse in us (should be between 1000 and 2000 us)
+	 * @param handler handler invoked with the result once the reply has been received
 	 */
-	bool setPwm(unsigned int const pulseWidth_us);
+	void setPwm(unsigned int const pulseWidth_us, resultHandler const &handler);
+
+	/**
+	 * @brief appends the request setting the width of the servo pwm pulse to a batch
+	 * @param pulseWidth_us pulse width of the servo pulse in us (should be between 1000 and 2000 us)
+	 * @param b batch of the board the servo belongs to
+	 * @param handler handler invoked with the result once the batch has been executed
+	 */
+	void setPwm(unsigned int const pulseWidth_us, batch &b,
+			resultHandler const &handler);
+
+	/**
+	 * @brief selects whether the board acknowledges the pulse widths set by setPwm, e.g. a stream of
+	 * set points does not need to wait for every reply. Unacknowledged pulse widths are reported as set once
+	 * they have been transmitted. Boards using protocol v1 and batches always acknowledge them.
+	 * @param isAcknowledged true = wait for the reply (default), false = do not expect a reply
+	 */
+	inline void setAcknowledged(bool const isAcknowledged) {
+		m_isAcknowledged = isAcknowledged;
+	}
 
 	/**
 	 * @brief returns the current pwm pulse widht setting
@@ -75,8 +96,18 @@ public:
 	 */
 	unsigned int getPwm() const;
 
+protected:
+	virtual unsigned int buildConfigRequest(unsigned char *msg) const;
+
 private:
-	unsigned int m_pulseWidth_us; // pwm pulse width in us
+	unsigned int m_pulseWidth_us; // pwm pulse width in the unit of the firmware, see convertPulseWidth
+	boost::atomic<bool> m_isAcknowledged;
+
+	unsigned int convertPulseWidth(unsigned int const pulseWidth_us) const;
+	unsigned char selectSetTag() const;
+	static bool evaluateSetPwm(unsigned char const *reply);
+	void onPwmSet(unsigned int const pwm, resultHandler const &handler,
+			bool const ok, unsigned char const *reply, unsigned int const size);
 };
 
 } // end of namespace arduinoio
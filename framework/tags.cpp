@@ -38,7 +38,7 @@ namespace arduinoio {
  * @param length length of the message
  * @return true if checksum is okay, false otherwise
  */
-bool isChecksumOk(unsigned char *pMsg, int const length) {
+bool isChecksumOk(unsigned char const *pMsg, int const length) {
 	assert(pMsg != 0);
 
 	unsigned char cs = 0;
@@ -51,4 +51,26 @@ bool isChecksumOk(unsigned char *pMsg, int const length) {
 	else 						return true;
 }
 
+/**
+ * @brief computes the crc-16 of protocol v2 (polynomial 0x1021, initial value 0xFFFF)
+ * @param pData pointer to the data
+ * @param length number of bytes
+ * @param crc crc of the preceding data, allows to compute it piecewise
+ * @return crc of the data
+ */
+unsigned short computeCrc16(unsigned char const *pData, int const length,
+		unsigned short crc) {
+	assert(pData != 0 || length == 0);
+
+	for (int i = 0; i < length; i++) {
+		crc ^= (unsigned short) (pData[i] << 8);
+		for (int bit = 0; bit < 8; bit++) {
+			if (crc & 0x8000) crc = (unsigned short) ((crc << 1) ^ 0x1021);
+			else 				crc = (unsigned short) (crc << 1);
+		}
+	}
+
+	return crc;
+}
+
 } // end of namespace arduinoio
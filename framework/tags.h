@@ -39,14 +39,34 @@ namespace arduinoio {
 #define CT_I2C				(0x04)
 #define CT_SERVO			(0x05)
 #define CT_COUNTER			(0x06)
+#define CT_BATCH			(0x07)
 
 // descriptor tags
 #define DT_MISC_RESET		(0x01)
 #define DT_MISC_ID			(0x02)
 #define DT_MISC_TEMP		(0x03)
-#define DT_GPIO_CONFIG 		(0x01)
+#define DT_MISC_BAUD		(0x04)
+#define DT_MISC_BAUD_CONFIRM	(0x05)
+#define DT_MISC_RESTARTED	(0x06)
+#define DT_MISC_PROTOCOL	(0x07)
+#define DT_MISC_CAPABILITIES	(0x08)
+#define DT_MISC_ERRORS		(0x09)
+#define DT_GPIO_CONFIG 		(0x01) // [pin, options, debounce time in ms if GPIO_CONFIG_OPTIONS_DEBOUNCE]
 #define DT_GPIO_READ 		(0x02)
 #define DT_GPIO_WRITE 		(0x03)
+#define DT_GPIO_SUBSCRIBE	(0x04) // [pin, events | edge recording << 1]
+#define DT_GPIO_EVENT		(0x05) // unsolicited, [CT_GPIO, DT_GPIO_EVENT, pin number, value | rise << 1 | fall << 2]
+#define DT_GPIO_WRITE_NOACK	(0x06) // like DT_GPIO_WRITE without a reply, counted by DT_MISC_ERRORS
+#define DT_GPIO_READ_PORT	(0x07) // [mask lo, mask hi], reply [inputs, values, rises, falls], 16 bit each
+#define DT_GPIO_WRITE_PORT	(0x08) // [mask lo, mask hi, values lo, values hi], reply [outputs lo, outputs hi]
+#define DT_GPIO_READ_EDGES	(0x09) // reply [lost lo, lost hi, count, GPIO_EDGE_RECORDS records of the recorded edges]
+#define DT_GPIO_READ_COUNTS	(0x0A) // [pin], reply [value | rise << 1 | fall << 2, rises lo, rises hi, falls lo, falls hi]
+
+#define GPIO_SUBSCRIBE_EVENTS	(0x01)
+#define GPIO_SUBSCRIBE_EDGES	(0x02)
+#define GPIO_EDGE_RECORDS		(8) // records of every DT_GPIO_READ_EDGES reply, unused ones are zero
+#define GPIO_EDGE_QUEUE_SIZE	(32) // edges queued by the board
+#define GPIO_EDGE_RECORD_SIZE	(5) // pin number | rising << 7, time in us little endian
 #define DT_ANALOG_READ	 	(0x02)
 #define DT_ANALOG_READ_ALL	(0x03)
 #define DT_I2C_CONFIG		(0x01)
@@ -54,8 +74,19 @@ namespace arduinoio {
 #define DT_I2C_WRITE		(0x03)
 #define DT_SERVO_CONFIG		(0x01)
 #define DT_SERVO_SET		(0x02)
+#define DT_SERVO_SET_NOACK	(0x03) // like DT_SERVO_SET without a reply, counted by DT_MISC_ERRORS
 #define DT_COUNTER_CONFIG	(0x01)
 #define DT_COUNTER_READ		(0x02)
+#define DT_BATCH_EXECUTE	(0x01)
+
+// protocol versions
+#define PROTOCOL_V1			(1) // [class tag, descriptor tag, arguments, additive checksum]
+#define PROTOCOL_V2			(2) // [start byte, length, sequence id, class tag, descriptor tag, arguments, crc-16]
+
+// framing of protocol v2
+#define FRAME_START			(0xA5)
+#define FRAME_OVERHEAD		(5) // start byte, length, sequence id and crc-16 replace the additive checksum
+#define FRAME_EVENT_SEQUENCE	(0xFF) // sequence id of the unsolicited event frames, never used by a request
 
 // status answers
 #define MISC_NOK			(0)
@@ -70,6 +101,8 @@ namespace arduinoio {
 #define SERVO_OK			(1)
 #define COUNTER_NOK			(0)
 #define COUNTER_OK			(1)
+#define BATCH_NOK			(0)
+#define BATCH_OK			(1)
 
 /**
  * @brief checks if the checksum in the message is okay
@@ -77,7 +110,17 @@ namespace arduinoio {
  * @param length length of the message
  * @return true if checksum is okay, false otherwise
  */
-bool isChecksumOk(unsigned char *pMsg, int const length);
+bool isChecksumOk(unsigned char const *pMsg, int const length);
+
+/**
+ * @brief computes the crc-16 of protocol v2 (polynomial 0x1021, initial value 0xFFFF)
+ * @param pData pointer to the data
+ * @param length number of bytes
+ * @param crc crc of the preceding data, allows to compute it piecewise
+ * @return crc of the data
+ */
+unsigned short computeCrc16(unsigned char const *pData, int const length,
+		unsigned short crc = 0xFFFF);
 
 } // end of namespace arduinoio
 
@@ -0,0 +1,98 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tcpTransport.h"
+#include <cassert>
+#include <iostream>
+#include <boost/lexical_cast.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor
+ * @param host name or address of the remote host
+ * @param port tcp port of the remote host
+ */
+tcpTransport::tcpTransport(std::string const &host, unsigned short const port) :
+		m_host(host), m_port(port) {
+
+}
+
+/**
+ * @brief Destructor
+ */
+tcpTransport::~tcpTransport() {
+
+}
+
+bool tcpTransport::open(boost::asio::io_service::strand &strand) {
+	m_socket.reset(new boost::asio::ip::tcp::socket(strand.context()));
+
+	boost::system::error_code error;
+	boost::asio::ip::tcp::resolver resolver(strand.context());
+	boost::asio::ip::tcp::resolver::results_type const endpoints =
+			resolver.resolve(m_host, boost::lexical_cast<std::string>(m_port),
+					error);
+	if (!error) {
+		boost::asio::connect(*m_socket, endpoints, error);
+	}
+	if (error) {
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error, could not connect to "
+				<< m_host << ":" << m_port << ": " << error.message()
+				<< std::endl;
+		return false;
+	}
+
+	// requests are small and latency bound, they must not be delayed by nagle's algorithm
+	m_socket->set_option(boost::asio::ip::tcp::no_delay(true), error);
+
+	return true;
+}
+
+void tcpTransport::asyncWrite(boost::asio::const_buffer const *buffers,
+		std::size_t const numBuffers, ioHandler const &handler) {
+	assert(m_socket);
+	boost::asio::async_write(*m_socket,
+			constBufferRange(buffers, numBuffers), handler);
+}
+
+void tcpTransport::asyncReadSome(unsigned char *data, std::size_t const size,
+		ioHandler const &handler) {
+	assert(m_socket);
+	m_socket->async_read_some(boost::asio::buffer(data, size), handler);
+}
+
+void tcpTransport::cancel() {
+	if (m_socket) {
+		boost::system::error_code ignored;
+		m_socket->cancel(ignored);
+	}
+}
+
+} // end of namespace arduinoio
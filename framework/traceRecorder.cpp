@@ -0,0 +1,131 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "traceRecorder.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <boost/chrono/system_clocks.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief Constructor, creates the trace file
+ * @param fileName path of the trace file, an existing file is overwritten
+ * @param capacity maximum number of bytes of the records
+ */
+traceRecorder::traceRecorder(std::string const &fileName,
+		std::size_t const capacity) :
+		m_fileName(fileName), m_fd(-1), m_pMap(0), m_capacity(capacity), m_used(
+				0), m_start(clock::now()), m_droppedCount(0) {
+
+	m_fd = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_fd < 0 || ftruncate(m_fd, traceHeaderSize + capacity) != 0) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not create trace file " << fileName << ": "
+				<< strerror(errno) << std::endl;
+		return;
+	}
+
+	void *pMap = mmap(0, traceHeaderSize + capacity, PROT_READ | PROT_WRITE,
+			MAP_SHARED, m_fd, 0);
+	if (pMap == MAP_FAILED) {
+		std::cerr << __FILE__ << ":" << __LINE__
+				<< " Error, could not map trace file " << fileName << ": "
+				<< strerror(errno) << std::endl;
+		return;
+	}
+	m_pMap = static_cast<unsigned char *>(pMap);
+
+	boost::uint64_t const startTime_ns =
+			boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+					boost::chrono::system_clock::now().time_since_epoch()).count();
+	memcpy(m_pMap, traceMagic, sizeof(traceMagic));
+	putLittleEndian(m_pMap + 8, traceVersion, 4);
+	putLittleEndian(m_pMap + 12, 0, 4);
+	putLittleEndian(m_pMap + 16, startTime_ns, 8);
+	putLittleEndian(m_pMap + 24, 0, 8);
+}
+
+/**
+ * @brief Destructor, truncates the trace file to the recorded size
+ */
+traceRecorder::~traceRecorder() {
+	if (m_pMap != 0) {
+		munmap(m_pMap, traceHeaderSize + m_capacity);
+	}
+	if (m_fd >= 0) {
+		if (ftruncate(m_fd, traceHeaderSize + m_used) != 0) {
+			std::cerr << __FILE__ << ":" << __LINE__
+					<< " Error, could not truncate trace file " << m_fileName
+					<< std::endl;
+		}
+		close(m_fd);
+	}
+}
+
+/**
+ * @brief appends a chunk of bytes with the current time
+ */
+void traceRecorder::record(E_TRACE_DIRECTION const direction,
+		unsigned char const *data, std::size_t const size) {
+	if (m_pMap == 0) {
+		return;
+	}
+
+	// chunks exceeding the 16 bit length are split
+	std::size_t const maxChunk = 0xFFFF;
+	if (size > maxChunk) {
+		record(direction, data, maxChunk);
+		record(direction, data + maxChunk, size - maxChunk);
+		return;
+	}
+
+	if (m_used + traceRecordHeaderSize + size > m_capacity) {
+		m_droppedCount++;
+		return;
+	}
+
+	boost::uint64_t const time_ns = boost::asio::chrono::duration_cast<
+			boost::asio::chrono::nanoseconds>(clock::now() - m_start).count();
+	unsigned char *p = m_pMap + traceHeaderSize + m_used;
+	putLittleEndian(p, time_ns, 8);
+	p[8] = (unsigned char) direction;
+	putLittleEndian(p + 9, size, 2);
+	memcpy(p + traceRecordHeaderSize, data, size);
+
+	// the record is complete before it is counted in the header
+	m_used += traceRecordHeaderSize + size;
+	putLittleEndian(m_pMap + 24, m_used, 8);
+}
+
+} // end of namespace arduinoio
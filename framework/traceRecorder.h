@@ -0,0 +1,148 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRACERECORDER_H_
+#define TRACERECORDER_H_
+
+#include <cstddef>
+#include <string>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/cstdint.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief direction of a chunk of bytes in a trace
+ */
+enum E_TRACE_DIRECTION {
+	TRACE_TX = 0, // written by the host
+	TRACE_RX = 1 // received by the host
+};
+
+/**
+ * @brief layout of a trace file, all numbers are little endian:
+ * header: magic (8 bytes), version (uint32), reserved (uint32), start time in ns since the epoch (uint64),
+ * number of bytes of the records following the header (uint64)
+ * record: time in ns since the start (uint64), direction (uint8), number of data bytes (uint16), data bytes
+ */
+static char const traceMagic[8] = { 'A', 'R', 'D', 'I', 'O', 'T', 'R', 'C' };
+static boost::uint32_t const traceVersion = 1;
+static std::size_t const traceHeaderSize = 32;
+static std::size_t const traceRecordHeaderSize = 11;
+
+/**
+ * @brief size of the record area of a trace file if not specified otherwise
+ */
+static std::size_t const defaultTraceCapacity = 64 * 1024 * 1024;
+
+/**
+ * @class traceRecorder
+ * @brief appends the bytes exchanged with the io board to a memory mapped trace file. The file has a fixed
+ * capacity, records which do not fit anymore are dropped. The header is updated after every record,
+ * so the file stays readable if the process dies. Only one thread records at a time.
+ */
+class traceRecorder {
+public:
+	/**
+	 * @brief Constructor, creates the trace file
+	 * @param fileName path of the trace file, an existing file is overwritten
+	 * @param capacity maximum number of bytes of the records
+	 */
+	traceRecorder(std::string const &fileName, std::size_t const capacity =
+			defaultTraceCapacity);
+
+	/**
+	 * @brief Destructor, truncates the trace file to the recorded size
+	 */
+	~traceRecorder();
+
+	/**
+	 * @brief returns true if the trace file has been created and mapped
+	 */
+	inline bool isOpen() const {
+		return m_pMap != 0;
+	}
+
+	/**
+	 * @brief appends a chunk of bytes with the current time
+	 */
+	void record(E_TRACE_DIRECTION const direction, unsigned char const *data,
+			std::size_t const size);
+
+	/**
+	 * @brief returns the number of chunks dropped since the capacity of the file has been exhausted
+	 */
+	inline unsigned long getDroppedCount() const {
+		return m_droppedCount;
+	}
+
+	/**
+	 * @brief returns the number of bytes of the records written so far
+	 */
+	inline std::size_t getRecordedSize() const {
+		return m_used;
+	}
+
+private:
+	typedef boost::asio::steady_timer::clock_type clock;
+
+	std::string m_fileName;
+	int m_fd;
+	unsigned char *m_pMap;
+	std::size_t m_capacity;
+	std::size_t m_used;
+	clock::time_point m_start;
+	unsigned long m_droppedCount;
+};
+
+/**
+ * @brief stores a number little endian
+ */
+inline void putLittleEndian(unsigned char *p, boost::uint64_t const value,
+		std::size_t const size) {
+	for (std::size_t i = 0; i < size; i++) {
+		p[i] = (unsigned char) (value >> (8 * i));
+	}
+}
+
+/**
+ * @brief loads a little endian number
+ */
+inline boost::uint64_t getLittleEndian(unsigned char const *p,
+		std::size_t const size) {
+	boost::uint64_t value = 0;
+	for (std::size_t i = size; i > 0; i--) {
+		value = (value << 8) | p[i - 1];
+	}
+	return value;
+}
+
+} // end of namespace arduinoio
+
+#endif /* TRACERECORDER_H_ */
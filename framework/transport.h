@@ -0,0 +1,115 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+#include <cstddef>
+#include <boost/asio.hpp>
+#include <boost/function.hpp>
+
+namespace arduinoio {
+
+/**
+ * @brief buffer sequence over an array of buffers, copying it does not copy the array
+ */
+class constBufferRange {
+public:
+	typedef boost::asio::const_buffer value_type;
+	typedef boost::asio::const_buffer const *const_iterator;
+
+	constBufferRange(boost::asio::const_buffer const *buffers, std::size_t const numBuffers) :
+			m_begin(buffers), m_end(buffers + numBuffers) { }
+
+	inline const_iterator begin() const {
+		return m_begin;
+	}
+	inline const_iterator end() const {
+		return m_end;
+	}
+
+private:
+	const_iterator m_begin;
+	const_iterator m_end;
+};
+
+/**
+ * @class transport
+ * @brief byte stream between the host and the io board, the request engine of the class serial is independent from the used medium
+ */
+class transport {
+public:
+	/**
+	 * @brief completion handler of a read or write operation
+	 * @param error error code of the operation
+	 * @param bytesTransferred number of bytes read or written
+	 */
+	typedef boost::function<void (boost::system::error_code const &error, std::size_t const bytesTransferred)> ioHandler;
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~transport() { }
+
+	/**
+	 * @brief opens the transport, its operations are carried out by the io service of the strand. The operations are
+	 * initiated from within the strand, handlers the transport invokes itself have to be dispatched via the strand.
+	 * After the link has been lost open is called again to reopen the transport, no operation is pending then.
+	 * @return true in case of success, false in case of failure
+	 */
+	virtual bool open(boost::asio::io_service::strand &strand) = 0;
+
+	/**
+	 * @brief writes all buffers with one gathering write, the buffers have to stay valid until the handler has been called
+	 */
+	virtual void asyncWrite(boost::asio::const_buffer const *buffers, std::size_t const numBuffers, ioHandler const &handler) = 0;
+
+	/**
+	 * @brief reads at least one byte into the buffer, the buffer has to stay valid until the handler has been called
+	 */
+	virtual void asyncReadSome(unsigned char *data, std::size_t const size, ioHandler const &handler) = 0;
+
+	/**
+	 * @brief cancels all pending operations, their handlers are called with boost::asio::error::operation_aborted
+	 */
+	virtual void cancel() = 0;
+
+	/**
+	 * @brief changes the baud rate of the line, called by the thread running the io service while no request is in flight.
+	 * Transports without a line rate of their own, e.g. to the emulator, accept any rate.
+	 * @return true in case of success, false in case of failure
+	 */
+	virtual bool setBaudRate(unsigned int const) {
+		return true;
+	}
+};
+
+} // end of namespace arduinoio
+
+#endif /* TRANSPORT_H_ */
@@ -0,0 +1,76 @@
+/* Copyright (c) 2016, Alexander Entinger / LXRobotics
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * 
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * 
+ * * Neither the name of motor-controller-highpower-motorshield nor the names of its
+ *  contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRANSPORT_FACTORY_H_
+#define TRANSPORT_FACTORY_H_
+
+#include "serialPortTransport.h"
+#include "ptyTransport.h"
+#include "tcpTransport.h"
+#include "loopbackTransport.h"
+#include "recordingTransport.h"
+#include "replayTransport.h"
+#include <boost/shared_ptr.hpp>
+
+namespace arduinoio {
+
+class transport_factory {
+public:
+	/**
+	 * @brief Constructor and Destructor
+	 */
+	transport_factory() { }
+	~transport_factory() { }
+
+	/**
+	 * @brief creator methods
+	 */
+	static boost::shared_ptr<serialPortTransport> createSerialPort(std::string const &devNode, unsigned int const baudRate, bool const lowLatency = false) {
+		return boost::shared_ptr<serialPortTransport>(new serialPortTransport(devNode, baudRate, lowLatency));
+	}
+	static boost::shared_ptr<ptyTransport> createPty() {
+		return boost::shared_ptr<ptyTransport>(new ptyTransport());
+	}
+	static boost::shared_ptr<transport> createTcp(std::string const &host, unsigned short const port) {
+		return boost::shared_ptr<transport>(new tcpTransport(host, port));
+	}
+	static boost::shared_ptr<loopbackTransport> createLoopback() {
+		return boost::shared_ptr<loopbackTransport>(new loopbackTransport());
+	}
+	static boost::shared_ptr<recordingTransport> createRecording(boost::shared_ptr<transport> const &t, std::string const &traceFileName, std::size_t const capacity = defaultTraceCapacity) {
+		return boost::shared_ptr<recordingTransport>(new recordingTransport(t, boost::shared_ptr<traceRecorder>(new traceRecorder(traceFileName, capacity))));
+	}
+	static boost::shared_ptr<replayTransport> createReplay(std::string const &traceFileName, double const speed = 1.0) {
+		return boost::shared_ptr<replayTransport>(new replayTransport(traceFileName, speed));
+	}
+};
+
+} // end of namespace arduinoio
+
+#endif /* TRANSPORT_FACTORY_H_ */